@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "cmn_data.hpp"
+#include "map_bits.hpp"
 
 #include "actor_data.hpp"
 #include "sound.hpp"
@@ -163,9 +164,9 @@ public:
         return tile_;
     }
 
-    void add_light(bool light_map[MAP_W][MAP_H]) const;
+    void add_light(Map_bits& light) const;
 
-    virtual void add_light_hook(bool light[MAP_W][MAP_H]) const
+    virtual void add_light_hook(Map_bits& light) const
     {
         (void)light;
     }
@@ -194,6 +195,15 @@ public:
 
     Pos pos;
 
+    //Where the actor is stored in the actor grid, only set by game_time (after changing the
+    //position, game_time::update_actor_pos() must be called)
+    Pos grid_pos;
+
+    //Index in the turn scheduling heap (-1 if not in the heap), and the order in which the
+    //actor acts within a phase - only set by game_time
+    int     sched_heap_idx;
+    long    sched_order;
+
 protected:
     //TODO: Try to get rid of these friend declarations
     friend class Ability_vals;
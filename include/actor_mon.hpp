@@ -48,7 +48,7 @@ public:
     Mon();
     virtual ~Mon();
 
-    bool can_see_actor(const Actor& other, const bool hard_blocked_los[MAP_W][MAP_H]) const;
+    bool can_see_actor(const Actor& other) const;
 
     void move(Dir dir);
 
@@ -109,6 +109,12 @@ public:
     bool                has_given_xp_for_spotting_;
     int                 nr_turns_until_unsummoned_;
 
+    //Path found on an earlier turn, with the target position and map state it was found
+    //for. It is reused by the AI until any of these change (see ai::info).
+    std::vector<Pos>    path_;
+    Pos                 path_tgt_pos_;
+    int                 path_map_generation_;
+
 protected:
     virtual void on_hit(int& dmg) override;
 
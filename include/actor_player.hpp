@@ -49,8 +49,18 @@ public:
     void store_to_save_lines(std::vector<std::string>& lines) const;
     void setup_from_save_lines(std::vector<std::string>& lines);
 
+    //NOTE: The FOV is only recalculated if something which may affect it has changed since
+    //the previous update (see "mk_fov_dirty" below)
     void update_fov();
 
+    //Marks the FOV for recalculation, if the position is within the area it depends on.
+    //Normally called via "map::mk_vision_dirty()".
+    void mk_fov_dirty(const Pos& p);
+
+    //Forces the next FOV update to recalculate and clear the whole map, e.g. after cells
+    //outside the FOV have been marked as seen
+    void mk_fov_dirty();
+
     bool can_see_actor(const Actor& other) const;
 
     void move(Dir dir);
@@ -100,7 +110,7 @@ public:
 
     void update_clr();
 
-    void add_light_hook(bool light_map[MAP_W][MAP_H]) const;
+    void add_light_hook(Map_bits& light) const;
 
     void on_log_msg_printed();  //Aborts e.g. searching and quick move
     void interrupt_actions();   //Aborts e.g. healing
@@ -143,6 +153,11 @@ private:
     int nr_quick_move_steps_left_;
     Dir quick_move_dir_;
 
+    bool is_fov_dirty_;
+    bool fov_allow_see_;
+    Pos  fov_pos_;
+    Rect fov_area_; //All cells set by the previous FOV update are within this area
+
     const int CARRY_WEIGHT_BASE_;
 };
 
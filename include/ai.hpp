@@ -45,6 +45,11 @@ void try_set_path_to_player(Mon& mon, std::vector<Pos>& path);
 
 void set_special_blocked_cells(Mon& mon, bool a[MAP_W][MAP_H]);
 
+//Number of monster paths searched, and reused from an earlier turn, since the game was
+//started (e.g. for measuring the replan rate in bot runs)
+int nr_paths_searched();
+int nr_paths_reused();
+
 } //info
 
 } //ai
@@ -57,6 +57,11 @@ const int     FOV_MAX_W_INT     = (FOV_MAX_RADI_INT * 2) + 1;
 const double  FOV_MAX_RADI_DB   = double(FOV_MAX_RADI_INT);
 const double  FOV_MAX_W_DB      = double(FOV_MAX_W_INT);
 
+//Light radius of light sources (see Lgt_size)
+const int LGT_SMALL_RADI_INT    = 2;
+const int LGT_STD_RADI_INT      = FOV_STD_RADI_INT;
+const int LGT_FLARE_RADI_INT    = FOV_STD_RADI_INT + 4;
+
 const int SND_DIST_NORMAL       = FOV_STD_RADI_INT;
 const int SND_DIST_LOUD         = SND_DIST_NORMAL * 2;
 
@@ -181,11 +181,13 @@ enum class Axis
     ver
 };
 
+//Light sources of larger size outshine smaller ones
 enum class Lgt_size
 {
     none,
-    small, //3x3
-    fov
+    small,  //LGT_SMALL_RADI_INT, e.g. a flickering lantern
+    fov,    //LGT_STD_RADI_INT, e.g. a lantern
+    flare   //LGT_FLARE_RADI_INT
 };
 
 enum class More_prompt_on_msg
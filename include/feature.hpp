@@ -5,6 +5,7 @@
 #include <string>
 
 #include "cmn_types.hpp"
+#include "map_bits.hpp"
 #include "feature_data.hpp"
 
 class Actor;
@@ -36,7 +37,7 @@ public:
     virtual bool is_bottomless() const;
     virtual char glyph() const;
     virtual Tile_id tile() const;
-    virtual void add_light(bool light[MAP_W][MAP_H]) const;
+    virtual void add_light(Map_bits& light) const;
     virtual bool can_have_corpse() const;
     virtual bool can_have_rigid() const;
     virtual bool can_have_blood() const;
@@ -66,6 +66,13 @@ public:
         return burn_state_;
     }
 
+    //True if the rigid does anything in on_new_turn_hook(). Only these, and burning rigids,
+    //get on_new_turn() calls (see game_time::add_active_rigid()).
+    virtual bool has_new_turn_hook() const
+    {
+        return false;
+    }
+
 protected:
     virtual void on_new_turn_hook() {}
 
@@ -491,6 +498,11 @@ public:
 
     void on_new_turn_hook() override;
 
+    bool has_new_turn_hook() const override
+    {
+        return true;
+    }
+
 private:
     Clr clr_default() const override;
 
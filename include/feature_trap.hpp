@@ -68,6 +68,11 @@ public:
 
     void on_new_turn_hook() override;
 
+    bool has_new_turn_hook() const override
+    {
+        return true;
+    }
+
     bool can_have_corpse() const override
     {
         return is_hidden_;
@@ -1,8 +1,11 @@
 #ifndef FOV_H
 #define FOV_H
 
+#include <vector>
+
 #include "cmn_data.hpp"
 #include "cmn_types.hpp"
+#include "map_bits.hpp"
 
 struct Los_result
 {
@@ -14,20 +17,91 @@ struct Los_result
     bool is_blocked_by_drk;
 };
 
+//Which FOV engine fov::run() uses. Both produce identical results.
+// cell_lines   Walks the precalculated line to each cell in the FOV rect separately
+//              (inner cells are re-walked once for every cell behind them).
+// ray_sweep    Walks a tree built by merging all precalculated lines, so each shared
+//              line step is visited once per run.
+enum class Fov_algo
+{
+    cell_lines,
+    ray_sweep
+};
+
 namespace fov
 {
 
-Rect get_fov_rect(const Pos& p);
+void init();
+
+void set_algo(const Fov_algo algo);
+
+Fov_algo algo();
+
+//NOTE: The FOV radius can be set per call, up to FOV_MAX_RADI_INT. The lines and the sweep
+//tree for a radius are built the first time the radius is used, and then shared by all
+//callers.
+
+Rect get_fov_rect(const Pos& p, const int R = FOV_STD_RADI_INT);
 
-bool is_in_fov_range(const Pos& p0, const Pos& p1);
+bool is_in_fov_range(const Pos& p0, const Pos& p1, const int R = FOV_STD_RADI_INT);
 
 Los_result check_cell(const Pos& p0,
                       const Pos& p1,
-                      const bool hard_blocked[MAP_W][MAP_H]);
+                      const bool hard_blocked[MAP_W][MAP_H],
+                      const int R = FOV_STD_RADI_INT);
 
 void run(const Pos& p0,
          const bool hard_blocked[MAP_W][MAP_H],
-         Los_result out[MAP_W][MAP_H]);
+         Los_result out[MAP_W][MAP_H],
+         const int R = FOV_STD_RADI_INT);
+
+//Same as run(), when only hard blocking is of interest (darkness is not evaluated). The
+//cells in the FOV rect which are not hard blocked are set in the output (other cells are
+//left as they are).
+void run_hard(const Pos& p0,
+              const bool hard_blocked[MAP_W][MAP_H],
+              Map_bits& out,
+              const int R = FOV_STD_RADI_INT);
+
+//Same as run_hard() for many origins at once, with the blockers given as bits. Each origin
+//gets its own output (cleared first). The sweep tree is walked once for up to 64 origins,
+//evaluating all of them at each line step, so they share the walk and the scratch buffers.
+//This always uses the ray sweep (both engines produce identical results).
+void run_hard_multi(const std::vector<Pos>& origins,
+                    const Map_bits& hard_blocked,
+                    std::vector<Map_bits>& out,
+                    const int R = FOV_STD_RADI_INT);
+
+//Same as check_cell() with the LOS blockers of the current map. Results are cached per
+//origin and target position until the map changes, so checks between actors which have not
+//moved (e.g. monsters looking for foes every turn) are just lookups.
+Los_result check_cell_on_map(const Pos& p0, const Pos& p1);
+
+//Computes the whole FOV from each of the origins on the current map together (see
+//run_hard_multi()), so check_cell_on_map() from these origins are lookups until the map
+//changes. For when many actors are about to look around, e.g. the monsters each turn.
+void prepare_los_on_map(const std::vector<Pos>& origins);
+
+//Must be called when anything on the map changes which may affect LOS (blocking features,
+//mobs, darkness or light) - normally done via map::mk_vision_dirty()
+void mk_los_cache_dirty();
+
+//Sets all cells in the FOV rect around the origin which are not hard blocked, i.e. the cells
+//lit by a light source with the given radius. The lit cells are cached per origin and radius
+//until a LOS blocker near the origin changes, so light sources standing still are cheap.
+void add_lgt(const Pos& p0, Map_bits& light, const int R = FOV_STD_RADI_INT);
+
+//While a light batch is open, add_lgt() only adds cached light, and holds on to the origins
+//which are not cached. When the batch is ended, these are computed together (see
+//run_hard_multi()), cached, and their light is added. The light maps passed to add_lgt()
+//must still exist when the batch is ended.
+void begin_lgt_batch();
+void end_lgt_batch();
+
+//Drops the cached light of all origins which a LOS blocker at the position may affect (or
+//of all origins) - normally done via map::mk_vision_dirty()
+void mk_lgt_cache_dirty(const Pos& p);
+void mk_lgt_cache_dirty();
 
 } //fov
 
@@ -40,10 +40,28 @@ Actor* cur_actor();
 
 void erase_actor_in_element(const size_t i);
 
+//Must be called after the position of an actor has been changed, to move it in the actor grid
+void update_actor_pos(Actor& actor);
+
+//Must be called after the speed of an actor has changed, to reschedule its next turn
+void update_actor_speed(Actor& actor);
+
+//The actors (in any state) and mobs at the position. These are looked up in grids, which are
+//updated when actors and mobs are added or erased, and when actors move.
+//NOTE: In debug mode, the grids are cross-checked against all actors and mobs on each call.
+const std::vector<Actor*>& actors_at_pos(const Pos& pos);
+
+const std::vector<Mob*>& mobs_at_pos(const Pos& pos);
+
 void mobs_at_pos(const Pos& pos, std::vector<Mob*>& vector_ref);
 
 void add_mob(Mob* const f);
 
+//Registers a position where the rigid needs on_new_turn() calls (because it is burning, or
+//has a new turn hook). Only registered rigids are processed each standard turn, and each
+//position is dropped again when the rigid there no longer needs it.
+void add_active_rigid(const Pos& p);
+
 void erase_mob(Mob* const f, const bool DESTROY_OBJECT);
 
 void erase_all_mobs();
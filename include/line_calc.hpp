@@ -2,6 +2,7 @@
 #define LINE_CALC_H
 
 #include <vector>
+#include <cassert>
 
 #include "cmn_data.hpp"
 #include "cmn_types.hpp"
@@ -9,14 +10,51 @@
 namespace line_calc
 {
 
+struct Line_step
+{
+    signed char x, y;
+};
+
+//View of one precalculated FOV line. The steps of all lines are packed into one shared
+//array, so walking a line does not jump between separate heap blocks.
+class Fov_delta_line
+{
+public:
+    Fov_delta_line() : steps_(nullptr), size_(0) {}
+
+    Fov_delta_line(const Line_step* const steps, const size_t SIZE) :
+        steps_(steps), size_(SIZE) {}
+
+    size_t size()   const {return size_;}
+    bool   empty()  const {return size_ == 0;}
+
+    Pos operator[](const size_t IDX) const
+    {
+        const Line_step& step = steps_[IDX];
+        return Pos(step.x, step.y);
+    }
+
+    Pos at(const size_t IDX) const
+    {
+        assert(IDX < size_);
+        return (*this)[IDX];
+    }
+
+    Pos front() const {return (*this)[0];}
+    Pos back()  const {return (*this)[size_ - 1];}
+
+private:
+    const Line_step* steps_;
+    size_t size_;
+};
+
 void init();
 
 void calc_new_line(const Pos& origin, const Pos& tgt,
                    const bool SHOULD_STOP_AT_TARGET, const int CHEB_TRAVEL_LIMIT,
                    const bool ALLOW_OUTSIDE_MAP, std::vector<Pos>& line_ref);
 
-const std::vector<Pos>* fov_delta_line(const Pos& delta,
-                                       const double& MAX_DIST_ABS);
+const Fov_delta_line* fov_delta_line(const Pos& delta, const double& MAX_DIST_ABS);
 
 } //line_calc
 
@@ -2,6 +2,7 @@
 #define MAP_HANDLER_H
 
 #include <vector>
+#include <cstdint>
 
 #include "cmn_data.hpp"
 #include "cmn_types.hpp"
@@ -15,6 +16,17 @@
 class Save_handler;
 class Rigid;
 
+//Bits of Cell::traits
+namespace cell_trait
+{
+
+const uint8_t blocks_los            = 1 << 0;
+const uint8_t blocks_move_cmn       = 1 << 1;
+const uint8_t blocks_projectiles    = 1 << 2;
+const uint8_t blocks_sound          = 1 << 3;
+
+} //cell_trait
+
 struct Cell
 {
     Cell();
@@ -22,7 +34,18 @@ struct Cell
 
     void reset();
 
+    bool has_trait(const uint8_t trait) const
+    {
+        return (traits & trait) != 0;
+    }
+
     bool                is_explored, is_seen_by_player, is_lit, is_dark;
+
+    //Passability of the rigid, so that it can be checked without a virtual call. Updated
+    //when the rigid is replaced or changes state (see map::mk_vision_dirty()).
+    //NOTE: The map edge always blocks LOS, common movement and projectiles.
+    uint8_t             traits;
+
     Los_result          player_los; //Updated when player updates FOV
     Item*               item;
     Rigid*              rigid;
@@ -52,6 +75,18 @@ extern Room*                room_map[MAP_W][MAP_H]; //Helper array
 
 extern Clr                  wall_clr;
 
+//Live layers of the cells blocked by rigids and mobs, for the most common checks. They
+//always hold the same result as a map parse with cell_check::Blocks_los,
+//Blocks_move_cmn(false) and Blocks_projectiles, but they are updated cell by cell when
+//something changes (see mk_vision_dirty()), so reading them is nearly free.
+//NOTE: These are read only - copy them if the array needs to be modified.
+extern bool                 los_blockers        [MAP_W][MAP_H];
+extern bool                 move_cmn_blockers   [MAP_W][MAP_H];
+extern bool                 projectile_blockers [MAP_W][MAP_H];
+
+//Cells blocking sound (only rigids block sound), updated the same way as the layers above
+extern bool                 sound_blockers      [MAP_W][MAP_H];
+
 void init();
 void cleanup();
 void store_to_save_lines(std::vector<std::string>& lines);
@@ -61,6 +96,16 @@ void reset_map();
 
 Rigid* put(Rigid* const rigid);
 
+//Should be called when something at the position has changed which may affect vision or
+//movement (e.g. a door was opened, or a mob was added). Updates the blocker layers at the
+//position, and marks the player FOV, and the cached LOS results and light which may depend
+//on the position, for recalculation.
+void mk_vision_dirty(const Pos& p);
+
+//Increased every time the traits or blocker layers are updated at any position, so that
+//data calculated from the map can be cached until the next change
+int blockers_generation();
+
 //Makes a copy of the renderers current array
 //TODO: This is weird, and it's unclear how it should be used. Remove?
 //Can it not be copied in the map drawing function instead?
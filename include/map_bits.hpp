@@ -0,0 +1,239 @@
+#ifndef MAP_BITS_H
+#define MAP_BITS_H
+
+#include <cstdint>
+#include <cassert>
+
+#include "cmn_data.hpp"
+#include "cmn_types.hpp"
+
+//One bit per map cell. The bits are packed row by row into 64 bit words, so that union,
+//intersection, inversion, expanding and counting work on a whole row of cells at a time.
+//NOTE: Bits beyond the map width in the last word of each row are always kept at zero.
+class Map_bits
+{
+public:
+    Map_bits()
+    {
+        clear();
+    }
+
+    explicit Map_bits(const bool in[MAP_W][MAP_H])
+    {
+        from_array(in);
+    }
+
+    void clear()
+    {
+        for (uint64_t& w : words_) {w = 0;}
+    }
+
+    void from_array(const bool in[MAP_W][MAP_H])
+    {
+        clear();
+
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                words_[word_idx(x, y)] |= uint64_t(in[x][y]) << (x % 64);
+            }
+        }
+    }
+
+    bool at(const int X, const int Y) const
+    {
+        assert(X >= 0 && X < MAP_W && Y >= 0 && Y < MAP_H);
+        return (words_[word_idx(X, Y)] >> (X % 64)) & 1;
+    }
+
+    bool at(const Pos& p) const
+    {
+        return at(p.x, p.y);
+    }
+
+    void set(const int X, const int Y)
+    {
+        assert(X >= 0 && X < MAP_W && Y >= 0 && Y < MAP_H);
+        words_[word_idx(X, Y)] |= uint64_t(1) << (X % 64);
+    }
+
+    void set(const Pos& p)
+    {
+        set(p.x, p.y);
+    }
+
+    void unset(const int X, const int Y)
+    {
+        assert(X >= 0 && X < MAP_W && Y >= 0 && Y < MAP_H);
+        words_[word_idx(X, Y)] &= ~(uint64_t(1) << (X % 64));
+    }
+
+    void unset(const Pos& p)
+    {
+        unset(p.x, p.y);
+    }
+
+    Map_bits& operator|=(const Map_bits& other)
+    {
+        for (int i = 0; i < NR_WORDS; ++i) {words_[i] |= other.words_[i];}
+        return *this;
+    }
+
+    Map_bits& operator&=(const Map_bits& other)
+    {
+        for (int i = 0; i < NR_WORDS; ++i) {words_[i] &= other.words_[i];}
+        return *this;
+    }
+
+    //Sets every cell which is false to true, and vice versa
+    void flip()
+    {
+        for (int i = 0; i < NR_WORDS; ++i) {words_[i] = ~words_[i];}
+
+        clear_padding();
+    }
+
+    //Sets all cells which are within the given (king move) distance of a set cell
+    void expand(const int DIST = 1)
+    {
+        assert(DIST >= 0);
+
+        for (int i = 0; i < DIST; ++i)
+        {
+            expand_one();
+        }
+    }
+
+    bool is_any_in_area(const Rect& area) const
+    {
+        assert(area.p0.x >= 0 && area.p1.x < MAP_W && area.p0.y >= 0 && area.p1.y < MAP_H);
+
+        if (area.p0.x > area.p1.x) {return false;}
+
+        const int W0 = area.p0.x / 64;
+        const int W1 = area.p1.x / 64;
+
+        for (int y = area.p0.y; y <= area.p1.y; ++y)
+        {
+            const uint64_t* const row = &words_[y * WORDS_PER_ROW];
+
+            for (int w = W0; w <= W1; ++w)
+            {
+                uint64_t mask = ~uint64_t(0);
+
+                if (w == W0) {mask &= ~uint64_t(0) << (area.p0.x % 64);}
+                if (w == W1) {mask &= ~uint64_t(0) >> (63 - (area.p1.x % 64));}
+
+                if (row[w] & mask) {return true;}
+            }
+        }
+        return false;
+    }
+
+    bool operator==(const Map_bits& other) const
+    {
+        for (int i = 0; i < NR_WORDS; ++i)
+        {
+            if (words_[i] != other.words_[i]) {return false;}
+        }
+        return true;
+    }
+
+    bool operator!=(const Map_bits& other) const
+    {
+        return !(*this == other);
+    }
+
+    bool is_any() const
+    {
+        for (const uint64_t w : words_)
+        {
+            if (w) {return true;}
+        }
+        return false;
+    }
+
+    int count() const
+    {
+        int n = 0;
+        for (const uint64_t w : words_) {n += __builtin_popcountll(w);}
+        return n;
+    }
+
+    void to_array(bool out[MAP_W][MAP_H]) const
+    {
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                out[x][y] = at(x, y);
+            }
+        }
+    }
+
+private:
+    static const int WORDS_PER_ROW  = (MAP_W + 63) / 64;
+    static const int NR_WORDS       = WORDS_PER_ROW * MAP_H;
+
+    static int word_idx(const int X, const int Y)
+    {
+        return (Y * WORDS_PER_ROW) + (X / 64);
+    }
+
+    //Mask of the bits in the last word of a row which are inside the map
+    static uint64_t last_word_mask()
+    {
+        return (MAP_W % 64) == 0 ? ~uint64_t(0) : ((uint64_t(1) << (MAP_W % 64)) - 1);
+    }
+
+    void clear_padding()
+    {
+        for (int y = 0; y < MAP_H; ++y)
+        {
+            words_[(y * WORDS_PER_ROW) + WORDS_PER_ROW - 1] &= last_word_mask();
+        }
+    }
+
+    void expand_one()
+    {
+        //First spread each row one step sideways, then combine each row with the rows
+        //above and below it
+        uint64_t horiz[NR_WORDS];
+
+        for (int y = 0; y < MAP_H; ++y)
+        {
+            const uint64_t* const row   = &words_[y * WORDS_PER_ROW];
+            uint64_t* const       h     = &horiz[y * WORDS_PER_ROW];
+
+            for (int w = 0; w < WORDS_PER_ROW; ++w)
+            {
+                const uint64_t FROM_LEFT  = w > 0                   ? (row[w - 1] >> 63) : 0;
+                const uint64_t FROM_RIGHT = w < WORDS_PER_ROW - 1   ? (row[w + 1] << 63) : 0;
+
+                h[w] = row[w] | (row[w] << 1) | FROM_LEFT | (row[w] >> 1) | FROM_RIGHT;
+            }
+
+            h[WORDS_PER_ROW - 1] &= last_word_mask();
+        }
+
+        for (int y = 0; y < MAP_H; ++y)
+        {
+            for (int w = 0; w < WORDS_PER_ROW; ++w)
+            {
+                const int I = (y * WORDS_PER_ROW) + w;
+
+                uint64_t v = horiz[I];
+
+                if (y > 0)          {v |= horiz[I - WORDS_PER_ROW];}
+                if (y < MAP_H - 1)  {v |= horiz[I + WORDS_PER_ROW];}
+
+                words_[I] = v;
+            }
+        }
+    }
+
+    uint64_t words_[NR_WORDS];
+};
+
+#endif
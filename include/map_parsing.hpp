@@ -24,6 +24,11 @@ public:
     virtual bool check(const Cell& c)       const {(void)c; return false;}
     virtual bool check(const Mob& f) const {(void)f; return false;}
     virtual bool check(const Actor& a)      const {(void)a; return false;}
+
+    //Checks on cells and mobs which have a live layer kept by the map (see map.hpp) return
+    //the first element of that layer here. Map parsing then copies the results from the
+    //layer, instead of checking every cell and mob.
+    virtual const bool* live_layer()        const {return nullptr;}
 protected:
     Check() {}
 };
@@ -36,6 +41,7 @@ public:
     bool is_checking_mobs()         const override {return true;}
     bool check(const Cell& c)       const override;
     bool check(const Mob& f)        const override;
+    const bool* live_layer()        const override;
 };
 
 class Blocks_move_cmn : public Check
@@ -49,6 +55,7 @@ public:
     bool check(const Cell& c)       const override;
     bool check(const Mob& f)        const override;
     bool check(const Actor& a)      const override;
+    const bool* live_layer()        const override;
 private:
     const bool IS_ACTORS_BLOCKING_;
 };
@@ -79,6 +86,7 @@ public:
     bool is_checking_mobs()         const override {return true;}
     bool check(const Cell& c)       const override;
     bool check(const Mob& f)        const override;
+    const bool* live_layer()        const override;
 };
 
 class Living_actors_adj_to_pos : public Check
@@ -205,11 +213,13 @@ bool is_val_in_area(const Rect& area, const bool in[MAP_W][MAP_H], const bool VA
 
 void append(bool base[MAP_W][MAP_H], const bool append[MAP_W][MAP_H]);
 
-//Optimized for expanding with a distance of one
+//Expands with a distance of one, only writing to cells inside the given area
+//NOTE: The expanding itself is done word-parallel on a Map_bits (see map_bits.hpp), code
+//which already keeps its data in a Map_bits should call Map_bits::expand() directly
 void expand(const bool in[MAP_W][MAP_H], bool out[MAP_W][MAP_H],
             const Rect& area_allowed_to_modify = Rect(0, 0, MAP_W, MAP_H));
 
-//Slower version that can expand any distance
+//Expands any distance, writing to all cells
 void expand(const bool in[MAP_W][MAP_H], bool out[MAP_W][MAP_H], const int DIST);
 
 bool is_map_connected(const bool blocked[MAP_W][MAP_H]);
@@ -233,9 +243,28 @@ void run(const Pos& p0, const bool blocked[MAP_W][MAP_H], int out[MAP_W][MAP_H],
 
 } //Flood_fill
 
+//Which search path_find::run() uses. Both produce identical paths.
+// flood_fill   Floods from the origin until the target is reached.
+// a_star       Expands cells in order of travelled distance plus the king distance (or
+//              the manhattan distance, if diagonal steps are not allowed) to the target.
+//              Only the cells which can be on a shortest path are expanded, which is much
+//              less than the flood fill when the target is near, or in a straight line.
+enum class Path_algo
+{
+    flood_fill,
+    a_star
+};
+
 namespace path_find
 {
 
+void set_algo(const Path_algo algo);
+
+Path_algo algo();
+
+//Number of cells which were given a travel distance in the last run (for benchmarking)
+int nr_cells_searched();
+
 //NOTE: The path goes from target to origin, not including the origin.
 //---------------------------------------------------------------------------------------
 //RANDOMIZE_STEP_CHOICES: When true, for each step if there are multiple valid (nearer)
@@ -32,10 +32,31 @@ void cleanup();
 
 void draw_map_and_interface(const bool SHOULD_UPDATE_SCREEN = true);
 
+//NOTE: The game runs on its own thread, and only records what it draws. The main thread owns
+//the window and the renderer (SDL requires this), and presents the frames published by the
+//game. Neither waits for the other, so presenting (and vsync) never stalls the game.
+
+//Starts the game function on the game thread, and presents frames, pumps events and runs
+//tasks for the game on this (the main) thread until the game function returns
+void run_game_thread(void (*game_func)());
+
+//Publishes everything drawn since the last update as a frame, which the main thread presents
+//when the frames before it have been shown
 void update_screen();
 
+//Animations call this after updating the screen, instead of sleeping. The published frame is
+//shown for at least the duration before the frames after it, while the game keeps running.
+void hold_frame(const Uint32 DURATION);
+
 void clear_screen();
 
+//Makes draw_map() redraw every map cell, for when the drawn map is no longer on the screen
+void invalidate_map();
+
+//Called when the renderer has lost the contents of its render targets (e.g. on Direct3D after
+//a device reset or a fullscreen toggle) - the screen is cleared and redrawn
+void on_render_targets_reset();
+
 void draw_tile(const Tile_id tile, const Panel panel, const Pos& pos,
                const Clr& clr, const Clr& bg_clr = clr_black);
 
@@ -91,8 +112,13 @@ void draw_box(const Rect& area, const Panel panel = Panel::screen,
 //in which case an empty area is drawn.
 void draw_descr_box(const std::vector<Str_and_clr>& lines);
 
+//Only the map cells where something else should be drawn than last time (or where anything
+//else has been drawn since) are redrawn
 void draw_map();
 
+//Number of map cells redrawn by the last draw_map() call
+int nr_map_cells_redrawn();
+
 void on_toggle_fullscreen();
 
 } //render
@@ -0,0 +1,41 @@
+#ifndef ROOM_GRAPH_H
+#define ROOM_GRAPH_H
+
+#include <vector>
+
+#include "cmn_data.hpp"
+#include "cmn_types.hpp"
+
+//Connectivity graph of the map, for planning long routes. The nodes are the areas of
+//connected free cells between doors, and the doors themselves (one node per door). Two
+//nodes are connected if any of their cells are adjacent.
+//NOTE: The rooms from map generation (map::room_list) are discarded when the level is
+//finished, so the graph makes its own decomposition from the current map.
+//The graph is updated lazily: cells are marked dirty when they change (map::mk_vision_dirty()
+//does this), and only the nodes around these cells are rebuilt on the next query. After many
+//changes (e.g. generating a new level), the whole graph is rebuilt instead.
+namespace room_graph
+{
+
+void mk_dirty(const Pos& p);
+
+//Makes the next query rebuild the whole graph
+void reset();
+
+//Number of nodes in the current graph (for debugging and testing)
+int nr_nodes();
+
+//Finds a path like path_find::run(), but when the path leads out of a free area, it is made
+//from a shortest route over the doors of the graph (the steps from each door of an area to
+//its cells are stored until the area changes), instead of searching the map cells. Falls back
+//on searching the whole map if the start and target are in the same area, if either is not in
+//the graph, or if the blocked array does not allow a path along the route. All doors are
+//considered passable by the graph, so a path through a door is only found if the blocked
+//array allows it.
+//NOTE: The path goes from target to origin, not including the origin.
+void find_path(const Pos& p0, const Pos& p1, bool blocked[MAP_W][MAP_H],
+               std::vector<Pos>& out);
+
+} //room_graph
+
+#endif
@@ -10,6 +10,27 @@ void init();
 
 void cleanup();
 
+//NOTE: The game runs on its own thread (see render::run_game_thread()). SDL only allows the
+//window, the renderer and the event pump to be used by the main thread, so the main thread
+//moves the events to a queue which the game reads, and runs tasks for the game.
+
+bool is_main_thread();
+
+//Runs the function on the main thread, and waits until it is done (called directly if this
+//is the main thread)
+void run_on_main_thread(void (*func)());
+
+//Runs the task the game is waiting for, if any - called by the main thread
+void run_main_thread_task();
+
+//Moves the events which the game handles from SDL to the event queue - called by the main
+//thread
+void pump_events();
+
+//Gets the next event from the event queue, returns false if it is empty
+bool poll_event(SDL_Event& event);
+
+//The main thread keeps the window responsive (pumping events, presenting frames) meanwhile
 void sleep(const Uint32 DURATION);
 
 }
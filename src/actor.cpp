@@ -23,6 +23,9 @@
 
 Actor::Actor() :
     pos             (),
+    grid_pos        (-1, -1),
+    sched_heap_idx  (-1),
+    sched_order     (-1),
     state_          (Actor_state::alive),
     clr_            (clr_black),
     glyph_          (' '),
@@ -129,19 +132,6 @@ void Actor::seen_foes(std::vector<Actor*>& out)
 {
     out.clear();
 
-    bool blocked_los[MAP_W][MAP_H];
-
-    if (!is_player())
-    {
-        Rect los_rect(std::max(0,         pos.x - FOV_STD_RADI_INT),
-                      std::max(0,         pos.y - FOV_STD_RADI_INT),
-                      std::min(MAP_W - 1, pos.x + FOV_STD_RADI_INT),
-                      std::min(MAP_H - 1, pos.y + FOV_STD_RADI_INT));
-
-        map_parse::run(cell_check::Blocks_los(), blocked_los, Map_parse_mode::overwrite,
-                       los_rect);
-    }
-
     for (Actor* actor : game_time::actors_)
     {
         if (actor != this && actor->is_alive())
@@ -164,7 +154,7 @@ void Actor::seen_foes(std::vector<Actor*>& out)
 
                 const Mon* const mon = static_cast<const Mon*>(this);
 
-                if (IS_ENEMY && mon->can_see_actor(*actor, blocked_los))
+                if (IS_ENEMY && mon->can_see_actor(*actor))
                 {
                     out.push_back(actor);
                 }
@@ -299,6 +289,8 @@ void Actor::teleport()
 
     pos = tgt_pos;
 
+    game_time::update_actor_pos(*this);
+
     if (is_player())
     {
         map::player->update_fov();
@@ -767,6 +759,7 @@ void Actor::die(const bool IS_DESTROYED, const bool ALLOW_GORE, const bool ALLOW
                         if (feature_here->can_have_corpse())
                         {
                             pos.set(new_pos);
+                            game_time::update_actor_pos(*this);
                             dx = 9999;
                             dy = 9999;
                         }
@@ -862,33 +855,11 @@ Did_action Actor::try_eat_corpse()
     return Did_action::no;
 }
 
-void Actor::add_light(bool light_map[MAP_W][MAP_H]) const
+void Actor::add_light(Map_bits& light) const
 {
     if (state_ == Actor_state::alive && prop_handler_->has_prop(Prop_id::radiant))
     {
-        //TODO: Much of the code below is duplicated from Actor_player::add_light_hook(), some
-        //refactoring is needed.
-
-        bool hard_blocked[MAP_W][MAP_H];
-
-        const Rect fov_lmt = fov::get_fov_rect(pos);
-
-        map_parse::run(cell_check::Blocks_los(), hard_blocked, Map_parse_mode::overwrite, fov_lmt);
-
-        Los_result fov[MAP_W][MAP_H];
-
-        fov::run(pos, hard_blocked, fov);
-
-        for (int y = fov_lmt.p0.y; y <= fov_lmt.p1.y; ++y)
-        {
-            for (int x = fov_lmt.p0.x; x <= fov_lmt.p1.x; ++x)
-            {
-                if (!fov[x][y].is_blocked_hard)
-                {
-                    light_map[x][y] = true;
-                }
-            }
-        }
+        fov::add_lgt(pos, light, LGT_STD_RADI_INT);
     }
     else if (prop_handler_->has_prop(Prop_id::burning))
     {
@@ -896,12 +867,12 @@ void Actor::add_light(bool light_map[MAP_W][MAP_H]) const
         {
             for (int dy = -1; dy <= 1; ++dy)
             {
-                light_map[pos.x + dx][pos.y + dy] = true;
+                light.set(pos.x + dx, pos.y + dy);
             }
         }
     }
 
-    add_light_hook(light_map);
+    add_light_hook(light);
 }
 
 bool Actor::is_player() const
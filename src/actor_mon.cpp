@@ -43,7 +43,10 @@ Mon::Mon() :
     waiting_                    (false),
     shock_caused_cur_           (0.0),
     has_given_xp_for_spotting_  (false),
-    nr_turns_until_unsummoned_  (-1) {}
+    nr_turns_until_unsummoned_  (-1),
+    path_                       (),
+    path_tgt_pos_               (-1, -1),
+    path_map_generation_        (-1) {}
 
 Mon::~Mon()
 {
@@ -96,17 +99,10 @@ void Mon::on_actor_turn()
         //Monster is conflicted (e.g. by player ring/amulet)
         tgt_bucket = game_time::actors_;
 
-        bool hard_blocked_los[MAP_W][MAP_H];
-
-        const Rect fov_lmt = fov::get_fov_rect(pos);
-
-        map_parse::run(cell_check::Blocks_los(), hard_blocked_los, Map_parse_mode::overwrite,
-                       fov_lmt);
-
         //Remove self and all unseen actors from vector
         for (auto it = begin(tgt_bucket); it != end(tgt_bucket);)
         {
-            if (*it == this || !can_see_actor(**it, hard_blocked_los))
+            if (*it == this || !can_see_actor(**it))
             {
                 tgt_bucket.erase(it);
             }
@@ -333,7 +329,7 @@ void Mon::on_actor_turn()
     game_time::tick();
 }
 
-bool Mon::can_see_actor(const Actor& other, const bool hard_blocked_los[MAP_W][MAP_H]) const
+bool Mon::can_see_actor(const Actor& other) const
 {
     if (this == &other || !other.is_alive())
     {
@@ -362,7 +358,7 @@ bool Mon::can_see_actor(const Actor& other, const bool hard_blocked_los[MAP_W][M
         return false;
     }
 
-    const Los_result los = fov::check_cell(pos, other.pos, hard_blocked_los);
+    const Los_result los = fov::check_cell_on_map(pos, other.pos);
 
     //LOS blocked hard (e.g. a wall)?
     if (los.is_blocked_hard)
@@ -469,6 +465,8 @@ void Mon::move(Dir dir)
     {
         pos = tgt_cell;
 
+        game_time::update_actor_pos(*this);
+
         //Bump features in target cell (i.e. to trigger traps)
         std::vector<Mob*> mobs;
         game_time::mobs_at_pos(pos, mobs);
@@ -1015,10 +1013,7 @@ bool Vortex::on_actor_turn_hook()
             TRACE << knock_back_from_pos.y << ")" << std::endl;
             TRACE << "Player position: ";
             TRACE << player_pos.x << "," << player_pos.y << ")" << std::endl;
-            bool blocked_los[MAP_W][MAP_H];
-            map_parse::run(cell_check::Blocks_los(), blocked_los);
-
-            if (can_see_actor(*(map::player), blocked_los))
+            if (can_see_actor(*(map::player)))
             {
                 TRACE << "I am seeing the player" << std::endl;
 
@@ -1320,11 +1315,9 @@ bool Khephren::on_actor_turn_hook()
 {
     if (is_alive() && aware_counter_ > 0 && !has_summoned_locusts)
     {
-        bool blocked[MAP_W][MAP_H];
-        map_parse::run(cell_check::Blocks_los(), blocked);
-
-        if (can_see_actor(*(map::player), blocked))
+        if (can_see_actor(*(map::player)))
         {
+            bool blocked[MAP_W][MAP_H];
             map_parse::run(cell_check::Blocks_move_cmn(true), blocked);
 
             const int SPAWN_AFTER_X = map::player->pos.x + FOV_STD_RADI_INT + 1;
@@ -1443,11 +1436,9 @@ bool Keziah_mason::on_actor_turn_hook()
 {
     if (is_alive() && aware_counter_ > 0 && !has_summoned_jenkin)
     {
-        bool blocked_los[MAP_W][MAP_H];
-        map_parse::run(cell_check::Blocks_los(), blocked_los);
-
-        if (can_see_actor(*(map::player), blocked_los))
+        if (can_see_actor(*(map::player)))
         {
+            bool blocked_los[MAP_W][MAP_H];
             map_parse::run(cell_check::Blocks_move_cmn(true), blocked_los);
 
             std::vector<Pos> line;
@@ -1500,10 +1491,7 @@ void Leng_elder::on_std_turn_hook()
 
         if (has_given_item_to_player_)
         {
-            bool blocked_los[MAP_W][MAP_H];
-            map_parse::run(cell_check::Blocks_los(), blocked_los);
-
-            if (can_see_actor(*map::player, blocked_los))
+            if (can_see_actor(*map::player))
             {
                 if (nr_turns_to_hostile_ <= 0)
                 {
@@ -1795,10 +1783,7 @@ bool Major_clapham_lee::on_actor_turn_hook()
 
     if (is_alive() && aware_counter_ > 0 && !has_summoned_tomb_legions)
     {
-        bool blocked_los[MAP_W][MAP_H];
-        map_parse::run(cell_check::Blocks_los(), blocked_los);
-
-        if (can_see_actor(*(map::player), blocked_los))
+        if (can_see_actor(*(map::player)))
         {
             msg_log::add("Major Clapham Lee calls forth his Tomb-Legions!");
             std::vector<Actor_id> mon_ids;
@@ -2080,10 +2065,7 @@ bool The_high_priest::on_actor_turn_hook()
         aware_counter_     = data_->nr_turns_aware;
     }
 
-    bool blocked_los[MAP_W][MAP_H];
-    map_parse::run(cell_check::Blocks_los(), blocked_los);
-
-    if (nr_turns_until_next_cpy_ > 0 && can_see_actor(*map::player, blocked_los))
+    if (nr_turns_until_next_cpy_ > 0 && can_see_actor(*map::player))
     {
         --nr_turns_until_next_cpy_;
     }
@@ -33,6 +33,7 @@
 #include "item_potion.hpp"
 #include "text_format.hpp"
 #include "utils.hpp"
+#include "game_time.hpp"
 
 const int SHOCK_FROM_OBSESSION = 30;
 
@@ -50,6 +51,10 @@ Player::Player() :
     nr_turns_until_ins_         (-1),
     nr_quick_move_steps_left_   (-1),
     quick_move_dir_             (Dir::END),
+    is_fov_dirty_               (true),
+    fov_allow_see_              (false),
+    fov_pos_                    (),
+    fov_area_                   (map_parse::map_rect),
     CARRY_WEIGHT_BASE_          (450)
 {
     for (int i = 0; i < int(Phobia::END); ++i)
@@ -313,6 +318,8 @@ void Player::setup_from_save_lines(std::vector<std::string>& lines)
     pos.y = to_int(lines.front());
     lines.erase(begin(lines));
 
+    game_time::update_actor_pos(*this);
+
     for (int i = 0; i < int(Ability_id::END); ++i)
     {
         data_->ability_vals.set_val(Ability_id(i), to_int(lines.front()));
@@ -1626,10 +1633,13 @@ void Player::move(Dir dir)
             {
                 msg_log::add("I displace " + mon_at_dest->name_a() + ".");
                 mon_at_dest->pos = pos;
+                game_time::update_actor_pos(*mon_at_dest);
             }
 
             pos = dest;
 
+            game_time::update_actor_pos(*this);
+
             const int FREE_MOVE_EVERY_N_TURN =
                 player_bon::traits[int(Trait::mobile)]     ? 2 :
                 player_bon::traits[int(Trait::lithe)]      ? 4 :
@@ -1758,7 +1768,7 @@ void Player::hand_att(Actor& defender)
     delete wpn;
 }
 
-void Player::add_light_hook(bool light_map[MAP_W][MAP_H]) const
+void Player::add_light_hook(Map_bits& light) const
 {
     Lgt_size lgt_size = Lgt_size::none;
 
@@ -1766,11 +1776,11 @@ void Player::add_light_hook(bool light_map[MAP_W][MAP_H]) const
     {
         if (active_explosive->data().id == Item_id::flare)
         {
-            lgt_size = Lgt_size::fov;
+            lgt_size = Lgt_size::flare;
         }
     }
 
-    if (lgt_size != Lgt_size::fov)
+    if (lgt_size != Lgt_size::flare)
     {
         for (Item* const item : inv_->backpack_)
         {
@@ -1785,41 +1795,16 @@ void Player::add_light_hook(bool light_map[MAP_W][MAP_H]) const
 
     switch (lgt_size)
     {
-    case Lgt_size::fov:
-    {
-        bool hard_blocked[MAP_W][MAP_H];
-
-        const Rect fov_lmt = fov::get_fov_rect(pos);
-
-        map_parse::run(cell_check::Blocks_los(), hard_blocked, Map_parse_mode::overwrite,
-                       fov_lmt);
-
-        Los_result fov[MAP_W][MAP_H];
-
-        fov::run(pos, hard_blocked, fov);
+    case Lgt_size::flare:
+        fov::add_lgt(pos, light, LGT_FLARE_RADI_INT);
+        break;
 
-        for (int y = fov_lmt.p0.y; y <= fov_lmt.p1.y; ++y)
-        {
-            for (int x = fov_lmt.p0.x; x <= fov_lmt.p1.x; ++x)
-            {
-                if (!fov[x][y].is_blocked_hard)
-                {
-                    light_map[x][y] = true;
-                }
-            }
-        }
-    }
-    break;
+    case Lgt_size::fov:
+        fov::add_lgt(pos, light, LGT_STD_RADI_INT);
+        break;
 
     case Lgt_size::small:
-        for (int y = pos.y - 1; y <= pos.y + 1; ++y)
-        {
-            for (int x = pos.x - 1; x <= pos.x + 1; ++x)
-            {
-                light_map[x][y] = true;
-            }
-        }
-
+        fov::add_lgt(pos, light, LGT_SMALL_RADI_INT);
         break;
 
     case Lgt_size::none: {}
@@ -1827,11 +1812,35 @@ void Player::add_light_hook(bool light_map[MAP_W][MAP_H]) const
     }
 }
 
+void Player::mk_fov_dirty(const Pos& p)
+{
+    if (utils::is_pos_inside(p, fov_area_))
+    {
+        is_fov_dirty_ = true;
+    }
+}
+
+void Player::mk_fov_dirty()
+{
+    is_fov_dirty_   = true;
+    fov_area_.p0    = map_parse::map_rect.p0;
+    fov_area_.p1    = map_parse::map_rect.p1;
+}
+
 void Player::update_fov()
 {
-    for (int x = 0; x < MAP_W; ++x)
+    const bool ALLOW_SEE = prop_handler_->allow_see();
+
+    //Nothing which can affect the FOV has changed since the previous update?
+    if (!is_fov_dirty_ && pos == fov_pos_ && ALLOW_SEE == fov_allow_see_)
     {
-        for (int y = 0; y < MAP_H; ++y)
+        return;
+    }
+
+    //Clear the cells set by the previous update
+    for (int x = fov_area_.p0.x; x <= fov_area_.p1.x; ++x)
+    {
+        for (int y = fov_area_.p0.y; y <= fov_area_.p1.y; ++y)
         {
             Cell& cell = map::cells[x][y];
 
@@ -1841,18 +1850,24 @@ void Player::update_fov()
         }
     }
 
-    if (prop_handler_->allow_see())
-    {
-        bool hard_blocked[MAP_W][MAP_H];
+    const Rect fov_lmt = fov::get_fov_rect(pos);
+
+    //The FOV hack may mark cells one step outside the FOV rect as seen
+    fov_area_.p0.set(std::max(0,         fov_lmt.p0.x - 1),
+                     std::max(0,         fov_lmt.p0.y - 1));
 
-        const Rect fov_lmt = fov::get_fov_rect(pos);
+    fov_area_.p1.set(std::min(MAP_W - 1, fov_lmt.p1.x + 1),
+                     std::min(MAP_H - 1, fov_lmt.p1.y + 1));
 
-        map_parse::run(cell_check::Blocks_los(), hard_blocked, Map_parse_mode::overwrite,
-                       fov_lmt);
+    fov_pos_        = pos;
+    fov_allow_see_  = ALLOW_SEE;
+    is_fov_dirty_   = false;
 
+    if (ALLOW_SEE)
+    {
         Los_result fov[MAP_W][MAP_H];
 
-        fov::run(pos, hard_blocked, fov);
+        fov::run(pos, map::los_blockers, fov);
 
         for (int x = fov_lmt.p0.x; x <= fov_lmt.p1.x; ++x)
         {
@@ -1880,12 +1895,15 @@ void Player::update_fov()
                 map::cells[x][y].is_seen_by_player = true;
             }
         }
+
+        //Everything is seen, so the whole map must be cleared by the next update
+        mk_fov_dirty();
     }
 
-    //Explore
-    for (int x = 0; x < MAP_W; ++x)
+    //Explore (no cells outside the FOV area are seen)
+    for (int x = fov_area_.p0.x; x <= fov_area_.p1.x; ++x)
     {
-        for (int y = 0; y < MAP_H; ++y)
+        for (int y = fov_area_.p0.y; y <= fov_area_.p1.y; ++y)
         {
             Cell& cell = map::cells[x][y];
             const bool IS_BLOCKING = cell_check::Blocks_move_cmn(false).check(cell);
@@ -1901,15 +1919,12 @@ void Player::update_fov()
 
 void Player::fov_hack()
 {
-    bool blocked_los[MAP_W][MAP_H];
-    map_parse::run(cell_check::Blocks_los(), blocked_los);
-
-    bool blocked[MAP_W][MAP_H];
-    map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+    const auto& blocked_los = map::los_blockers;
+    const auto& blocked     = map::move_cmn_blockers;
 
-    for (int x = 0; x < MAP_W; ++x)
+    for (int x = fov_area_.p0.x; x <= fov_area_.p1.x; ++x)
     {
-        for (int y = 0; y < MAP_H; ++y)
+        for (int y = fov_area_.p0.y; y <= fov_area_.p1.y; ++y)
         {
             if (blocked_los[x][y] && blocked[x][y])
             {
@@ -1,5 +1,7 @@
 #include "ai.hpp"
 
+#include <algorithm>
+
 #include "actor_player.hpp"
 #include "msg_log.hpp"
 #include "map.hpp"
@@ -183,14 +185,13 @@ void move_bucket(Mon& self, std::vector<Pos>& dirs_to_mk)
  #@#B#
  #####
  */
-bool is_adj_and_no_vision(const Mon& self, Mon& other,
-                          bool blocked_los[MAP_W][MAP_H])
+bool is_adj_and_no_vision(const Mon& self, Mon& other)
 {
     //If the pal is next to me
     if (utils::is_pos_adj(self.pos, other.pos, false))
     {
         //If pal does not see player
-        if (!other.can_see_actor(*map::player, blocked_los)) {return true;}
+        if (!other.can_see_actor(*map::player)) {return true;}
     }
 
     return false;
@@ -202,10 +203,7 @@ bool make_room_for_friend(Mon& mon)
 {
     if (mon.is_alive())
     {
-        bool blocked_los[MAP_W][MAP_H];
-        map_parse::run(cell_check::Blocks_los(), blocked_los);
-
-        if (mon.can_see_actor(*map::player, blocked_los))
+        if (mon.can_see_actor(*map::player))
         {
             //Loop through all actors
             for (Actor* actor : game_time::actors_)
@@ -214,12 +212,12 @@ bool make_room_for_friend(Mon& mon)
                 {
                     Mon* other = static_cast<Mon*>(actor);
 
-                    bool is_other_adj_with_no_los = is_adj_and_no_vision(mon, *other, blocked_los);
+                    bool is_other_adj_with_no_los = is_adj_and_no_vision(mon, *other);
 
                     //Other monster can see player, or it's an adjacent monster that
                     //does not see the player?
                     if (
-                        other->can_see_actor(*map::player, blocked_los) ||
+                        other->can_see_actor(*map::player) ||
                         is_other_adj_with_no_los)
                     {
                         //If we are blocking a pal, check every neighbouring position
@@ -251,8 +249,7 @@ bool make_room_for_friend(Mon& mon)
                                         other = static_cast<Mon*>(actor2);
 
                                         const bool OTHER_IS_SEEING_PLAYER =
-                                            other->can_see_actor(*map::player,
-                                                                 blocked_los);
+                                            other->can_see_actor(*map::player);
 
                                         if (
                                             OTHER_IS_SEEING_PLAYER &&
@@ -433,11 +430,7 @@ bool step_to_lair_if_los(Mon& mon, const Pos& lair_p)
 {
     if (mon.is_alive())
     {
-        bool blocked[MAP_W][MAP_H];
-
-        map_parse::run(cell_check::Blocks_los(), blocked);
-
-        const Los_result los = fov::check_cell(mon.pos, lair_p, blocked);
+        const Los_result los = fov::check_cell(mon.pos, lair_p, map::los_blockers);
 
         if (!los.is_blocked_hard)
         {
@@ -448,9 +441,7 @@ bool step_to_lair_if_los(Mon& mon, const Pos& lair_p)
 
             const Pos new_pos = mon.pos + delta;
 
-            map_parse::run(cell_check::Blocks_actor(mon, true), blocked);
-
-            if (blocked[new_pos.x][new_pos.y])
+            if (map_parse::cell(cell_check::Blocks_actor(mon, true), new_pos))
             {
                 return false;
             }
@@ -470,6 +461,235 @@ bool step_to_lair_if_los(Mon& mon, const Pos& lair_p)
 namespace info
 {
 
+namespace
+{
+
+//Cells blocking monsters pathing to the player, and the travel distance from each cell to
+//the player. These are shared by all monsters which move the same way (see move_class()),
+//and are recalculated when the map or the player position changes.
+struct Player_dist_map
+{
+    Player_dist_map() :
+        blocked_generation  (-1),
+        dist_generation     (-1),
+        player_pos          () {}
+
+    int     blocked_generation;
+    int     dist_generation;
+    Pos     player_pos;
+    bool    blocked [MAP_W][MAP_H];
+    int     dist    [MAP_W][MAP_H];
+};
+
+const int NR_MOVE_CLASSES = 32;
+
+Player_dist_map player_dist_maps_[NR_MOVE_CLASSES];
+
+//NOTE: Which rigids a monster can move through only depends on these properties (see the
+//move rules in feature_data.cpp, and Door::can_move()), and on if it can open or bash
+//doors. If a move rule is added for another property, it must also be added here.
+int move_class(const Mon& mon)
+{
+    const Actor_data_t& d = mon.data();
+
+    int move_class = 0;
+
+    if (mon.has_prop(Prop_id::ethereal))        {move_class |= 1 << 0;}
+    if (mon.has_prop(Prop_id::ooze))            {move_class |= 1 << 1;}
+    if (mon.has_prop(Prop_id::flying))          {move_class |= 1 << 2;}
+    if (mon.has_prop(Prop_id::burrowing))       {move_class |= 1 << 3;}
+    if (d.can_open_doors || d.can_bash_doors)   {move_class |= 1 << 4;}
+
+    return move_class;
+}
+
+Player_dist_map& player_dist_map(Mon& mon)
+{
+    Player_dist_map& dist_map = player_dist_maps_[move_class(mon)];
+
+    const int GENERATION = map::blockers_generation();
+
+    if (dist_map.blocked_generation != GENERATION)
+    {
+        utils::reset_array(dist_map.blocked, false);
+
+        const int X0 = 1;
+        const int Y0 = 1;
+        const int X1 = MAP_W - 1;
+        const int Y1 = MAP_H - 1;
+
+        //Mark blocking features in the blocking array
+        for (int x = X0; x < X1; ++x)
+        {
+            for (int y = Y0; y < Y1; ++y)
+            {
+                const auto* const f = map::cells[x][y].rigid;
+
+                if (!f->can_move(mon))
+                {
+                    if (f->id() == Feature_id::door)
+                    {
+                        //Mark doors as blocked depending on if the monster can bash or open doors,
+
+                        const Actor_data_t& d = mon.data();
+
+                        //TODO: What if there is a monster that can open doors but not bash them,
+                        //and the door is stuck?
+
+                        if (!d.can_open_doors && !d.can_bash_doors)
+                        {
+                            dist_map.blocked[x][y] = true;
+                        }
+                    }
+                    else //Not a door (e.g. a wall)
+                    {
+                        dist_map.blocked[x][y] = true;
+                    }
+                }
+            }
+        }
+
+        dist_map.blocked_generation = GENERATION;
+    }
+
+    const Pos& player_pos = map::player->pos;
+
+    if (dist_map.dist_generation != GENERATION || dist_map.player_pos != player_pos)
+    {
+        flood_fill::run(player_pos, dist_map.blocked, dist_map.dist, 10000, Pos(-1, -1),
+                        true);
+
+        dist_map.dist_generation    = GENERATION;
+        dist_map.player_pos         = player_pos;
+    }
+
+    return dist_map;
+}
+
+//Finds a path to the player for a single monster, with the living actors adjacent to the
+//monster blocking
+void find_path_around_actors(Mon& mon, const Player_dist_map& dist_map, std::vector<Pos>& path)
+{
+    bool blocked[MAP_W][MAP_H];
+    utils::copy_bool_array(dist_map.blocked, blocked);
+
+    map_parse::run(cell_check::Living_actors_adj_to_pos(mon.pos), blocked,
+                   Map_parse_mode::append);
+
+    path_find::run(mon.pos, map::player->pos, blocked, path);
+}
+
+int nr_paths_searched_  = 0;
+int nr_paths_reused_    = 0;
+
+//Sets the path the monster stored on an earlier turn, if it was found for the same target
+//position and map state, and the next step is still free. Returns false if a new path must
+//be searched.
+//NOTE: Only actors adjacent to the monster block the path search, so it's enough to check
+//the next step for actors.
+bool try_reuse_path(Mon& mon, const Pos& tgt_pos, std::vector<Pos>& path)
+{
+    std::vector<Pos>& stored = mon.path_;
+
+    if (
+        stored.empty()                  ||
+        mon.path_tgt_pos_ != tgt_pos    ||
+        mon.path_map_generation_ != map::blockers_generation())
+    {
+        return false;
+    }
+
+    //Drop the step taken since the path was stored
+    if (stored.back() == mon.pos)
+    {
+        stored.pop_back();
+    }
+
+    if (
+        stored.empty()                                                  ||
+        !utils::is_pos_adj(mon.pos, stored.back(), false)              ||
+        map_parse::cell(cell_check::Blocks_actor(mon, true), stored.back()))
+    {
+        return false;
+    }
+
+    path = stored;
+
+    ++nr_paths_reused_;
+
+    return true;
+}
+
+void store_path(Mon& mon, const Pos& tgt_pos, const std::vector<Pos>& path)
+{
+    mon.path_               = path;
+    mon.path_tgt_pos_       = tgt_pos;
+    mon.path_map_generation_ = map::blockers_generation();
+
+    ++nr_paths_searched_;
+}
+
+//Sets the path by stepping downhill on the distance map, from the monster to the player
+void step_downhill(Mon& mon, const Player_dist_map& dist_map, std::vector<Pos>& path)
+{
+    const int DIST_AT_MON = dist_map.dist[mon.pos.x][mon.pos.y];
+
+    if (DIST_AT_MON == 0)
+    {
+        //No path exists
+        return;
+    }
+
+    //Step downhill to the player. Any cell nearer the player than the monster can only reach
+    //the player through cells which are also nearer, so the adjacent actors can only block
+    //the first step.
+    bool blocked_by_actor[MAP_W][MAP_H];
+    utils::reset_array(blocked_by_actor, false);
+
+    map_parse::run(cell_check::Living_actors_adj_to_pos(mon.pos), blocked_by_actor,
+                   Map_parse_mode::append, Rect(mon.pos - 1, mon.pos + 1));
+
+    path.reserve(DIST_AT_MON);
+
+    Pos cur_pos(mon.pos);
+
+    for (int dist = DIST_AT_MON - 1; dist > 0; --dist)
+    {
+        bool is_step_found = false;
+
+        for (const Pos& d : dir_utils::dir_list)
+        {
+            const Pos adj_pos(cur_pos + d);
+
+            if (
+                dist_map.dist[adj_pos.x][adj_pos.y] == dist &&
+                (cur_pos != mon.pos || !blocked_by_actor[adj_pos.x][adj_pos.y]))
+            {
+                cur_pos         = adj_pos;
+                is_step_found   = true;
+                break;
+            }
+        }
+
+        if (!is_step_found)
+        {
+            //All steps nearer to the player are blocked by actors, the monster needs to find
+            //another way around them
+            find_path_around_actors(mon, dist_map, path);
+            return;
+        }
+
+        path.push_back(cur_pos);
+    }
+
+    path.push_back(map::player->pos);
+
+    //The path goes from target to origin
+    std::reverse(begin(path), end(path));
+}
+
+} //namespace
+
 bool look_become_player_aware(Mon& mon)
 {
     if (!mon.is_alive())
@@ -531,13 +751,7 @@ void try_set_path_to_lair_if_no_los(Mon& mon, std::vector<Pos>& path,
 {
     if (mon.is_alive())
     {
-        bool blocked[MAP_W][MAP_H];
-
-        const Rect fov_lmt = fov::get_fov_rect(mon.pos);
-
-        map_parse::run(cell_check::Blocks_los(), blocked, Map_parse_mode::overwrite, fov_lmt);
-
-        const Los_result los = fov::check_cell(mon.pos, lair_p, blocked);
+        const Los_result los = fov::check_cell(mon.pos, lair_p, map::los_blockers);
 
         if (!los.is_blocked_hard)
         {
@@ -545,12 +759,21 @@ void try_set_path_to_lair_if_no_los(Mon& mon, std::vector<Pos>& path,
             return;
         }
 
+        if (try_reuse_path(mon, lair_p, path))
+        {
+            return;
+        }
+
+        bool blocked[MAP_W][MAP_H];
+
         map_parse::run(cell_check::Blocks_actor(mon, false), blocked);
 
         map_parse::run(cell_check::Living_actors_adj_to_pos(mon.pos),
                        blocked, Map_parse_mode::append);
 
         path_find::run(mon.pos, lair_p, blocked, path);
+
+        store_path(mon, lair_p, path);
         return;
     }
 
@@ -567,14 +790,8 @@ void try_set_path_to_leader(Mon& mon, std::vector<Pos>& path)
         {
             if (leader->is_alive())
             {
-                bool blocked[MAP_W][MAP_H];
-
-                const Rect fov_lmt = fov::get_fov_rect(mon.pos);
-
-                map_parse::run(cell_check::Blocks_los(), blocked, Map_parse_mode::overwrite,
-                               fov_lmt);
-
-                const Los_result los = fov::check_cell(mon.pos, leader->pos, blocked);
+                const Los_result los = fov::check_cell(mon.pos, leader->pos,
+                                                       map::los_blockers);
 
                 if (!los.is_blocked_hard)
                 {
@@ -582,12 +799,21 @@ void try_set_path_to_leader(Mon& mon, std::vector<Pos>& path)
                     return;
                 }
 
+                if (try_reuse_path(mon, leader->pos, path))
+                {
+                    return;
+                }
+
+                bool blocked[MAP_W][MAP_H];
+
                 map_parse::run(cell_check::Blocks_actor(mon, false), blocked);
 
                 map_parse::run(cell_check::Living_actors_adj_to_pos(mon.pos),
                                blocked, Map_parse_mode::append);
 
                 path_find::run(mon.pos, leader->pos, blocked, path);
+
+                store_path(mon, leader->pos, path);
                 return;
             }
         }
@@ -598,50 +824,14 @@ void try_set_path_to_leader(Mon& mon, std::vector<Pos>& path)
 
 void try_set_path_to_player(Mon& mon, std::vector<Pos>& path)
 {
+    path.clear();
+
     if (!mon.is_alive() || mon.aware_counter_ <= 0)
     {
-        path.clear();
         return;
     }
 
-    bool blocked[MAP_W][MAP_H];
-    utils::reset_array(blocked, false);
-
-    const int X0 = 1;
-    const int Y0 = 1;
-    const int X1 = MAP_W - 1;
-    const int Y1 = MAP_H - 1;
-
-    //Mark blocking features in the blocking array
-    for (int x = X0; x < X1; ++x)
-    {
-        for (int y = Y0; y < Y1; ++y)
-        {
-            const auto* const f = map::cells[x][y].rigid;
-
-            if (!f->can_move(mon))
-            {
-                if (f->id() == Feature_id::door)
-                {
-                    //Mark doors as blocked depending on if the monster can bash or open doors,
-
-                    const Actor_data_t& d = mon.data();
-
-                    //TODO: What if there is a monster that can open doors but not bash them,
-                    //and the door is stuck?
-
-                    if (!d.can_open_doors && !d.can_bash_doors)
-                    {
-                        blocked[x][y] = true;
-                    }
-                }
-                else //Not a door (e.g. a wall)
-                {
-                    blocked[x][y] = true;
-                }
-            }
-        }
-    }
+    Player_dist_map& dist_map = player_dist_map(mon);
 
     //If there is an unblocked LOS between the monster and the player we cancel the pathfinding.
     //The monster should not use the pathfinder to move towards the player in this case. If the
@@ -652,17 +842,46 @@ void try_set_path_to_player(Mon& mon, std::vector<Pos>& path)
     //anyone when they should have come into sight.
     const Pos& player_pos = map::player->pos;
 
-    Los_result los_result = fov::check_cell(mon.pos, player_pos, blocked);
+    Los_result los_result = fov::check_cell(mon.pos, player_pos, dist_map.blocked);
 
-    if (los_result.is_blocked_hard || los_result.is_blocked_by_drk)
+    if (!los_result.is_blocked_hard && !los_result.is_blocked_by_drk)
     {
-        //Append living adjacent actors to the blocking array
-        map_parse::run(cell_check::Living_actors_adj_to_pos(mon.pos), blocked,
-                       Map_parse_mode::append);
+        return;
+    }
+
+    //Living adjacent actors are blocking (including the player)
+    if (map::player->is_alive() && utils::is_pos_adj(mon.pos, player_pos, false))
+    {
+        return;
+    }
 
-        //Find a path
-        path_find::run(mon.pos, player_pos, blocked, path);
+    if (try_reuse_path(mon, player_pos, path))
+    {
+        return;
+    }
+
+    //The distance map is flooded from the player, so it cannot be used if the monster
+    //somehow stands in a cell which is blocking for it
+    if (dist_map.blocked[mon.pos.x][mon.pos.y])
+    {
+        find_path_around_actors(mon, dist_map, path);
     }
+    else
+    {
+        step_downhill(mon, dist_map, path);
+    }
+
+    store_path(mon, player_pos, path);
+}
+
+int nr_paths_searched()
+{
+    return nr_paths_searched_;
+}
+
+int nr_paths_reused()
+{
+    return nr_paths_reused_;
 }
 
 void set_special_blocked_cells(Mon& mon, bool a[MAP_W][MAP_H])
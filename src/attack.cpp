@@ -17,7 +17,6 @@
 #include "msg_log.hpp"
 #include "line_calc.hpp"
 #include "render.hpp"
-#include "sdl_wrapper.hpp"
 #include "knockback.hpp"
 
 Att_data::Att_data(Actor* const attacker,
@@ -1054,16 +1053,16 @@ void projectile_fire(Actor* const attacker, const Pos& origin, const Pos& aim_po
                         {
                             proj->set_tile(Tile_id::blast1, clr_red_lgt);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY / 2);
+                            render::hold_frame(DELAY / 2);
                             proj->set_tile(Tile_id::blast2, clr_red_lgt);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY / 2);
+                            render::hold_frame(DELAY / 2);
                         }
                         else //Not tile mode
                         {
                             proj->set_glyph('*', clr_red_lgt);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY);
+                            render::hold_frame(DELAY);
                         }
 
                         //MESSAGES FOR ACTOR HIT
@@ -1146,16 +1145,16 @@ void projectile_fire(Actor* const attacker, const Pos& origin, const Pos& aim_po
                         {
                             proj->set_tile(Tile_id::blast1, clr_yellow);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY / 2);
+                            render::hold_frame(DELAY / 2);
                             proj->set_tile(Tile_id::blast2, clr_yellow);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY / 2);
+                            render::hold_frame(DELAY / 2);
                         }
                         else //Text mode
                         {
                             proj->set_glyph('*', clr_yellow);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY);
+                            render::hold_frame(DELAY);
                         }
                     }
                 }
@@ -1188,16 +1187,16 @@ void projectile_fire(Actor* const attacker, const Pos& origin, const Pos& aim_po
                         {
                             proj->set_tile(Tile_id::blast1, clr_yellow);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY / 2);
+                            render::hold_frame(DELAY / 2);
                             proj->set_tile(Tile_id::blast2, clr_yellow);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY / 2);
+                            render::hold_frame(DELAY / 2);
                         }
                         else //Text mode
                         {
                             proj->set_glyph('*', clr_yellow);
                             render::draw_projectiles(projectiles, !LEAVE_TRAIL);
-                            sdl_wrapper::sleep(DELAY);
+                            render::hold_frame(DELAY);
                         }
                     }
                 }
@@ -1226,7 +1225,7 @@ void projectile_fire(Actor* const attacker, const Pos& origin, const Pos& aim_po
 
             if ( map::cells[pos.x][pos.y].is_seen_by_player && !projectile->is_obstructed)
             {
-                sdl_wrapper::sleep(DELAY);
+                render::hold_frame(DELAY);
                 break;
             }
         }
@@ -1360,7 +1359,7 @@ void shotgun(Actor& attacker, const Wpn& wpn, const Pos& aim_pos)
                         }
 
                         render::update_screen();
-                        sdl_wrapper::sleep(config::delay_shotgun());
+                        render::hold_frame(config::delay_shotgun());
                     }
 
                     //Messages
@@ -1421,7 +1420,7 @@ void shotgun(Actor& attacker, const Wpn& wpn, const Pos& aim_pos)
                 }
 
                 render::update_screen();
-                sdl_wrapper::sleep(config::delay_shotgun());
+                render::hold_frame(config::delay_shotgun());
                 render::draw_map_and_interface();
             }
 
@@ -1452,7 +1451,7 @@ void shotgun(Actor& attacker, const Wpn& wpn, const Pos& aim_pos)
                 }
 
                 render::update_screen();
-                sdl_wrapper::sleep(config::delay_shotgun());
+                render::hold_frame(config::delay_shotgun());
                 render::draw_map_and_interface();
             }
 
@@ -21,6 +21,8 @@
 #include "utils.hpp"
 #include "game_time.hpp"
 #include "map_travel.hpp"
+#include "ai.hpp"
+#include "room_graph.hpp"
 
 using namespace std;
 
@@ -61,7 +63,7 @@ void find_path_to_stairs()
 
     assert(stair_pos != Pos(-1, -1));
 
-    path_find::run(map::player->pos, stair_pos, blocked, cur_path_);
+    room_graph::find_path(map::player->pos, stair_pos, blocked, cur_path_);
 
     assert(!cur_path_.empty());
     assert(cur_path_.front() == stair_pos);
@@ -118,6 +120,8 @@ void act()
     if (map::dlvl >= DLVL_LAST)
     {
         TRACE << "Starting new run on first dungeon level" << endl;
+        TRACE << "Monster paths searched: " << ai::info::nr_paths_searched()
+              << ", reused: " << ai::info::nr_paths_reused() << endl;
         map_travel::init();
         map::dlvl = 1;
         return;
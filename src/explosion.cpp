@@ -4,11 +4,9 @@
 #include "map.hpp"
 #include "msg_log.hpp"
 #include "map_parsing.hpp"
-#include "sdl_wrapper.hpp"
 #include "line_calc.hpp"
 #include "actor_player.hpp"
 #include "utils.hpp"
-#include "sdl_wrapper.hpp"
 #include "player_bon.hpp"
 #include "feature_rigid.hpp"
 #include "feature_mob.hpp"
@@ -64,7 +62,7 @@ void draw(const vector< vector<Pos> >& pos_lists, bool blocked[MAP_W][MAP_H],
         if (is_any_cell_seen_by_player)
         {
             render::update_screen();
-            sdl_wrapper::sleep(config::delay_explosion() / NR_ANIM_STEPS);
+            render::hold_frame(config::delay_explosion() / NR_ANIM_STEPS);
         }
     }
 }
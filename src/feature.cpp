@@ -40,7 +40,7 @@ void Feature::bump(Actor& actor_bumping)
     }
 }
 
-void Feature::add_light(bool light[MAP_W][MAP_H]) const
+void Feature::add_light(Map_bits& light) const
 {
     (void)light;
 }
@@ -724,6 +724,7 @@ void Door::try_close(Actor* actor_trying)
         if (!TRYER_IS_BLIND)
         {
             is_open_ = false;
+            map::mk_vision_dirty(pos_);
 
             if (IS_PLAYER)
             {
@@ -750,6 +751,7 @@ void Door::try_close(Actor* actor_trying)
             if (rnd::percent() < 50)
             {
                 is_open_ = false;
+                map::mk_vision_dirty(pos_);
 
                 if (IS_PLAYER)
                 {
@@ -838,6 +840,7 @@ void Door::try_open(Actor* actor_trying)
         {
             TRACE << "Tryer can see, opening" << endl;
             is_open_ = true;
+            map::mk_vision_dirty(pos_);
 
             if (IS_PLAYER)
             {
@@ -869,6 +872,7 @@ void Door::try_open(Actor* actor_trying)
             {
                 TRACE << "Tryer is blind, but open succeeded anyway" << endl;
                 is_open_ = true;
+                map::mk_vision_dirty(pos_);
 
                 if (IS_PLAYER)
                 {
@@ -949,5 +953,8 @@ Did_open Door::open(Actor* const actor_opening)
     is_open_   = true;
     is_secret_ = false;
     is_stuck_  = false;
+
+    map::mk_vision_dirty(pos_);
+
     return Did_open::yes;
 }
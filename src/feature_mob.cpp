@@ -158,32 +158,9 @@ void Lit_flare::on_new_turn()
     if (nr_turns_left_ <= 0) {game_time::erase_mob(this, true);}
 }
 
-void Lit_flare::add_light(bool light[MAP_W][MAP_H]) const
+void Lit_flare::add_light(Map_bits& light) const
 {
-    const int R = FOV_STD_RADI_INT; //light_radius();
-
-    Pos p0(std::max(0,         pos_.x - R),  std::max(0,          pos_.y - R));
-    Pos p1(std::min(MAP_W - 1, pos_.x + R),  std::min(MAP_H - 1,  pos_.y + R));
-
-    bool hard_blocked[MAP_W][MAP_H];
-
-    map_parse::run(cell_check::Blocks_los(), hard_blocked, Map_parse_mode::overwrite,
-                   Rect(p0, p1));
-
-    Los_result fov[MAP_W][MAP_H];
-
-    fov::run(pos_, hard_blocked, fov);
-
-    for (int y = p0.y; y <= p1.y; ++y)
-    {
-        for (int x = p0.x; x <= p1.x; ++x)
-        {
-            if (!fov[x][y].is_blocked_hard)
-            {
-                light[x][y] = true;
-            }
-        }
-    }
+    fov::add_lgt(pos_, light, LGT_FLARE_RADI_INT);
 }
 
 std::string Lit_flare::name(const Article article)  const
@@ -19,6 +19,7 @@
 #include "actor_mon.hpp"
 #include "query.hpp"
 #include "pickup.hpp"
+#include "game_time.hpp"
 
 using namespace std;
 
@@ -168,6 +169,8 @@ void Rigid::try_start_burning(const bool IS_MSG_ALLOWED)
         }
 
         burn_state_ = Burn_state::burning;
+
+        game_time::add_active_rigid(pos_);
     }
 }
 
@@ -1022,6 +1025,7 @@ void Stairs::bump(Actor& actor_bumping)
         {
         case 0:
             map::player->pos = pos_;
+            game_time::update_actor_pos(*map::player);
             msg_log::clear();
             msg_log::add("I descend the stairs.");
             render::draw_map_and_interface();
@@ -1030,6 +1034,7 @@ void Stairs::bump(Actor& actor_bumping)
 
         case 1:
             map::player->pos = pos_;
+            game_time::update_actor_pos(*map::player);
             save_handling::save();
             init::quit_to_main_menu = true;
             break;
@@ -22,6 +22,7 @@
 #include "player_bon.hpp"
 #include "item_factory.hpp"
 #include "attack.hpp"
+#include "game_time.hpp"
 
 namespace
 {
@@ -412,6 +413,7 @@ void Trap::disarm()
             if (trap_type() == Trap_id::web)
             {
                 map::player->pos = pos_;
+                game_time::update_actor_pos(*map::player);
             }
 
             trigger_trap(map::player);
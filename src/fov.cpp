@@ -3,7 +3,9 @@
 #include "init.hpp"
 
 #include <math.h>
+#include <cstdint>
 #include <vector>
+#include <algorithm>
 
 #include "cmn_types.hpp"
 #include "line_calc.hpp"
@@ -13,10 +15,588 @@
 namespace fov
 {
 
-Rect get_fov_rect(const Pos& p)
+namespace
 {
-    const int R = FOV_STD_RADI_INT;
 
+Fov_algo algo_ = Fov_algo::ray_sweep;
+
+//Results of check_cell_on_map(). Each origin and target pair has one slot it can be stored
+//in, an entry is valid if its stamp equals the current stamp.
+const int LOS_CACHE_SIZE_LOG2   = 13;
+const int LOS_CACHE_SIZE        = 1 << LOS_CACHE_SIZE_LOG2;
+
+struct Los_cache_entry
+{
+    Los_cache_entry() :
+        key     (-1),
+        stamp   (-1),
+        los     () {}
+
+    int         key;
+    int         stamp;
+    Los_result  los;
+};
+
+Los_cache_entry los_cache_[LOS_CACHE_SIZE];
+int             los_cache_stamp_    = 0;
+
+//Whole FOVs from origins on the current map, computed together by prepare_los_on_map().
+//Each origin has one slot it can be stored in, an entry is valid if its stamp equals the LOS
+//cache stamp.
+const int LOS_FOV_CACHE_SIZE_LOG2   = 7;
+const int LOS_FOV_CACHE_SIZE        = 1 << LOS_FOV_CACHE_SIZE_LOG2;
+
+struct Los_fov_cache_entry
+{
+    Los_fov_cache_entry() :
+        origin  (-1, -1),
+        stamp   (-1),
+        seen    (),
+        drk     () {}
+
+    Pos         origin;
+    int         stamp;
+    Map_bits    seen;   //Not hard blocked
+    Map_bits    drk;    //Blocked by darkness
+};
+
+Los_fov_cache_entry los_fov_cache_[LOS_FOV_CACHE_SIZE];
+
+//Cells lit by light sources with FOV radius (see add_lgt()). When the cache is full, the
+//least recently used origin is replaced.
+struct Lgt_cache_entry
+{
+    Lgt_cache_entry() :
+        origin      (),
+        radi        (0),
+        last_used   (0),
+        lit         () {}
+
+    Pos         origin;
+    int         radi;
+    int         last_used;
+    Map_bits    lit;
+};
+
+const size_t LGT_CACHE_SIZE_MAX = 64;
+
+std::vector<Lgt_cache_entry>    lgt_cache_;
+int                             lgt_cache_nr_uses_ = 0;
+
+//Light not found in the cache while a light batch is open (see begin_lgt_batch())
+struct Lgt_batch_entry
+{
+    Lgt_batch_entry(const Pos& p0, const int R, Map_bits& light_) :
+        origin  (p0),
+        radi    (R),
+        light   (&light_) {}
+
+    Pos         origin;
+    int         radi;
+    Map_bits*   light;
+};
+
+bool                            is_lgt_batch_open_ = false;
+std::vector<Lgt_batch_entry>    lgt_batch_;
+
+//One step along one or more of the precalculated FOV lines. The nodes are stored in
+//depth-first order, so a parent always comes before its children, and the descendants of a
+//node are stored in the interval [node index + 1, subtree_end).
+struct Ray_node
+{
+    Ray_node(const Pos& d_, const int DEPTH, const int PARENT, const bool IS_TGT) :
+        d           (d_),
+        depth       (DEPTH),
+        parent      (PARENT),
+        subtree_end (-1),
+        is_tgt      (IS_TGT) {}
+
+    Pos  d;         //Offset from the origin
+    int  depth;     //Index of this step in the line(s)
+    int  parent;
+    int  subtree_end;
+    bool is_tgt;    //The line to this offset ends here
+};
+
+//One tree per FOV radius, built the first time the radius is used
+std::vector<Ray_node> ray_trees_[FOV_MAX_RADI_INT + 1];
+
+//Sweep state per ray node (sized for the largest tree built), kept between runs to avoid
+//reallocating
+std::vector<char> ray_is_blocked_before_;
+std::vector<char> ray_is_drk_;
+
+//Sweep state per ray node for up to 64 origins at once, bit N is the state for origin N (see
+//run_ray_sweep_multi())
+const size_t RAY_MULTI_NR_ORIGINS_MAX = 64;
+
+std::vector<uint64_t> ray_is_inside_multi_;
+std::vector<uint64_t> ray_is_blocked_multi_;
+std::vector<uint64_t> ray_is_drk_multi_;
+
+struct Ray_trie_node
+{
+    Ray_trie_node(const Pos& d_) : d(d_), is_tgt(false), children() {}
+
+    Pos                 d;
+    bool                is_tgt;
+    std::vector<size_t> children;
+};
+
+void add_ray_nodes(const std::vector<Ray_trie_node>& trie, const size_t TRIE_IDX,
+                   const int DEPTH, const int PARENT, std::vector<Ray_node>& nodes)
+{
+    const Ray_trie_node& trie_node = trie[TRIE_IDX];
+
+    const int IDX = int(nodes.size());
+
+    nodes.push_back(Ray_node(trie_node.d, DEPTH, PARENT, trie_node.is_tgt));
+
+    for (const size_t CHILD_IDX : trie_node.children)
+    {
+        add_ray_nodes(trie, CHILD_IDX, DEPTH + 1, IDX, nodes);
+    }
+
+    nodes[IDX].subtree_end = int(nodes.size());
+}
+
+//Merges the precalculated lines within the radius into a tree
+const std::vector<Ray_node>& ray_tree(const int R)
+{
+    assert(R >= 0 && R <= FOV_MAX_RADI_INT);
+
+    std::vector<Ray_node>& nodes = ray_trees_[R];
+
+    if (!nodes.empty())
+    {
+        return nodes;
+    }
+
+    std::vector<Ray_trie_node> trie {Ray_trie_node(Pos(0, 0))};
+
+    for (int dx = -R; dx <= R; ++dx)
+    {
+        for (int dy = -R; dy <= R; ++dy)
+        {
+            const line_calc::Fov_delta_line* const line =
+                line_calc::fov_delta_line(Pos(dx, dy), double(R));
+
+            if (!line)
+            {
+                continue;
+            }
+
+            assert(!line->empty() && line->front() == Pos(0, 0));
+
+            size_t trie_idx = 0;
+
+            for (size_t line_idx = 1; line_idx < line->size(); ++line_idx)
+            {
+                const Pos d = (*line)[line_idx];
+
+                size_t next_idx = 0;
+
+                for (const size_t CHILD_IDX : trie[trie_idx].children)
+                {
+                    if (trie[CHILD_IDX].d == d)
+                    {
+                        next_idx = CHILD_IDX;
+                        break;
+                    }
+                }
+
+                if (next_idx == 0)
+                {
+                    next_idx = trie.size();
+                    trie.push_back(Ray_trie_node(d));
+                    trie[trie_idx].children.push_back(next_idx);
+                }
+
+                trie_idx = next_idx;
+            }
+
+            trie[trie_idx].is_tgt = true;
+        }
+    }
+
+    nodes.reserve(trie.size());
+
+    add_ray_nodes(trie, 0, 0, -1, nodes);
+
+    if (ray_is_blocked_before_.size() < nodes.size())
+    {
+        ray_is_blocked_before_.assign(nodes.size(), false);
+        ray_is_drk_           .assign(nodes.size(), false);
+        ray_is_inside_multi_  .assign(nodes.size(), 0);
+        ray_is_blocked_multi_ .assign(nodes.size(), 0);
+        ray_is_drk_multi_     .assign(nodes.size(), 0);
+    }
+
+    return nodes;
+}
+
+void run_cell_lines(const Pos& p0,
+                    const bool hard_blocked[MAP_W][MAP_H],
+                    Los_result out[MAP_W][MAP_H],
+                    const int R)
+{
+    const Rect r = get_fov_rect(p0, R);
+
+    for (int x = r.p0.x; x <= r.p1.x; ++x)
+    {
+        for (int y = r.p0.y; y <= r.p1.y; ++y)
+        {
+            out[x][y] = check_cell(p0, {x, y}, hard_blocked, R);
+        }
+    }
+}
+
+//Gives exactly the same result as running check_cell() on each cell in the FOV rect. The
+//hard blocking and darkness rules of check_cell() are evaluated per line step instead of
+//per cell, and passed on from each node to its children:
+// * A node is hard blocked if any step before it (except the origin) is hard blocked.
+// * Darkness is accumulated from the third step onwards, and stops accumulating at the
+//   first hard blocked step (check_cell() stops walking the line there).
+// * The target itself being lit cancels darkness, so that is applied last.
+void run_ray_sweep(const Pos& p0,
+                   const bool hard_blocked[MAP_W][MAP_H],
+                   Los_result out[MAP_W][MAP_H],
+                   const int R)
+{
+    const std::vector<Ray_node>& ray_nodes = ray_tree(R);
+
+    const int NR_NODES = int(ray_nodes.size());
+
+    ray_is_blocked_before_[0] = false;
+    ray_is_drk_[0]            = false;
+
+    int i = 1;
+
+    while (i < NR_NODES)
+    {
+        const Ray_node& node = ray_nodes[i];
+
+        const Pos p(p0 + node.d);
+
+        if (!utils::is_pos_inside_map(p))
+        {
+            //Nothing further along these lines can be inside the map either
+            i = node.subtree_end;
+            continue;
+        }
+
+        const Ray_node& parent = ray_nodes[node.parent];
+        const Pos       parent_p(p0 + parent.d);
+
+        const bool IS_BLOCKED_BEFORE =
+            ray_is_blocked_before_[node.parent] ||
+            (parent.depth > 0 && hard_blocked[parent_p.x][parent_p.y]);
+
+        bool is_drk = ray_is_drk_[node.parent];
+
+        if (!IS_BLOCKED_BEFORE && !is_drk && node.depth > 1)
+        {
+            const auto& cur_cell = map::cells[p.x][p.y];
+
+            is_drk = !cur_cell.is_lit &&
+                     (cur_cell.is_dark || map::cells[parent_p.x][parent_p.y].is_dark);
+        }
+
+        ray_is_blocked_before_[i] = IS_BLOCKED_BEFORE;
+        ray_is_drk_[i]            = is_drk;
+
+        if (node.is_tgt)
+        {
+            Los_result& los = out[p.x][p.y];
+
+            los.is_blocked_hard   = IS_BLOCKED_BEFORE;
+            los.is_blocked_by_drk = is_drk && !map::cells[p.x][p.y].is_lit;
+        }
+
+        ++i;
+    }
+}
+
+//Same as run_ray_sweep(), but only sets the cells which are not hard blocked. Since hard
+//blocking is passed on to all children, blocked subtrees are skipped entirely.
+void run_ray_sweep_hard(const Pos& p0,
+                        const bool hard_blocked[MAP_W][MAP_H],
+                        Map_bits& out,
+                        const int R)
+{
+    const std::vector<Ray_node>& ray_nodes = ray_tree(R);
+
+    const int NR_NODES = int(ray_nodes.size());
+
+    out.set(p0);
+
+    int i = 1;
+
+    while (i < NR_NODES)
+    {
+        const Ray_node& node = ray_nodes[i];
+
+        const Pos p(p0 + node.d);
+
+        if (!utils::is_pos_inside_map(p))
+        {
+            i = node.subtree_end;
+            continue;
+        }
+
+        const Ray_node& parent = ray_nodes[node.parent];
+        const Pos       parent_p(p0 + parent.d);
+
+        if (parent.depth > 0 && hard_blocked[parent_p.x][parent_p.y])
+        {
+            i = node.subtree_end;
+            continue;
+        }
+
+        if (node.is_tgt)
+        {
+            out.set(p);
+        }
+
+        ++i;
+    }
+}
+
+//Same as run_ray_sweep() for up to 64 origins at once, so that each node of the tree is
+//visited once for all of them. Per origin, the cells which are not hard blocked are set in
+//the seen output, and the cells blocked by darkness are set in the darkness output. If there
+//is no darkness output, subtrees which are hard blocked for all origins are skipped (as in
+//run_ray_sweep_hard()). The bits passed on from each node to its children are:
+// * The origins for which the node is inside the map.
+// * The origins for which the node or any step before it (except the origin) is hard blocked.
+// * The origins for which darkness has been accumulated up to the node.
+void run_ray_sweep_multi(const Pos* const origins,
+                         const size_t NR_ORIGINS,
+                         const Map_bits& hard_blocked,
+                         Map_bits* const seen_out,
+                         Map_bits* const drk_out,
+                         const int R)
+{
+    assert(NR_ORIGINS > 0 && NR_ORIGINS <= RAY_MULTI_NR_ORIGINS_MAX);
+
+    const std::vector<Ray_node>& ray_nodes = ray_tree(R);
+
+    const int NR_NODES = int(ray_nodes.size());
+
+    ray_is_inside_multi_[0] =
+        NR_ORIGINS == RAY_MULTI_NR_ORIGINS_MAX ?
+        ~uint64_t(0) : (uint64_t(1) << NR_ORIGINS) - 1;
+
+    ray_is_blocked_multi_[0]    = 0;
+    ray_is_drk_multi_[0]        = 0;
+
+    for (size_t i = 0; i < NR_ORIGINS; ++i)
+    {
+        seen_out[i].set(origins[i]);
+    }
+
+    int i = 1;
+
+    while (i < NR_NODES)
+    {
+        const Ray_node& node    = ray_nodes[i];
+        const Ray_node& parent  = ray_nodes[node.parent];
+
+        const uint64_t IS_BLOCKED_BEFORE = ray_is_blocked_multi_[node.parent];
+
+        uint64_t origins_left = ray_is_inside_multi_[node.parent];
+
+        if (!drk_out)
+        {
+            origins_left &= ~IS_BLOCKED_BEFORE;
+        }
+
+        uint64_t is_inside  = 0;
+        uint64_t is_blocked = IS_BLOCKED_BEFORE;
+        uint64_t is_drk     = ray_is_drk_multi_[node.parent];
+
+        while (origins_left != 0)
+        {
+            const int       ORIGIN_IDX  = __builtin_ctzll(origins_left);
+            const uint64_t  BIT         = uint64_t(1) << ORIGIN_IDX;
+
+            origins_left &= origins_left - 1;
+
+            const Pos p(origins[ORIGIN_IDX] + node.d);
+
+            if (!utils::is_pos_inside_map(p))
+            {
+                //Nothing further along these lines can be inside the map either
+                continue;
+            }
+
+            is_inside |= BIT;
+
+            const auto& cur_cell = map::cells[p.x][p.y];
+
+            if (!(IS_BLOCKED_BEFORE & BIT))
+            {
+                if (drk_out && !(is_drk & BIT) && node.depth > 1)
+                {
+                    const Pos parent_p(origins[ORIGIN_IDX] + parent.d);
+
+                    if (
+                        !cur_cell.is_lit &&
+                        (cur_cell.is_dark || map::cells[parent_p.x][parent_p.y].is_dark))
+                    {
+                        is_drk |= BIT;
+                    }
+                }
+
+                if (hard_blocked.at(p))
+                {
+                    is_blocked |= BIT;
+                }
+
+                if (node.is_tgt)
+                {
+                    seen_out[ORIGIN_IDX].set(p);
+                }
+            }
+
+            if (node.is_tgt && drk_out && (is_drk & BIT) && !cur_cell.is_lit)
+            {
+                drk_out[ORIGIN_IDX].set(p);
+            }
+        }
+
+        ray_is_inside_multi_[i]     = is_inside;
+        ray_is_blocked_multi_[i]    = is_blocked;
+        ray_is_drk_multi_[i]        = is_drk;
+
+        const uint64_t IS_LIVE = drk_out ? is_inside : (is_inside & ~is_blocked);
+
+        i = IS_LIVE == 0 ? node.subtree_end : (i + 1);
+    }
+}
+
+Los_fov_cache_entry& los_fov_cache_entry(const Pos& p0)
+{
+    //Fibonacci hashing, the top bits are the best mixed
+    const unsigned int HASH = (unsigned int)((p0.x * MAP_H) + p0.y) * 2654435761u;
+
+    return los_fov_cache_[HASH >> (32 - LOS_FOV_CACHE_SIZE_LOG2)];
+}
+
+Lgt_cache_entry* find_lgt_cache_entry(const Pos& p0, const int R)
+{
+    auto it = std::find_if(begin(lgt_cache_), end(lgt_cache_),
+                           [&](const Lgt_cache_entry& e)
+    {
+        return e.origin == p0 && e.radi == R;
+    });
+
+    return it == end(lgt_cache_) ? nullptr : &(*it);
+}
+
+//A new entry with nothing lit (replacing the least recently used entry if the cache is full)
+Lgt_cache_entry& new_lgt_cache_entry(const Pos& p0, const int R)
+{
+    auto it = end(lgt_cache_);
+
+    if (lgt_cache_.size() < LGT_CACHE_SIZE_MAX)
+    {
+        lgt_cache_.push_back(Lgt_cache_entry());
+        it = end(lgt_cache_) - 1;
+    }
+    else //Cache is full
+    {
+        it = std::min_element(begin(lgt_cache_), end(lgt_cache_),
+                              [](const Lgt_cache_entry& e0, const Lgt_cache_entry& e1)
+        {
+            return e0.last_used < e1.last_used;
+        });
+    }
+
+    it->origin      = p0;
+    it->radi        = R;
+    it->last_used   = lgt_cache_nr_uses_;
+    it->lit.clear();
+
+    return *it;
+}
+
+} //namespace
+
+void run_hard(const Pos& p0,
+              const bool hard_blocked[MAP_W][MAP_H],
+              Map_bits& out,
+              const int R)
+{
+    switch (algo_)
+    {
+    case Fov_algo::cell_lines:
+    {
+        const Rect r = get_fov_rect(p0, R);
+
+        for (int x = r.p0.x; x <= r.p1.x; ++x)
+        {
+            for (int y = r.p0.y; y <= r.p1.y; ++y)
+            {
+                if (!check_cell(p0, {x, y}, hard_blocked, R).is_blocked_hard)
+                {
+                    out.set(x, y);
+                }
+            }
+        }
+
+        out.set(p0);
+    }
+    break;
+
+    case Fov_algo::ray_sweep:
+        run_ray_sweep_hard(p0, hard_blocked, out, R);
+        break;
+    }
+}
+
+void run_hard_multi(const std::vector<Pos>& origins,
+                    const Map_bits& hard_blocked,
+                    std::vector<Map_bits>& out,
+                    const int R)
+{
+    out.resize(origins.size());
+
+    for (Map_bits& fov : out)
+    {
+        fov.clear();
+    }
+
+    for (size_t i = 0; i < origins.size(); i += RAY_MULTI_NR_ORIGINS_MAX)
+    {
+        const size_t NR_ORIGINS = std::min(RAY_MULTI_NR_ORIGINS_MAX, origins.size() - i);
+
+        run_ray_sweep_multi(&origins[i], NR_ORIGINS, hard_blocked, &out[i], nullptr, R);
+    }
+}
+
+void init()
+{
+    for (auto& nodes : ray_trees_)
+    {
+        nodes.clear();
+    }
+
+    lgt_cache_.clear();
+}
+
+void set_algo(const Fov_algo algo)
+{
+    algo_ = algo;
+}
+
+Fov_algo algo()
+{
+    return algo_;
+}
+
+Rect get_fov_rect(const Pos& p, const int R)
+{
     const Pos p0(std::max(0, p.x - R),
                  std::max(0, p.y - R));
 
@@ -26,21 +606,22 @@ Rect get_fov_rect(const Pos& p)
     return Rect(p0, p1);
 }
 
-bool is_in_fov_range(const Pos& p0, const Pos& p1)
+bool is_in_fov_range(const Pos& p0, const Pos& p1, const int R)
 {
-    return utils::king_dist(p0, p1) <= FOV_STD_RADI_INT;
+    return utils::king_dist(p0, p1) <= R;
 }
 
 Los_result check_cell(const Pos& p0,
                       const Pos& p1,
-                      const bool hard_blocked[MAP_W][MAP_H])
+                      const bool hard_blocked[MAP_W][MAP_H],
+                      const int R)
 {
     Los_result los_result;
 
     los_result.is_blocked_hard      = true; //Assume we are blocked initially
     los_result.is_blocked_by_drk    = false;
 
-    if (!is_in_fov_range(p0, p1) || !utils::is_pos_inside_map(p1))
+    if (!is_in_fov_range(p0, p1, R) || !utils::is_pos_inside_map(p1))
     {
         //Target too far away, return the hard blocked result
         return los_result;
@@ -48,8 +629,8 @@ Los_result check_cell(const Pos& p0,
 
     const Pos delta(p1 - p0);
 
-    const std::vector<Pos>* path_deltas_ptr =
-        line_calc::fov_delta_line(delta, FOV_STD_RADI_DB);
+    const line_calc::Fov_delta_line* path_deltas_ptr =
+        line_calc::fov_delta_line(delta, double(R));
 
     if (!path_deltas_ptr)
     {
@@ -57,7 +638,7 @@ Los_result check_cell(const Pos& p0,
         return los_result;
     }
 
-    const std::vector<Pos>& path_deltas = *path_deltas_ptr;
+    const line_calc::Fov_delta_line& path_deltas = *path_deltas_ptr;
 
     const bool TGT_IS_LGT = map::cells[p1.x][p1.y].is_lit;
 
@@ -110,9 +691,237 @@ Los_result check_cell(const Pos& p0,
     return los_result;
 }
 
+Los_result check_cell_on_map(const Pos& p0, const Pos& p1)
+{
+    if (!is_in_fov_range(p0, p1) || !utils::is_pos_inside_map(p1))
+    {
+        Los_result los_result;
+        los_result.is_blocked_hard = true;
+        return los_result;
+    }
+
+    const Los_fov_cache_entry& fov_entry = los_fov_cache_entry(p0);
+
+    if (fov_entry.origin == p0 && fov_entry.stamp == los_cache_stamp_)
+    {
+        Los_result los_result;
+        los_result.is_blocked_hard      = !fov_entry.seen.at(p1);
+        los_result.is_blocked_by_drk    = fov_entry.drk.at(p1);
+        return los_result;
+    }
+
+    const int NR_CELLS  = MAP_W * MAP_H;
+    const int KEY       = (((p0.x * MAP_H) + p0.y) * NR_CELLS) + (p1.x * MAP_H) + p1.y;
+
+    //Fibonacci hashing, the top bits are the best mixed
+    const unsigned int  HASH    = (unsigned int)KEY * 2654435761u;
+    Los_cache_entry&    entry   = los_cache_[HASH >> (32 - LOS_CACHE_SIZE_LOG2)];
+
+    if (entry.key != KEY || entry.stamp != los_cache_stamp_)
+    {
+        entry.key   = KEY;
+        entry.stamp = los_cache_stamp_;
+        entry.los   = check_cell(p0, p1, map::los_blockers);
+    }
+
+    return entry.los;
+}
+
+void mk_los_cache_dirty()
+{
+    ++los_cache_stamp_;
+}
+
+void prepare_los_on_map(const std::vector<Pos>& origins)
+{
+    static std::vector<Pos> origins_to_run;
+
+    origins_to_run.clear();
+
+    for (const Pos& p0 : origins)
+    {
+        const Los_fov_cache_entry& entry = los_fov_cache_entry(p0);
+
+        if (entry.origin != p0 || entry.stamp != los_cache_stamp_)
+        {
+            origins_to_run.push_back(p0);
+        }
+    }
+
+    if (origins_to_run.empty())
+    {
+        return;
+    }
+
+    std::sort(begin(origins_to_run), end(origins_to_run),
+              [](const Pos& p0, const Pos& p1)
+    {
+        return p0.x != p1.x ? p0.x < p1.x : p0.y < p1.y;
+    });
+
+    origins_to_run.erase(std::unique(begin(origins_to_run), end(origins_to_run)),
+                         end(origins_to_run));
+
+    const Map_bits hard_blocked(map::los_blockers);
+
+    static std::vector<Map_bits> seen(RAY_MULTI_NR_ORIGINS_MAX);
+    static std::vector<Map_bits> drk (RAY_MULTI_NR_ORIGINS_MAX);
+
+    for (size_t i = 0; i < origins_to_run.size(); i += RAY_MULTI_NR_ORIGINS_MAX)
+    {
+        const size_t NR_ORIGINS =
+            std::min(RAY_MULTI_NR_ORIGINS_MAX, origins_to_run.size() - i);
+
+        for (size_t j = 0; j < NR_ORIGINS; ++j)
+        {
+            seen[j].clear();
+            drk [j].clear();
+        }
+
+        run_ray_sweep_multi(&origins_to_run[i], NR_ORIGINS, hard_blocked, &seen[0], &drk[0],
+                            FOV_STD_RADI_INT);
+
+        for (size_t j = 0; j < NR_ORIGINS; ++j)
+        {
+            const Pos& p0 = origins_to_run[i + j];
+
+            Los_fov_cache_entry& entry = los_fov_cache_entry(p0);
+
+            entry.origin    = p0;
+            entry.stamp     = los_cache_stamp_;
+            entry.seen      = seen[j];
+            entry.drk       = drk[j];
+        }
+    }
+}
+
+void add_lgt(const Pos& p0, Map_bits& light, const int R)
+{
+    ++lgt_cache_nr_uses_;
+
+    Lgt_cache_entry* entry = find_lgt_cache_entry(p0, R);
+
+    if (!entry)
+    {
+        if (is_lgt_batch_open_)
+        {
+            //Computed with the rest of the batch
+            lgt_batch_.push_back(Lgt_batch_entry(p0, R, light));
+            return;
+        }
+
+        entry = &new_lgt_cache_entry(p0, R);
+
+        run_hard(p0, map::los_blockers, entry->lit, R);
+    }
+
+    entry->last_used = lgt_cache_nr_uses_;
+
+    light |= entry->lit;
+}
+
+void begin_lgt_batch()
+{
+    assert(!is_lgt_batch_open_);
+
+    is_lgt_batch_open_ = true;
+
+    lgt_batch_.clear();
+}
+
+void end_lgt_batch()
+{
+    assert(is_lgt_batch_open_);
+
+    is_lgt_batch_open_ = false;
+
+    if (lgt_batch_.empty())
+    {
+        return;
+    }
+
+    const Map_bits hard_blocked(map::los_blockers);
+
+    static std::vector<Pos>         origins;
+    static std::vector<Map_bits>    lit;
+
+    //One run per radius (each radius has its own ray tree)
+    std::sort(begin(lgt_batch_), end(lgt_batch_),
+              [](const Lgt_batch_entry& e0, const Lgt_batch_entry& e1)
+    {
+        return e0.radi < e1.radi;
+    });
+
+    size_t radi_begin = 0;
+
+    while (radi_begin < lgt_batch_.size())
+    {
+        const int R = lgt_batch_[radi_begin].radi;
+
+        size_t radi_end = radi_begin;
+
+        origins.clear();
+
+        for (; radi_end < lgt_batch_.size() && lgt_batch_[radi_end].radi == R; ++radi_end)
+        {
+            const Pos& p0 = lgt_batch_[radi_end].origin;
+
+            if (std::find(begin(origins), end(origins), p0) == end(origins))
+            {
+                origins.push_back(p0);
+            }
+        }
+
+        run_hard_multi(origins, hard_blocked, lit, R);
+
+        for (size_t i = 0; i < origins.size(); ++i)
+        {
+            new_lgt_cache_entry(origins[i], R).lit = lit[i];
+        }
+
+        for (size_t i = radi_begin; i < radi_end; ++i)
+        {
+            const Lgt_batch_entry& entry = lgt_batch_[i];
+
+            const size_t ORIGIN_IDX =
+                std::find(begin(origins), end(origins), entry.origin) - begin(origins);
+
+            *entry.light |= lit[ORIGIN_IDX];
+        }
+
+        radi_begin = radi_end;
+    }
+
+    lgt_batch_.clear();
+}
+
+void mk_lgt_cache_dirty(const Pos& p)
+{
+    for (size_t i = 0; i < lgt_cache_.size(); /* No increment */)
+    {
+        const Lgt_cache_entry& entry = lgt_cache_[i];
+
+        if (is_in_fov_range(entry.origin, p, entry.radi))
+        {
+            std::swap(lgt_cache_[i], lgt_cache_.back());
+            lgt_cache_.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+void mk_lgt_cache_dirty()
+{
+    lgt_cache_.clear();
+}
+
 void run(const Pos& p0,
          const bool hard_blocked[MAP_W][MAP_H],
-         Los_result out[MAP_W][MAP_H])
+         Los_result out[MAP_W][MAP_H],
+         const int R)
 {
     for (int x = 0; x < MAP_W; ++x)
     {
@@ -125,14 +934,15 @@ void run(const Pos& p0,
         }
     }
 
-    const Rect r = get_fov_rect(p0);
-
-    for (int x = r.p0.x; x <= r.p1.x; ++x)
+    switch (algo_)
     {
-        for (int y = r.p0.y; y <= r.p1.y; ++y)
-        {
-            out[x][y] = check_cell(p0, {x, y}, hard_blocked);
-        }
+    case Fov_algo::cell_lines:
+        run_cell_lines(p0, hard_blocked, out, R);
+        break;
+
+    case Fov_algo::ray_sweep:
+        run_ray_sweep(p0, hard_blocked, out, R);
+        break;
     }
 
     out[p0.x][p0.y].is_blocked_hard = false;
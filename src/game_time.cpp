@@ -1,7 +1,10 @@
 #include "game_time.hpp"
 
+#include "init.hpp"
+
 #include <vector>
 #include <cassert>
+#include <algorithm>
 
 #include "cmn_types.hpp"
 #include "feature_rigid.hpp"
@@ -9,6 +12,7 @@
 #include "actor_player.hpp"
 #include "actor_mon.hpp"
 #include "map.hpp"
+#include "fov.hpp"
 #include "populate_monsters.hpp"
 #include "input.hpp"
 #include "inventory.hpp"
@@ -32,9 +36,31 @@ vector<Mob*> mobs_;
 namespace
 {
 
-vector<Actor_speed>  turn_type_vector_;
-int                 cur_turn_type_pos_   = 0;
-size_t              cur_actor_index_    = 0;
+//All actors and mobs, by position
+vector<Actor*>      actor_grid_[MAP_W][MAP_H];
+vector<Mob*>        mob_grid_[MAP_W][MAP_H];
+
+//Positions of rigids which need on_new_turn() calls
+vector<Pos>         active_rigids_;
+bool                is_rigid_active_[MAP_W][MAP_H];
+
+//The actors act in phases, which cycle through the turn types. Within a phase, the actors
+//act in the order they were added. Each actor (except the one currently acting) is kept in
+//a binary heap, by the next phase it can act in, so the next actor is found without polling
+//the speed of every actor.
+struct Sched_entry
+{
+    long    phase_nr;   //Number of phases since the counters were reset
+    long    order;      //Order in which the actor was added
+    Actor*  actor;
+};
+
+vector<Sched_entry> sched_heap_;
+long                cur_phase_nr_       = 0;
+long                cur_order_          = -1;
+long                nxt_order_          = 0;
+Actor*              cur_actor_          = nullptr;
+
 int                 turn_nr_             = 0;
 
 bool is_spi_regen_this_turn(const int REGEN_N_TURNS)
@@ -43,6 +69,265 @@ bool is_spi_regen_this_turn(const int REGEN_N_TURNS)
     return turn_nr_ == (turn_nr_ / REGEN_N_TURNS) * REGEN_N_TURNS;
 }
 
+template<typename T>
+void erase_from_cell(vector<T*>& cell, const T* const t)
+{
+    auto it = find(begin(cell), end(cell), t);
+
+    assert(it != end(cell));
+
+    cell.erase(it);
+}
+
+void grid_add_actor(Actor& actor)
+{
+    actor.grid_pos = actor.pos;
+    actor_grid_[actor.pos.x][actor.pos.y].push_back(&actor);
+}
+
+void grid_erase_actor(const Actor& actor)
+{
+    const Pos& p = actor.grid_pos;
+
+    erase_from_cell(actor_grid_[p.x][p.y], &actor);
+}
+
+void clear_grids()
+{
+    for (int x = 0; x < MAP_W; ++x)
+    {
+        for (int y = 0; y < MAP_H; ++y)
+        {
+            actor_grid_[x][y].clear();
+            mob_grid_[x][y].clear();
+        }
+    }
+}
+
+//Checks that the grid cell holds the same things as the linear scan would find
+template<typename T, typename Get_pos>
+void check_grid_cell(const vector<T*>& cell, const vector<T*>& all, const Pos& p,
+                     Get_pos get_pos)
+{
+    size_t nr_found = 0;
+
+    for (const T* const t : all)
+    {
+        if (get_pos(*t) == p)
+        {
+            assert(find(begin(cell), end(cell), t) != end(cell));
+            ++nr_found;
+        }
+    }
+
+    assert(nr_found == cell.size());
+
+    (void)cell;
+    (void)nr_found;
+}
+
+Turn_type turn_type(const long PHASE_NR)
+{
+    return Turn_type(PHASE_NR % long(Turn_type::END));
+}
+
+bool is_std_turn_phase(const Turn_type type)
+{
+    return type != Turn_type::fast && type != Turn_type::fastest;
+}
+
+bool can_act_in_phase(const Actor_speed speed, const Turn_type type)
+{
+    switch (speed)
+    {
+    case Actor_speed::sluggish:
+        return (type == Turn_type::slow || type == Turn_type::normal2) && rnd::fraction(2, 3);
+
+    case Actor_speed::slow:
+        return type == Turn_type::slow || type == Turn_type::normal2;
+
+    case Actor_speed::normal:
+        return is_std_turn_phase(type);
+
+    case Actor_speed::fast:
+        return type != Turn_type::fastest;
+
+    case Actor_speed::fastest:
+        return true;
+
+    case Actor_speed::END:
+        assert(false);
+        break;
+    }
+
+    return false;
+}
+
+//The first phase from the current position where the actor can act (in the current phase,
+//only if it's after the current actor)
+long nxt_phase_nr(const Actor& actor)
+{
+    const Actor_speed speed = actor.speed();
+
+    long phase_nr = actor.sched_order > cur_order_ ? cur_phase_nr_ : (cur_phase_nr_ + 1);
+
+    while (!can_act_in_phase(speed, turn_type(phase_nr)))
+    {
+        ++phase_nr;
+    }
+
+    return phase_nr;
+}
+
+bool is_sched_before(const Sched_entry& e0, const Sched_entry& e1)
+{
+    return e0.phase_nr != e1.phase_nr ? e0.phase_nr < e1.phase_nr : e0.order < e1.order;
+}
+
+void sched_set(const size_t IDX, const Sched_entry& e)
+{
+    sched_heap_[IDX]            = e;
+    e.actor->sched_heap_idx     = IDX;
+}
+
+void sched_sift_up(size_t idx)
+{
+    const Sched_entry e = sched_heap_[idx];
+
+    while (idx > 0)
+    {
+        const size_t PARENT_IDX = (idx - 1) / 2;
+
+        if (!is_sched_before(e, sched_heap_[PARENT_IDX]))
+        {
+            break;
+        }
+
+        sched_set(idx, sched_heap_[PARENT_IDX]);
+        idx = PARENT_IDX;
+    }
+
+    sched_set(idx, e);
+}
+
+void sched_sift_down(size_t idx)
+{
+    const Sched_entry   e       = sched_heap_[idx];
+    const size_t        SIZE    = sched_heap_.size();
+
+    while (true)
+    {
+        size_t child_idx = (idx * 2) + 1;
+
+        if (child_idx >= SIZE)
+        {
+            break;
+        }
+
+        if (child_idx + 1 < SIZE && is_sched_before(sched_heap_[child_idx + 1],
+                                                    sched_heap_[child_idx]))
+        {
+            ++child_idx;
+        }
+
+        if (!is_sched_before(sched_heap_[child_idx], e))
+        {
+            break;
+        }
+
+        sched_set(idx, sched_heap_[child_idx]);
+        idx = child_idx;
+    }
+
+    sched_set(idx, e);
+}
+
+void schedule(Actor& actor)
+{
+    assert(actor.sched_heap_idx == -1);
+
+    sched_heap_.push_back({nxt_phase_nr(actor), actor.sched_order, &actor});
+
+    sched_sift_up(sched_heap_.size() - 1);
+}
+
+void unschedule(Actor& actor)
+{
+    if (&actor == cur_actor_)
+    {
+        cur_actor_ = nullptr;
+        return;
+    }
+
+    const int IDX = actor.sched_heap_idx;
+
+    if (IDX == -1)
+    {
+        return;
+    }
+
+    actor.sched_heap_idx = -1;
+
+    const Sched_entry last = sched_heap_.back();
+
+    sched_heap_.pop_back();
+
+    if (size_t(IDX) < sched_heap_.size())
+    {
+        sched_set(IDX, last);
+        sched_sift_up(IDX);
+        sched_sift_down(last.actor->sched_heap_idx);
+    }
+}
+
+Actor* pop_first_scheduled()
+{
+    Actor* const actor = sched_heap_.front().actor;
+
+    unschedule(*actor);
+
+    return actor;
+}
+
+//Makes the first scheduled actor the current actor, in the phase it was scheduled for
+void set_first_scheduled_as_cur_actor()
+{
+    assert(!cur_actor_);
+
+    cur_phase_nr_   = sched_heap_.front().phase_nr;
+    cur_actor_      = pop_first_scheduled();
+    cur_order_      = cur_actor_->sched_order;
+}
+
+void clear_schedule()
+{
+    for (Sched_entry& e : sched_heap_)
+    {
+        e.actor->sched_heap_idx = -1;
+    }
+
+    sched_heap_.clear();
+
+    cur_phase_nr_   = 0;
+    cur_order_      = -1;
+    cur_actor_      = nullptr;
+}
+
+bool is_active(const Rigid& rigid)
+{
+    return rigid.burn_state() == Burn_state::burning || rigid.has_new_turn_hook();
+}
+
+void clear_active_rigids()
+{
+    for (const Pos& p : active_rigids_)
+    {
+        is_rigid_active_[p.x][p.y] = false;
+    }
+
+    active_rigids_.clear();
+}
+
 void run_std_turn_events()
 {
     ++turn_nr_;
@@ -62,17 +347,25 @@ void run_std_turn_events()
                 return;
             }
 
+            //The current actor is deleted on a later standard turn (there must always be a
+            //current actor)
+            if (actor == cur_actor_)
+            {
+                continue;
+            }
+
             if (map::player->tgt_ == actor)
             {
                 map::player->tgt_ = nullptr;
             }
 
+            grid_erase_actor(*actor);
+            unschedule(*actor);
+
             delete actor;
 
             actors_.erase(actors_.begin() + i);
             i--;
-
-            if (cur_actor_index_ >= actors_.size()) {cur_actor_index_ = 0;}
         }
         else  //Actor is alive or is a corpse
         {
@@ -123,17 +416,45 @@ void run_std_turn_events()
         }
     }
 
-    //New turn for rigids
-    for (int x = 0; x < MAP_W; ++x)
+    //New turn for rigids - only the ones registered as active. Rigids which become active
+    //during this are processed from the next turn.
+    static vector<Pos> active_rigids_cpy;
+
+    active_rigids_cpy = active_rigids_;
+
+    sort(begin(active_rigids_cpy), end(active_rigids_cpy),
+         [](const Pos& p0, const Pos& p1)
     {
-        for (int y = 0; y < MAP_H; ++y)
+        return p0.x != p1.x ? p0.x < p1.x : p0.y < p1.y;
+    });
+
+    for (const Pos& p : active_rigids_cpy)
+    {
+        if (is_active(*map::cells[p.x][p.y].rigid))
+        {
+            map::cells[p.x][p.y].rigid->on_new_turn();
+        }
+    }
+
+    //Drop the rigids which are no longer active (they may also have been replaced)
+    for (size_t i = 0; i < active_rigids_.size(); ++i)
+    {
+        const Pos& p = active_rigids_[i];
+
+        if (!is_active(*map::cells[p.x][p.y].rigid))
         {
-            map::cells[x][y].rigid->on_new_turn();
+            is_rigid_active_[p.x][p.y] = false;
+
+            active_rigids_[i] = active_rigids_.back();
+            active_rigids_.pop_back();
+            --i;
         }
     }
 
     //New turn for mobs (using a copied vector, since mobs may get destroyed)
-    const vector<Mob*> mobs_cpy = mobs_;
+    static vector<Mob*> mobs_cpy;
+
+    mobs_cpy = mobs_;
 
     for (auto* f : mobs_cpy) {f->on_new_turn();}
 
@@ -171,6 +492,22 @@ void run_std_turn_events()
     {
         audio::try_play_amb(100);
     }
+
+    //The monsters look for foes on their turns, so their LOS is computed for all of them
+    //together (monsters who have moved since then check each line separately)
+    static vector<Pos> mon_origins;
+
+    mon_origins.clear();
+
+    for (const Actor* const actor : actors_)
+    {
+        if (!actor->is_player() && actor->is_alive())
+        {
+            mon_origins.push_back(actor->pos);
+        }
+    }
+
+    fov::prepare_los_on_map(mon_origins);
 }
 
 void run_atomic_turn_events()
@@ -182,9 +519,13 @@ void run_atomic_turn_events()
 
 void init()
 {
-    cur_turn_type_pos_ = cur_actor_index_ = turn_nr_ = 0;
+    turn_nr_    = 0;
+    nxt_order_  = 0;
     actors_.clear();
     mobs_  .clear();
+    clear_grids();
+    clear_active_rigids();
+    clear_schedule();
 }
 
 void cleanup()
@@ -196,6 +537,10 @@ void cleanup()
     for (auto* f : mobs_) {delete f;}
 
     mobs_.clear();
+
+    clear_grids();
+    clear_active_rigids();
+    clear_schedule();
 }
 
 void store_to_save_lines(vector<string>& lines)
@@ -214,16 +559,44 @@ int turn()
     return turn_nr_;
 }
 
-void mobs_at_pos(const Pos& p, vector<Mob*>& vector_ref)
+const vector<Actor*>& actors_at_pos(const Pos& p)
 {
-    vector_ref.clear();
+    const vector<Actor*>& cell = actor_grid_[p.x][p.y];
+
+    if (IS_DEBUG_MODE)
+    {
+        check_grid_cell(cell, actors_, p, [](const Actor& a) {return a.pos;});
+    }
 
-    for (auto* m : mobs_) {if (m->pos() == p) {vector_ref.push_back(m);}}
+    return cell;
+}
+
+const vector<Mob*>& mobs_at_pos(const Pos& p)
+{
+    const vector<Mob*>& cell = mob_grid_[p.x][p.y];
+
+    if (IS_DEBUG_MODE)
+    {
+        check_grid_cell(cell, mobs_, p, [](const Mob& m) {return m.pos();});
+    }
+
+    return cell;
+}
+
+void mobs_at_pos(const Pos& p, vector<Mob*>& vector_ref)
+{
+    vector_ref = mobs_at_pos(p);
 }
 
 void add_mob(Mob* const f)
 {
     mobs_.push_back(f);
+
+    const Pos p = f->pos();
+
+    mob_grid_[p.x][p.y].push_back(f);
+
+    map::mk_vision_dirty(p);
 }
 
 void erase_mob(Mob* const f, const bool DESTROY_OBJECT)
@@ -232,27 +605,80 @@ void erase_mob(Mob* const f, const bool DESTROY_OBJECT)
     {
         if (*it == f)
         {
+            const Pos p = f->pos();
+
+            erase_from_cell(mob_grid_[p.x][p.y], f);
+
             if (DESTROY_OBJECT) {delete f;}
 
             mobs_.erase(it);
+
+            map::mk_vision_dirty(p);
             return;
         }
     }
 }
 
+void add_active_rigid(const Pos& p)
+{
+    if (!is_rigid_active_[p.x][p.y])
+    {
+        is_rigid_active_[p.x][p.y] = true;
+        active_rigids_.push_back(p);
+    }
+}
+
 void erase_all_mobs()
 {
-    for (auto* m : mobs_) {delete m;}
+    vector<Pos> positions;
+
+    for (auto* m : mobs_)
+    {
+        const Pos p = m->pos();
+
+        positions.push_back(p);
+        mob_grid_[p.x][p.y].clear();
+
+        delete m;
+    }
 
     mobs_.clear();
+
+    for (const Pos& p : positions)
+    {
+        map::mk_vision_dirty(p);
+    }
 }
 
 void erase_actor_in_element(const size_t i)
 {
     if (!actors_.empty())
     {
+        const bool IS_CUR_ACTOR = actors_[i] == cur_actor_;
+
+        grid_erase_actor(*actors_[i]);
+        unschedule(*actors_[i]);
+
         delete actors_[i];
         actors_.erase(actors_.begin() + i);
+
+        //The next actor acts instead of the erased one
+        if (IS_CUR_ACTOR && !sched_heap_.empty())
+        {
+            set_first_scheduled_as_cur_actor();
+        }
+    }
+}
+
+void update_actor_pos(Actor& actor)
+{
+    //Actors which are not added yet (e.g. the player while loading a game) are not in the grid
+    const bool IS_IN_GRID = actor.grid_pos.x != -1;
+
+    if (IS_IN_GRID && actor.pos != actor.grid_pos)
+    {
+        grid_erase_actor(actor);
+        grid_add_actor(actor);
     }
 }
 
@@ -261,16 +687,46 @@ void add_actor(Actor* actor)
     //Sanity check actor inserted
     assert(utils::is_pos_inside_map(actor->pos));
     actors_.push_back(actor);
+
+    grid_add_actor(*actor);
+
+    actor->sched_order = nxt_order_++;
+
+    //NOTE: The first actor to act is set by reset_turn_type_and_actor_counters()
+    schedule(*actor);
+}
+
+void update_actor_speed(Actor& actor)
+{
+    if (actor.sched_heap_idx != -1)
+    {
+        unschedule(actor);
+        schedule(actor);
+    }
 }
 
 void reset_turn_type_and_actor_counters()
 {
-    cur_turn_type_pos_ = cur_actor_index_ = 0;
+    clear_schedule();
+
+    if (actors_.empty())
+    {
+        return;
+    }
+
+    //The first actor acts first, in the first phase
+    cur_actor_ = actors_.front();
+    cur_order_ = cur_actor_->sched_order;
+
+    for (size_t i = 1; i < actors_.size(); ++i)
+    {
+        schedule(*actors_[i]);
+    }
 }
 
-//For every turn type step, run through all actors and let those who can act during this
-//type of turn act. When all actors who can act on this phase have acted, and if this is
-//a normal speed phase - consider it a standard turn (update properties, update features,
+//Phases cycle through each turn type, and the actors who can act during the type of phase
+//get to act in it. When all actors who can act in a phase have acted, and if this is a
+//normal speed phase - consider it a standard turn (update properties, update features,
 //spawn more monsters etc.)
 void tick(const bool IS_FREE_TURN)
 {
@@ -315,62 +771,27 @@ void tick(const bool IS_FREE_TURN)
 
     if (!IS_FREE_TURN)
     {
-        bool can_act = false;
-
-        while (!can_act)
-        {
-            auto cur_turn_type = Turn_type(cur_turn_type_pos_);
-
-            ++cur_actor_index_;
+        //The actor is scheduled again, and the next actor is picked, before any standard
+        //turn is run. The standard turns may destroy actors, spawn new ones, and even end the
+        //turn of the current actor (e.g. when the player goes insane), so there must be a
+        //current actor during them.
+        schedule(*actor);
 
-            if (cur_actor_index_ >= actors_.size())
-            {
-                cur_actor_index_ = 0;
+        cur_actor_ = nullptr;
 
-                ++cur_turn_type_pos_;
+        const long PHASE_NR_BEFORE = cur_phase_nr_;
 
-                if (cur_turn_type_pos_ == int(Turn_type::END))
-                {
-                    cur_turn_type_pos_ = 0;
-                }
-
-                if (cur_turn_type != Turn_type::fast && cur_turn_type != Turn_type::fastest)
-                {
-                    run_std_turn_events();
-                }
-            }
+        set_first_scheduled_as_cur_actor();
 
-            const auto speed = cur_actor()->speed();
+        //Run the standard turns for the phases passed (all actors who could act in them have
+        //acted)
+        const long PHASE_NR_AFTER = cur_phase_nr_;
 
-            switch (speed)
+        for (long phase_nr = PHASE_NR_BEFORE; phase_nr < PHASE_NR_AFTER; ++phase_nr)
+        {
+            if (is_std_turn_phase(turn_type(phase_nr)))
             {
-            case Actor_speed::sluggish:
-                can_act = (cur_turn_type == Turn_type::slow ||
-                           cur_turn_type == Turn_type::normal2)
-                          && rnd::fraction(2, 3);
-                break;
-
-            case Actor_speed::slow:
-                can_act = cur_turn_type == Turn_type::slow ||
-                          cur_turn_type == Turn_type::normal2;
-                break;
-
-            case Actor_speed::normal:
-                can_act = cur_turn_type != Turn_type::fast &&
-                          cur_turn_type != Turn_type::fastest;
-                break;
-
-            case Actor_speed::fast:
-                can_act = cur_turn_type != Turn_type::fastest;
-                break;
-
-            case Actor_speed::fastest:
-                can_act = true;
-                break;
-
-            case Actor_speed::END:
-                assert(false);
-                break;
+                run_std_turn_events();
             }
         }
     }
@@ -378,45 +799,68 @@ void tick(const bool IS_FREE_TURN)
 
 void update_light_map()
 {
-    bool light_tmp[MAP_W][MAP_H];
+    Map_bits light;
 
-    for (int x = 0; x < MAP_W; ++x)
+    //Do not add light on Leng
+    if (map_travel::map_type() != Map_type::leng)
     {
-        for (int y = 0; y < MAP_H; ++y)
+        //Light sources which are not cached are computed together
+        fov::begin_lgt_batch();
+
+        for (const auto* const a : actors_)  {a->add_light(light);}
+
+        for (const auto* const m : mobs_)    {m->add_light(light);}
+
+        for (int x = 0; x < MAP_W; ++x)
         {
-            map::cells[x][y].is_lit = light_tmp[x][y] = false;
-        }
-    }
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                auto* rigid = map::cells[x][y].rigid;
 
-    //Do not add light on Leng
-    if (map_travel::map_type() == Map_type::leng) {return;}
+                if (rigid->burn_state() == Burn_state::burning)
+                {
+                    light.set(x, y);
+                }
+
+                rigid->add_light(light);
+            }
+        }
 
-    for (const auto* const a : actors_)  {a->add_light(light_tmp);}
+        fov::end_lgt_batch();
+    }
 
-    for (const auto* const m : mobs_)    {m->add_light(light_tmp);}
+    //Copy to the real light map. Lit cells are seen differently (but light does not affect
+    //the light sources, so the light cache is kept).
+    bool is_any_lgt_changed = false;
 
     for (int x = 0; x < MAP_W; ++x)
     {
         for (int y = 0; y < MAP_H; ++y)
         {
-            auto* rigid = map::cells[x][y].rigid;
+            Cell&       cell    = map::cells[x][y];
+            const bool  IS_LIT  = light.at(x, y);
 
-            if (rigid->burn_state() == Burn_state::burning)
+            if (cell.is_lit != IS_LIT)
             {
-                light_tmp[x][y] = true;
-            }
+                cell.is_lit         = IS_LIT;
+                is_any_lgt_changed  = true;
 
-            rigid->add_light(light_tmp);
-
-            //Copy the temp values to the real light map.
-            map::cells[x][y].is_lit = light_tmp[x][y];
+                map::player->mk_fov_dirty(Pos(x, y));
+            }
         }
     }
+
+    if (is_any_lgt_changed)
+    {
+        fov::mk_los_cache_dirty();
+    }
 }
 
 Actor* cur_actor()
 {
-    Actor* const actor = actors_[cur_actor_index_];
+    Actor* const actor = cur_actor_;
+
+    assert(actor);
 
     //Sanity check actor retrieved
     assert(utils::is_pos_inside_map(actor->pos));
@@ -7,6 +7,7 @@
 #include "render.hpp"
 #include "audio.hpp"
 #include "line_calc.hpp"
+#include "fov.hpp"
 #include "gods.hpp"
 #include "item_scroll.hpp"
 #include "item_potion.hpp"
@@ -58,6 +59,7 @@ void init_game()
 {
     TRACE_FUNC_BEGIN;
     line_calc::init();
+    fov::init();
     gods::init();
     manual::init();
     credits::init();
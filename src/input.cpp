@@ -1002,6 +1002,8 @@ void handle_map_mode_key_press(const Key_data& d)
                 init::is_cheat_vision_enabled = true;
             }
 
+            //The FOV is not updated unless marked dirty (the player has not moved)
+            map::player->mk_fov_dirty();
             map::player->update_fov();
             render::draw_map_and_interface();
         }
@@ -1111,7 +1113,7 @@ void clear_events()
 {
     if (is_inited_)
     {
-        while (SDL_PollEvent(&sdl_event_)) {}
+        while (sdl_wrapper::poll_event(sdl_event_)) {}
     }
 }
 
@@ -1124,7 +1126,7 @@ Key_data input(const bool IS_O_RETURN)
         return ret;
     }
 
-    SDL_StartTextInput();
+    sdl_wrapper::run_on_main_thread(SDL_StartTextInput);
 
     bool is_done = false;
 
@@ -1132,7 +1134,7 @@ Key_data input(const bool IS_O_RETURN)
     {
         sdl_wrapper::sleep(1);
 
-        const bool DID_POLL_EVENT = SDL_PollEvent(&sdl_event_);
+        const bool DID_POLL_EVENT = sdl_wrapper::poll_event(sdl_event_);
 
         if (!DID_POLL_EVENT)
         {
@@ -1159,6 +1161,10 @@ Key_data input(const bool IS_O_RETURN)
         }
         break;
 
+        case SDL_RENDER_TARGETS_RESET:
+            render::on_render_targets_reset();
+            break;
+
         case SDL_QUIT:
             ret = Key_data(SDLK_ESCAPE);
             is_done = true;
@@ -1180,7 +1186,9 @@ Key_data input(const bool IS_O_RETURN)
                 continue;
             }
 
-            Uint16 mod = SDL_GetModState();
+            //NOTE: The modifier state of the event is used, since the current state may have
+            //changed while the event was queued
+            Uint16 mod = sdl_event_.key.keysym.mod;
 
             const bool  IS_SHIFT_HELD = mod & KMOD_SHIFT;
             const bool  IS_CTRL_HELD  = mod & KMOD_CTRL;
@@ -1271,7 +1279,7 @@ Key_data input(const bool IS_O_RETURN)
         } //End of event type switch
     } //End of while loop
 
-    SDL_StopTextInput();
+    sdl_wrapper::run_on_main_thread(SDL_StopTextInput);
 
     return ret;
 }
@@ -553,6 +553,7 @@ void Potion_clairv::quaff_impl(Actor& actor)
 
         render::draw_map_and_interface(false);
 
+        map::player->mk_fov_dirty();
         map::player->update_fov();
 
         render::draw_blast_at_cells(anim_cells, clr_white);
@@ -8,7 +8,6 @@
 #include "msg_log.hpp"
 #include "query.hpp"
 #include "render.hpp"
-#include "map_parsing.hpp"
 #include "utils.hpp"
 #include "text_format.hpp"
 
@@ -39,8 +38,6 @@ void player_kick()
             if (map::player->prop_handler().allow_attack_melee(Verbosity::verbose))
             {
                 TRACE << "Player is allowed to do melee attack" << endl;
-                bool blocked[MAP_W][MAP_H];
-                map_parse::run(cell_check::Blocks_los(), blocked);
 
                 TRACE << "Player can see actor" << endl;
                 map::player->kick_mon(*living_actor);
@@ -11,7 +11,6 @@
 #include "game_time.hpp"
 #include "render.hpp"
 #include "map_parsing.hpp"
-#include "sdl_wrapper.hpp"
 #include "feature_rigid.hpp"
 #include "feature_mob.hpp"
 
@@ -98,10 +97,12 @@ void try_knock_back(Actor&        defender,
 
             defender.pos = new_pos;
 
+            game_time::update_actor_pos(defender);
+
             if (i == KNOCK_RANGE - 1)
             {
                 render::draw_map_and_interface();
-                sdl_wrapper::sleep(config::delay_projectile_draw());
+                render::hold_frame(config::delay_projectile_draw());
             }
 
             if (IS_CELL_BOTTOMLESS && !defender.has_prop(Prop_id::flying))
@@ -2,6 +2,8 @@
 
 #include <math.h>
 #include <vector>
+#include <cstdlib>
+#include <algorithm>
 
 #include "utils.hpp"
 
@@ -13,68 +15,243 @@ namespace line_calc
 namespace
 {
 
-double      fov_abs_distances_[FOV_MAX_W_INT][FOV_MAX_W_INT];
-vector<Pos> fov_delta_lines_[FOV_MAX_W_INT][FOV_MAX_W_INT];
+//The FOV distance and line of each delta are calculated the first time the delta is
+//requested, so only the deltas within the radii actually used are ever calculated
+bool            fov_delta_is_calculated_[FOV_MAX_W_INT][FOV_MAX_W_INT];
+
+//Floored distances (at most about 23, so a byte is enough)
+unsigned char   fov_abs_distances_[FOV_MAX_W_INT][FOV_MAX_W_INT];
+
+//All FOV line steps are stored contiguously, and each line is a view into this array. The
+//capacity needed for all lines is reserved by init(), so the views stay valid as lines are
+//added.
+vector<Line_step>       fov_line_steps_;
+Fov_delta_line          fov_delta_lines_[FOV_MAX_W_INT][FOV_MAX_W_INT];
+
+//Lines are defined by walking from the center of the origin cell towards the center of the
+//target cell, in steps of 1/25 of a cell, and adding each new cell entered. Rather than
+//taking each step, the rasterizer below finds the step where the next cell is entered on
+//each axis directly, using integers only.
+const long long RAY_STEPS_PER_CELL  = 25;
+const long long RAY_STEPS_MAX       = 9999 * RAY_STEPS_PER_CELL;
+
+//Keeps the squared values below within 64 bits
+const int       RAY_DELTA_MAX       = 1000;
+
+//The first step K (>= 1) where the walk has moved at least N - 0.5 cells along an axis
+//with absolute delta D, i.e. the first K where:
+//  K * D / (25 * hypot) >= N - 0.5  <=>  (2 * K * D)^2 >= (25 * (2N - 1))^2 * hypot^2
+long long first_step_crossing(const long long D, const long long N, const long long HYPOT2)
+{
+    const long long B = RAY_STEPS_PER_CELL * ((2 * N) - 1);
 
-} //Namespace
+    auto is_crossed = [&](const long long K)
+    {
+        const long long A = 2 * K * D;
+        return A * A >= B * B * HYPOT2;
+    };
 
-void init()
+    //Estimate, then correct any rounding error
+    long long k = (long long)(ceil((double(B) * sqrt(double(HYPOT2))) / (2.0 * double(D))));
+
+    k = std::max(1LL, k);
+
+    while (k > 1 && is_crossed(k - 1)) {--k;}
+
+    while (!is_crossed(k)) {++k;}
+
+    return k;
+}
+
+void rasterize_line(const Pos& origin, const Pos& tgt,
+                    const bool SHOULD_STOP_AT_TARGET, const int CHEB_TRAVEL_LIMIT,
+                    const bool ALLOW_OUTSIDE_MAP, vector<Pos>& line_ref)
+{
+    const Pos       delta(tgt - origin);
+    const Pos       sign(delta.signs());
+    const long long ABS_DX = std::abs(delta.x);
+    const long long ABS_DY = std::abs(delta.y);
+    const long long HYPOT2 = (ABS_DX * ABS_DX) + (ABS_DY * ABS_DY);
+
+    assert(ABS_DX <= RAY_DELTA_MAX && ABS_DY <= RAY_DELTA_MAX);
+
+    const long long NO_CROSSING = RAY_STEPS_MAX + 1;
+
+    //Number of cells moved along each axis, and the step where the next cell is entered
+    int         nr_x        = 0;
+    int         nr_y        = 0;
+    long long   next_step_x = ABS_DX == 0 ? NO_CROSSING : first_step_crossing(ABS_DX, 1, HYPOT2);
+    long long   next_step_y = ABS_DY == 0 ? NO_CROSSING : first_step_crossing(ABS_DY, 1, HYPOT2);
+
+    //NOTE: The first step is too short to leave the origin, so the origin is always added
+    Pos cur_pos(origin);
+
+    while (true)
+    {
+        if (!ALLOW_OUTSIDE_MAP && !utils::is_pos_inside_map(cur_pos)) {return;}
+
+        line_ref.push_back(cur_pos);
+
+        //Check distance limits
+        if (SHOULD_STOP_AT_TARGET && (cur_pos == tgt))
+        {
+            return;
+        }
+
+        const int DISTANCE_TRAVELED = std::max(nr_x, nr_y);
+
+        if (DISTANCE_TRAVELED >= CHEB_TRAVEL_LIMIT)
+        {
+            return;
+        }
+
+        const long long STEP = std::min(next_step_x, next_step_y);
+
+        if (STEP > RAY_STEPS_MAX)
+        {
+            return;
+        }
+
+        if (next_step_x == STEP)
+        {
+            ++nr_x;
+            next_step_x = first_step_crossing(ABS_DX, nr_x + 1, HYPOT2);
+        }
+
+        if (next_step_y == STEP)
+        {
+            ++nr_y;
+            next_step_y = first_step_crossing(ABS_DY, nr_y + 1, HYPOT2);
+        }
+
+        cur_pos.set(origin.x + (sign.x * nr_x), origin.y + (sign.y * nr_y));
+    }
+}
+
+//Line offsets for each delta between two map cells, calculated on first use. The rays go
+//through the target until king distance MAP_W, so they can be cut down to any line from any
+//origin. They are stored contiguously in ray_steps_, which only grows.
+struct Cached_ray
+{
+    Cached_ray() : offset(-1), size(0), tgt_idx(-1) {}
+
+    int offset, size, tgt_idx;
+};
+
+const int   RAY_CACHE_W = (MAP_W * 2) - 1;
+const int   RAY_CACHE_H = (MAP_H * 2) - 1;
+
+Cached_ray          ray_cache_[RAY_CACHE_W][RAY_CACHE_H];
+vector<Line_step>   ray_steps_;
+
+const Cached_ray* cached_ray(const Pos& delta)
 {
-    //----------------------------------------------------------
-    //Calculate FOV absolute distances
-    for (int y = 0; y < FOV_MAX_W_INT; ++y)
+    const int X = delta.x + MAP_W - 1;
+    const int Y = delta.y + MAP_H - 1;
+
+    if (X < 0 || Y < 0 || X >= RAY_CACHE_W || Y >= RAY_CACHE_H)
     {
-        for (int x = 0; x < FOV_MAX_W_INT; ++x)
+        return nullptr;
+    }
+
+    Cached_ray& ray = ray_cache_[X][Y];
+
+    if (ray.offset < 0)
+    {
+        vector<Pos> offsets;
+
+        rasterize_line(Pos(0, 0), delta, false, MAP_W, true, offsets);
+
+        ray.offset  = int(ray_steps_.size());
+        ray.size    = int(offsets.size());
+
+        for (int i = 0; i < ray.size; ++i)
         {
-            fov_abs_distances_[x][y] = 0;
+            const Pos& p = offsets[i];
+
+            ray_steps_.push_back({(signed char)(p.x), (signed char)(p.y)});
+
+            if (p == delta)
+            {
+                ray.tgt_idx = i;
+            }
         }
+
+        assert(ray.tgt_idx >= 0);
     }
 
-    double delta_x, delta_y, hypot;
+    return &ray;
+}
+
+void calc_fov_delta(const int X, const int Y)
+{
+    const Pos delta(X - FOV_MAX_RADI_INT, Y - FOV_MAX_RADI_INT);
+
+    const double HYPOT = sqrt(double((delta.x * delta.x) + (delta.y * delta.y)));
+
+    fov_abs_distances_[X][Y] = (unsigned char)(floor(HYPOT));
+
+    vector<Pos> line;
+    calc_new_line(Pos(0, 0), delta, true, 999, true, line);
+
+    const size_t OFFSET = fov_line_steps_.size();
+
+    assert(OFFSET + line.size() <= fov_line_steps_.capacity());
+
+    for (const Pos& p : line)
+    {
+        fov_line_steps_.push_back({(signed char)(p.x), (signed char)(p.y)});
+    }
+
+    fov_delta_lines_[X][Y] = Fov_delta_line(fov_line_steps_.data() + OFFSET, line.size());
+
+    fov_delta_is_calculated_[X][Y] = true;
+}
 
-    //delta_x corresponds to i - FOV_MAX_W_INT, and vice versa for delta_y and j.
-    //So:
-    //i = 0                 => delta_x = -FOV_MAX_W_INT
-    //i = FOV_MAX_W_INT * 2 => delta_x =  FOV_MAX_W_INT
+} //Namespace
 
-    const int R_INT = FOV_MAX_RADI_INT;
+void init()
+{
+    //A line never has more steps than the delta x plus the delta y, plus the origin
+    size_t nr_steps_max = 0;
 
-    for (int x = 0; x <= R_INT * 2; ++x)
+    for (int x = 0; x < FOV_MAX_W_INT; ++x)
     {
-        for (int y = 0; y <= R_INT * 2; ++y)
+        for (int y = 0; y < FOV_MAX_W_INT; ++y)
         {
-            delta_x = double(x);
-            delta_x -= FOV_MAX_RADI_DB;
-            delta_y = double(y);
-            delta_y -= FOV_MAX_RADI_DB;
-            hypot = sqrt((delta_x * delta_x) + (delta_y * delta_y));
-            fov_abs_distances_[x][y] = floor(hypot);
+            fov_delta_is_calculated_[x][y] = false;
+
+            nr_steps_max += abs(x - FOV_MAX_RADI_INT) + abs(y - FOV_MAX_RADI_INT) + 1;
         }
     }
 
-    //----------------------------------------------------------
-    //Calculate FOV delta lines
-    for (int delta_x = -R_INT; delta_x <= R_INT; delta_x++)
+    fov_line_steps_.clear();
+    fov_line_steps_.shrink_to_fit();
+    fov_line_steps_.reserve(nr_steps_max);
+
+    ray_steps_.clear();
+
+    for (int x = 0; x < RAY_CACHE_W; ++x)
     {
-        for (int delta_y = -R_INT; delta_y <= R_INT; delta_y++)
+        for (int y = 0; y < RAY_CACHE_H; ++y)
         {
-            const Pos origin(0, 0);
-            const Pos tgt(Pos(delta_x, delta_y));
-            vector<Pos> cur_line;
-            calc_new_line(origin, tgt, true, 999, true, cur_line);
-            fov_delta_lines_[delta_x + R_INT][delta_y + R_INT] = cur_line;
+            ray_cache_[x][y] = Cached_ray();
         }
     }
 }
 
-const vector<Pos>* fov_delta_line(const Pos& delta,
-                                  const double& MAX_DIST_ABS)
+const Fov_delta_line* fov_delta_line(const Pos& delta, const double& MAX_DIST_ABS)
 {
     const int X = delta.x + FOV_MAX_RADI_INT;
     const int Y = delta.y + FOV_MAX_RADI_INT;
 
     if (X >= 0 && Y >= 0 && X < FOV_MAX_W_INT && Y < FOV_MAX_W_INT)
     {
+        if (!fov_delta_is_calculated_[X][Y])
+        {
+            calc_fov_delta(X, Y);
+        }
+
         if (fov_abs_distances_[X][Y] <= MAX_DIST_ABS)
         {
             return &(fov_delta_lines_[X][Y]);
@@ -96,53 +273,39 @@ void calc_new_line(const Pos& origin, const Pos& tgt,
         return;
     }
 
-    const double DELTA_X_DB = double(tgt.x - origin.x);
-    const double DELTA_Y_DB = double(tgt.y - origin.y);
-
-    const double HYPOT_DB   = sqrt((DELTA_X_DB * DELTA_X_DB) + (DELTA_Y_DB * DELTA_Y_DB));
-
-    const double X_INCR_DB  = (DELTA_X_DB / HYPOT_DB);
-    const double Y_INCR_DB  = (DELTA_Y_DB / HYPOT_DB);
-
-    double cur_x_db = double(origin.x) + 0.5;
-    double cur_y_db = double(origin.y) + 0.5;
+    const Cached_ray* const ray = cached_ray(tgt - origin);
 
-    Pos cur_pos = Pos(int(cur_x_db), int(cur_y_db));
+    //The cached ray reaches king distance MAP_W, which is always outside the map when
+    //starting from inside the map, and the ray always passes through the target. So it
+    //covers everything except long lines allowed to go outside the map.
+    const bool IS_RAY_COVERING =
+        ray &&
+        (!ALLOW_OUTSIDE_MAP || SHOULD_STOP_AT_TARGET || CHEB_TRAVEL_LIMIT <= MAP_W);
 
-    const double STEP_SIZE_DB = 0.04;
+    if (!IS_RAY_COVERING)
+    {
+        rasterize_line(origin, tgt, SHOULD_STOP_AT_TARGET, CHEB_TRAVEL_LIMIT,
+                       ALLOW_OUTSIDE_MAP, line_ref);
+        return;
+    }
 
-    for (double i = 0.0; i <= 9999.0; i += STEP_SIZE_DB)
+    for (int i = 0; i < ray->size; ++i)
     {
-        cur_x_db += X_INCR_DB * STEP_SIZE_DB;
-        cur_y_db += Y_INCR_DB * STEP_SIZE_DB;
+        const Line_step& step = ray_steps_[ray->offset + i];
 
-        cur_pos.set(floor(cur_x_db), floor(cur_y_db));
+        const Pos cur_pos(origin.x + step.x, origin.y + step.y);
 
         if (!ALLOW_OUTSIDE_MAP && !utils::is_pos_inside_map(cur_pos)) {return;}
 
-        bool is_pos_ok_to_add = false;
-
-        if (line_ref.empty())
-        {
-            is_pos_ok_to_add = true;
-        }
-        else
-        {
-            is_pos_ok_to_add = line_ref.back() != cur_pos;
-        }
-
-        if (is_pos_ok_to_add)
-        {
-            line_ref.push_back(cur_pos);
-        }
+        line_ref.push_back(cur_pos);
 
         //Check distance limits
-        if (SHOULD_STOP_AT_TARGET && (cur_pos == tgt))
+        if (SHOULD_STOP_AT_TARGET && i == ray->tgt_idx)
         {
             return;
         }
 
-        const int DISTANCE_TRAVELED = utils::king_dist(origin.x, origin.y, cur_pos.x, cur_pos.y);
+        const int DISTANCE_TRAVELED = std::max(std::abs(int(step.x)), std::abs(int(step.y)));
 
         if (DISTANCE_TRAVELED >= CHEB_TRAVEL_LIMIT)
         {
@@ -23,19 +23,12 @@
 
 using namespace std;
 
-#ifdef _WIN32
-#undef main
-#endif
-int main(int argc, char* argv[])
+namespace
 {
-    TRACE_FUNC_BEGIN;
-
-    (void)argc;
-    (void)argv;
-
-    init::init_iO();
-    init::init_game();
 
+//Runs on the game thread (see render::run_game_thread())
+void run_game()
+{
     bool quit_game = false;
 
     while (!quit_game)
@@ -151,6 +144,25 @@ int main(int argc, char* argv[])
 
         init::cleanup_session();
     }
+}
+
+} //namespace
+
+#ifdef _WIN32
+#undef main
+#endif
+int main(int argc, char* argv[])
+{
+    TRACE_FUNC_BEGIN;
+
+    (void)argc;
+    (void)argv;
+
+    init::init_iO();
+    init::init_game();
+
+    //The game runs on its own thread, this thread presents the frames and pumps the events
+    render::run_game_thread(run_game);
 
     init::cleanup_game();
     init::cleanup_iO();
@@ -11,6 +11,9 @@
 #include "item.hpp"
 #include "utils.hpp"
 #include "feature_rigid.hpp"
+#include "feature_mob.hpp"
+#include "map_parsing.hpp"
+#include "room_graph.hpp"
 
 #ifdef DEMO_MODE
 #include "sdl_wrapper.hpp"
@@ -23,6 +26,7 @@ Cell::Cell() :
     is_seen_by_player   (false),
     is_lit              (false),
     is_dark             (false),
+    traits              (0xFF),
     player_los          (),
     item                (nullptr),
     rigid               (nullptr),
@@ -46,6 +50,8 @@ void Cell::reset()
 {
     is_explored = is_seen_by_player = is_lit = is_dark = false;
 
+    traits = 0xFF;
+
     player_los.is_blocked_hard      = true;
     player_los.is_blocked_by_drk    = false;
 
@@ -77,9 +83,66 @@ Room*           room_map[MAP_W][MAP_H];
 
 Clr             wall_clr;
 
+bool            los_blockers        [MAP_W][MAP_H];
+bool            move_cmn_blockers   [MAP_W][MAP_H];
+bool            projectile_blockers [MAP_W][MAP_H];
+bool            sound_blockers      [MAP_W][MAP_H];
+
 namespace
 {
 
+int blockers_generation_ = 0;
+
+void update_traits_and_blockers(const Pos& p)
+{
+    ++blockers_generation_;
+
+    room_graph::mk_dirty(p);
+
+    Cell& cell = cells[p.x][p.y];
+
+    bool& los_blocker           = los_blockers          [p.x][p.y];
+    bool& move_blocker          = move_cmn_blockers     [p.x][p.y];
+    bool& projectile_blocker    = projectile_blockers   [p.x][p.y];
+    bool& sound_blocker         = sound_blockers        [p.x][p.y];
+
+    //No rigid is set while the map is being reset
+    if (!cell.rigid)
+    {
+        cell.traits = 0xFF;
+        los_blocker = move_blocker = projectile_blocker = sound_blocker = true;
+        return;
+    }
+
+    const Rigid&    rigid   = *cell.rigid;
+    const bool      IS_EDGE = !utils::is_pos_inside_map(p, false);
+
+    uint8_t traits = 0;
+
+    if (IS_EDGE || !rigid.is_los_passable())        {traits |= cell_trait::blocks_los;}
+    if (IS_EDGE || !rigid.can_move_cmn())           {traits |= cell_trait::blocks_move_cmn;}
+    if (IS_EDGE || !rigid.is_projectile_passable()) {traits |= cell_trait::blocks_projectiles;}
+    if (!rigid.is_sound_passable())                 {traits |= cell_trait::blocks_sound;}
+
+    cell.traits = traits;
+
+    los_blocker         = cell.has_trait(cell_trait::blocks_los);
+    move_blocker        = cell.has_trait(cell_trait::blocks_move_cmn);
+    projectile_blocker  = cell.has_trait(cell_trait::blocks_projectiles);
+    sound_blocker       = cell.has_trait(cell_trait::blocks_sound);
+
+    const cell_check::Blocks_los          blocks_los;
+    const cell_check::Blocks_move_cmn     blocks_move(false);
+    const cell_check::Blocks_projectiles  blocks_projectiles;
+
+    for (const Mob* const mob : game_time::mobs_at_pos(p))
+    {
+        los_blocker         = los_blocker           || blocks_los.check(*mob);
+        move_blocker        = move_blocker          || blocks_move.check(*mob);
+        projectile_blocker  = projectile_blocker    || blocks_projectiles.check(*mob);
+    }
+}
+
 void reset_cells(const bool MAKE_STONE_WALLS)
 {
     for (int x = 0; x < MAP_W; ++x)
@@ -91,6 +154,8 @@ void reset_cells(const bool MAKE_STONE_WALLS)
 
             room_map[x][y]   = nullptr;
 
+            update_traits_and_blockers(Pos(x, y));
+
             render::render_array[x][y]              = Cell_render_data();
             render::render_array_no_actors[x][y]    = Cell_render_data();
 
@@ -100,6 +165,14 @@ void reset_cells(const bool MAKE_STONE_WALLS)
             }
         }
     }
+
+    fov::mk_los_cache_dirty();
+    fov::mk_lgt_cache_dirty();
+
+    if (player)
+    {
+        player->mk_fov_dirty();
+    }
 }
 
 } //Namespace
@@ -208,6 +281,13 @@ Rigid* put(Rigid* const f)
 
     cell.rigid = f;
 
+    mk_vision_dirty(p);
+
+    if (f->has_new_turn_hook())
+    {
+        game_time::add_active_rigid(p);
+    }
+
 #ifdef DEMO_MODE
 
     if (f->id() == Feature_id::floor)
@@ -231,6 +311,24 @@ Rigid* put(Rigid* const f)
     return f;
 }
 
+void mk_vision_dirty(const Pos& p)
+{
+    update_traits_and_blockers(p);
+
+    fov::mk_los_cache_dirty();
+    fov::mk_lgt_cache_dirty(p);
+
+    if (player)
+    {
+        player->mk_fov_dirty(p);
+    }
+}
+
+int blockers_generation()
+{
+    return blockers_generation_;
+}
+
 void cpy_render_array_to_visual_memory()
 {
     for (int x = 0; x < MAP_W; ++x)
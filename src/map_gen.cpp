@@ -16,12 +16,14 @@
 #include "item_factory.hpp"
 #include "map.hpp"
 #include "map_parsing.hpp"
+#include "map_bits.hpp"
 #include "render.hpp"
 #include "utils.hpp"
 #include "populate_monsters.hpp"
 #include "populate_traps.hpp"
 #include "populate_items.hpp"
 #include "gods.hpp"
+#include "game_time.hpp"
 
 #ifdef DEMO_MODE
 #include "render.hpp"
@@ -236,7 +238,7 @@ void mk_crumble_room(const Rect& room_area_incl_walls, const Pos& event_pos)
 
 //NOTE: The positions and size can be outside map (e.g. negative positions).
 //This function just returns false in that case.
-bool try_mk_aux_room(const Pos& p, const Pos& d, bool blocked[MAP_W][MAP_H], const Pos& door_p)
+bool try_mk_aux_room(const Pos& p, const Pos& d, Map_bits& blocked, const Pos& door_p)
 {
     Rect aux_rect(p, p + d - 1);
     Rect aux_rect_with_border(aux_rect.p0 - 1, aux_rect.p1 + 1);
@@ -245,13 +247,13 @@ bool try_mk_aux_room(const Pos& p, const Pos& d, bool blocked[MAP_W][MAP_H], con
 
     if (utils::is_area_inside_map(aux_rect_with_border))
     {
-        if (!map_parse::is_val_in_area(aux_rect_with_border, blocked))
+        if (!blocked.is_any_in_area(aux_rect_with_border))
         {
             for (int y = aux_rect.p0.y; y <= aux_rect.p1.y; ++y)
             {
                 for (int x = aux_rect.p0.x; x <= aux_rect.p1.x; ++x)
                 {
-                    blocked[x][y] = true;
+                    blocked.set(x, y);
                     assert(!map::room_map[x][y]);
                 }
             }
@@ -289,9 +291,11 @@ void mk_aux_rooms(Region regions[3][3])
         return Pos(rnd::range(3, 7), rnd::range(3, 7));
     };
 
-    bool floor_cells[MAP_W][MAP_H];
-    map_parse::run(cell_check::Blocks_move_cmn(false), floor_cells);
-    utils::reverse_bool_array(floor_cells);
+    bool blocked[MAP_W][MAP_H];
+    map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+
+    Map_bits floor_cells(blocked);
+    floor_cells.flip();
 
     for (int region_y = 0; region_y < 3; region_y++)
     {
@@ -313,7 +317,7 @@ void mk_aux_rooms(Region regions[3][3])
                         const Pos aux_d(rnd_aux_room_dim());
                         const Pos aux_p(con_p.x + 1, rnd::range(con_p.y - aux_d.y + 1, con_p.y));
 
-                        if (floor_cells[con_p.x - 1][con_p.y])
+                        if (floor_cells.at(con_p.x - 1, con_p.y))
                         {
                             if (try_mk_aux_room(aux_p, aux_d, floor_cells, con_p))
                             {
@@ -334,7 +338,7 @@ void mk_aux_rooms(Region regions[3][3])
                         const Pos aux_d(rnd_aux_room_dim());
                         const Pos aux_p(rnd::range(con_p.x - aux_d.x + 1, con_p.x), con_p.y - 1);
 
-                        if (floor_cells[con_p.x][con_p.y + 1])
+                        if (floor_cells.at(con_p.x, con_p.y + 1))
                         {
                             if (try_mk_aux_room(aux_p, aux_d, floor_cells, con_p))
                             {
@@ -355,7 +359,7 @@ void mk_aux_rooms(Region regions[3][3])
                         const Pos aux_d(rnd_aux_room_dim());
                         const Pos aux_p(con_p.x - 1, rnd::range(con_p.y - aux_d.y + 1, con_p.y));
 
-                        if (floor_cells[con_p.x + 1][con_p.y])
+                        if (floor_cells.at(con_p.x + 1, con_p.y))
                         {
                             if (try_mk_aux_room(aux_p, aux_d, floor_cells, con_p))
                             {
@@ -376,7 +380,7 @@ void mk_aux_rooms(Region regions[3][3])
                         const Pos aux_d(rnd_aux_room_dim());
                         const Pos aux_p(rnd::range(con_p.x - aux_d.x + 1, con_p.x), con_p.y + 1);
 
-                        if (floor_cells[con_p.x][con_p.y - 1])
+                        if (floor_cells.at(con_p.x, con_p.y - 1))
                         {
                             if (try_mk_aux_room(aux_p, aux_d, floor_cells, con_p))
                             {
@@ -1089,6 +1093,8 @@ void move_player_to_nearest_allowed_pos()
 
         map::player->pos = allowed_cells_list.front();
 
+        game_time::update_actor_pos(*map::player);
+
     }
 
     TRACE_FUNC_END;
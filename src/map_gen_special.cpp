@@ -279,7 +279,7 @@ void mk_forest_trees()
         bool blocked[MAP_W][MAP_H];
         map_parse::run(cell_check::Blocks_move_cmn(true), blocked);
 
-        Los_result fov[MAP_W][MAP_H];
+        Map_bits fov;
 
         const int SEARCH_RADI               = FOV_STD_RADI_INT - 2;
         const int TRY_PLACE_EVERY_N_STEP    = 2;
@@ -292,7 +292,9 @@ void mk_forest_trees()
         {
             if (path_walk_count == TRY_PLACE_EVERY_N_STEP)
             {
-                fov::run(path[i], blocked, fov);
+                fov.clear();
+
+                fov::run_hard(path[i], blocked, fov);
 
                 for (int dy = -SEARCH_RADI; dy <= SEARCH_RADI; ++dy)
                 {
@@ -314,7 +316,7 @@ void mk_forest_trees()
                             is_left_of_prev = X < grave_cells.back().x;
                         }
 
-                        bool is_pos_ok = !fov[X][Y].is_blocked_hard &&
+                        bool is_pos_ok = fov.at(X, Y)               &&
                                          IS_LEFT_OF_CHURCH          &&
                                          !IS_ON_STONE_PATH          &&
                                          is_left_of_prev;
@@ -457,6 +459,7 @@ bool mk_egypt_lvl()
             if (templ_cell.val == 1)
             {
                 map::player->pos = p;
+                game_time::update_actor_pos(*map::player);
             }
         }
     }
@@ -531,6 +534,7 @@ bool mk_leng_lvl()
             {
             case 1:
                 map::player->pos = p;
+                game_time::update_actor_pos(*map::player);
                 break;
 
             case 3:
@@ -629,6 +633,7 @@ bool mk_rats_in_the_walls_lvl()
             {
             case 1:
                 map::player->pos = p;
+                game_time::update_actor_pos(*map::player);
                 break;
 
             case 3:
@@ -713,6 +718,7 @@ bool mk_boss_lvl()
             {
             case 1:
                 map::player->pos = p;
+                game_time::update_actor_pos(*map::player);
                 break;
 
             default: {}
@@ -774,6 +780,7 @@ bool mk_trapezohedron_lvl()
             {
             case 1:
                 map::player->pos = p;
+                game_time::update_actor_pos(*map::player);
                 break;
 
             default: {}
@@ -2,8 +2,10 @@
 
 #include <cassert>
 #include <algorithm>
+#include <cstdlib>
 
 #include "map.hpp"
+#include "map_bits.hpp"
 #include "actor_player.hpp"
 #include "game_time.hpp"
 #include "utils.hpp"
@@ -16,7 +18,7 @@ namespace cell_check
 
 bool Blocks_los::check(const Cell& c)  const
 {
-    return !utils::is_pos_inside_map(c.pos, false) || !c.rigid->is_los_passable();
+    return c.has_trait(cell_trait::blocks_los);
 }
 
 bool Blocks_los::check(const Mob& f) const
@@ -24,9 +26,14 @@ bool Blocks_los::check(const Mob& f) const
     return !f.is_los_passable();
 }
 
+const bool* Blocks_los::live_layer() const
+{
+    return &map::los_blockers[0][0];
+}
+
 bool Blocks_move_cmn::check(const Cell& c) const
 {
-    return !utils::is_pos_inside_map(c.pos, false) || !c.rigid->can_move_cmn();
+    return c.has_trait(cell_trait::blocks_move_cmn);
 }
 
 bool Blocks_move_cmn::check(const Mob& f) const
@@ -34,6 +41,11 @@ bool Blocks_move_cmn::check(const Mob& f) const
     return !f.can_move_cmn();
 }
 
+const bool* Blocks_move_cmn::live_layer() const
+{
+    return &map::move_cmn_blockers[0][0];
+}
+
 bool Blocks_move_cmn::check(const Actor& a) const
 {
     return a.is_alive();
@@ -56,7 +68,7 @@ bool Blocks_actor::check(const Actor& a) const
 
 bool Blocks_projectiles::check(const Cell& c)  const
 {
-    return !utils::is_pos_inside_map(c.pos, false) || !c.rigid->is_projectile_passable();
+    return c.has_trait(cell_trait::blocks_projectiles);
 }
 
 bool Blocks_projectiles::check(const Mob& f)  const
@@ -64,6 +76,11 @@ bool Blocks_projectiles::check(const Mob& f)  const
     return !f.is_projectile_passable();
 }
 
+const bool* Blocks_projectiles::live_layer() const
+{
+    return &map::projectile_blockers[0][0];
+}
+
 bool Living_actors_adj_to_pos::check(const Actor& a) const
 {
     if (!a.is_alive())
@@ -235,7 +252,27 @@ void run(const  cell_check::Check& method,
 
     const bool ALLOW_WRITE_FALSE = write_rule == Map_parse_mode::overwrite;
 
-    if (method.is_checking_cells())
+    //The live layer holds the combined result of the cells and mobs
+    const bool* const layer = method.live_layer();
+
+    if (layer)
+    {
+        assert(method.is_checking_cells() && method.is_checking_mobs());
+
+        for (int x = area_to_check_cells.p0.x; x <= area_to_check_cells.p1.x; ++x)
+        {
+            for (int y = area_to_check_cells.p0.y; y <= area_to_check_cells.p1.y; ++y)
+            {
+                const bool IS_MATCH = layer[(x * MAP_H) + y];
+
+                if (IS_MATCH || ALLOW_WRITE_FALSE)
+                {
+                    out[x][y] = IS_MATCH;
+                }
+            }
+        }
+    }
+    else if (method.is_checking_cells())
     {
         for (int x = area_to_check_cells.p0.x; x <= area_to_check_cells.p1.x; ++x)
         {
@@ -252,7 +289,7 @@ void run(const  cell_check::Check& method,
         }
     }
 
-    if (method.is_checking_mobs())
+    if (method.is_checking_mobs() && !layer)
     {
         for (Mob* mob : game_time::mobs_)
         {
@@ -307,7 +344,14 @@ bool cell(const cell_check::Check& method, const Pos& p)
 
     bool r = false;
 
-    if (method.is_checking_cells())
+    //The live layer holds the combined result of the cells and mobs
+    const bool* const layer = method.live_layer();
+
+    if (layer)
+    {
+        r = layer[(p.x * MAP_H) + p.y];
+    }
+    else if (method.is_checking_cells())
     {
         const auto& c         = map::cells[p.x][p.y];
         const bool  IS_MATCH  = method.check(c);
@@ -318,40 +362,30 @@ bool cell(const cell_check::Check& method, const Pos& p)
         }
     }
 
-    if (method.is_checking_mobs())
+    if (method.is_checking_mobs() && !layer)
     {
-        for (Mob* mob : game_time::mobs_)
+        for (Mob* mob : game_time::mobs_at_pos(p))
         {
-            const Pos& mob_p = mob->pos();
+            const bool IS_MATCH = method.check(*mob);
 
-            if (mob_p == p)
+            if (IS_MATCH)
             {
-                const bool IS_MATCH = method.check(*mob);
-
-                if (IS_MATCH)
-                {
-                    r = true;
-                    break;
-                }
+                r = true;
+                break;
             }
         }
     }
 
     if (method.is_checking_actors())
     {
-        for (Actor* actor : game_time::actors_)
+        for (Actor* actor : game_time::actors_at_pos(p))
         {
-            const Pos& actor_p = actor->pos;
+            const bool IS_MATCH = method.check(*actor);
 
-            if (actor_p == p)
+            if (IS_MATCH)
             {
-                const bool IS_MATCH = method.check(*actor);
-
-                if (IS_MATCH)
-                {
-                    r = true;
-                    break;
-                }
+                r = true;
+                break;
             }
         }
     }
@@ -427,22 +461,22 @@ bool is_val_in_area(const Rect& area, const bool in[MAP_W][MAP_H],
 
 void append(bool base[MAP_W][MAP_H], const bool append[MAP_W][MAP_H])
 {
-    for (int x = 0; x < MAP_W; ++x)
+    //The arrays are contiguous, so they can be treated as flat (vectorizable) arrays
+    bool*       const base_flat     = &base[0][0];
+    const bool* const append_flat   = &append[0][0];
+
+    for (int i = 0; i < MAP_W * MAP_H; ++i)
     {
-        for (int y = 0; y < MAP_H; ++y)
-        {
-            if (append[x][y]) {base[x][y] = true;}
-        }
+        base_flat[i] = base_flat[i] || append_flat[i];
     }
 }
 
 void expand(const bool in[MAP_W][MAP_H], bool out[MAP_W][MAP_H],
             const Rect& area_allowed_to_modify)
 {
-    int cmp_x0 = 0;
-    int cmp_y0 = 0;
-    int cmp_x1 = 0;
-    int cmp_y1 = 0;
+    Map_bits expanded(in);
+
+    expanded.expand();
 
     const int X0 = std::max(0,          area_allowed_to_modify.p0.x);
     const int Y0 = std::max(0,          area_allowed_to_modify.p0.y);
@@ -453,73 +487,18 @@ void expand(const bool in[MAP_W][MAP_H], bool out[MAP_W][MAP_H],
     {
         for (int y = Y0; y <= Y1; ++y)
         {
-            out[x][y] = false;
-
-            cmp_x0 = x == 0 ? 0 : (x - 1);
-            cmp_y0 = y == 0 ? 0 : (y - 1);
-            cmp_x1 = x == (MAP_W - 1) ? x : (x + 1);
-            cmp_y1 = y == (MAP_H - 1) ? y : (y + 1);
-
-            for (int cmp_y = cmp_y0; cmp_y <= cmp_y1; ++cmp_y)
-            {
-                bool is_found = false;
-
-                for (int cmp_x = cmp_x0; cmp_x <= cmp_x1; ++cmp_x)
-                {
-                    if (in[cmp_x][cmp_y])
-                    {
-                        is_found = out[x][y] = true;
-                        break;
-                    }
-                }
-
-                if (is_found)
-                {
-                    break;
-                }
-            }
+            out[x][y] = expanded.at(x, y);
         }
     }
 }
 
 void expand(const bool in[MAP_W][MAP_H], bool out[MAP_W][MAP_H], const int DIST)
 {
-    for (int x = 0; x < MAP_W; ++x)
-    {
-        for (int y = 0; y < MAP_H; ++y)
-        {
-            out[x][y] = false;
-
-            const int X0 = x - DIST;
-            const int Y0 = y - DIST;
-            const int X1 = x + DIST;
-            const int Y1 = y + DIST;
-
-            const int CMP_X0 = X0 < 0 ? 0 : X0;
-            const int CMP_Y0 = Y0 < 0 ? 0 : Y0;
-            const int CMP_X1 = X1 > MAP_W - 1 ? MAP_W - 1 : X1;
-            const int CMP_Y1 = Y1 > MAP_H - 1 ? MAP_H - 1 : Y1;
+    Map_bits expanded(in);
 
-            for (int cmp_y = CMP_Y0; cmp_y <= CMP_Y1; ++cmp_y)
-            {
-                bool is_found = false;
+    expanded.expand(DIST);
 
-                for (int cmp_x = CMP_X0; cmp_x <= CMP_X1; ++cmp_x)
-                {
-                    if (in[cmp_x][cmp_y])
-                    {
-                        is_found = out[x][y] = true;
-                        break;
-                    }
-                }
-
-                if (is_found)
-                {
-                    break;
-                }
-            }
-        }
-    }
+    expanded.to_array(out);
 }
 
 bool is_map_connected(const bool blocked[MAP_W][MAP_H])
@@ -578,6 +557,26 @@ bool Is_closer_to_pos::operator()(const Pos& p1, const Pos& p2)
 namespace flood_fill
 {
 
+namespace
+{
+
+//Each cell is added to the queue at most once (it gets a value when it's added), except
+//for the neighbours found in the last step when the travel limit is reached. So the queue
+//never needs to wrap around, and can be reused between calls without any allocations.
+const int QUEUE_SIZE = (MAP_W * MAP_H) + 8;
+
+Pos queue_[QUEUE_SIZE];
+
+//NOTE: The order of the directions decides which cells are reached first, and must not
+//be changed
+const Pos dirs_[8] =
+{
+    Pos(0, -1), Pos(-1, 0), Pos(0, 1), Pos(1, 0),
+    Pos(-1, -1), Pos(-1, 1), Pos(1, -1), Pos(1, 1)
+};
+
+} //namespace
+
 void run(const Pos& p0,
          const bool blocked[MAP_W][MAP_H],
          int out[MAP_W][MAP_H],
@@ -587,106 +586,221 @@ void run(const Pos& p0,
 {
     utils::reset_array(out);
 
-    std::vector<Pos> positions;
-    positions.clear();
-
-    unsigned int    nr_elements_to_skip = 0;
-    int             cur_val             = 0;
-    bool            path_exists         = true;
-    bool            is_at_tgt           = false;
-    bool            is_stopping_at_p1   = p1.x != -1;
+    const bool  IS_STOPPING_AT_P1   = p1.x != -1;
+    const int   NR_DIRS             = ALLOW_DIAGONAL ? 8 : 4;
 
-    const Rect      bounds(Pos(1, 1), Pos(MAP_W - 2, MAP_H - 2));
+    int queue_front = 0;
+    int queue_back  = 0;
 
-    Pos             cur_pos(p0);
+    //NOTE: This is the value of the last cell which found a new neighbour, not necessarily
+    //the value of the current cell
+    int cur_val     = 0;
 
-    std::vector<Pos> dirs {Pos(0, -1), Pos(-1, 0), Pos(0, 1), Pos(1, 0)};
+    Pos cur_pos(p0);
 
-    if (ALLOW_DIAGONAL)
-    {
-        dirs.push_back(Pos(-1, -1));
-        dirs.push_back(Pos(-1, 1));
-        dirs.push_back(Pos(1, -1));
-        dirs.push_back(Pos(1, 1));
-    }
-
-    bool done = false;
-
-    while (!done)
+    while (true)
     {
+        bool is_at_tgt = false;
 
-        for (const Pos& d : dirs)
+        for (int i = 0; i < NR_DIRS; ++i)
         {
-            if ((d != 0))
+            const Pos new_pos(cur_pos + dirs_[i]);
+
+            //NOTE: The map edge is never flooded
+            if (
+                new_pos.x > 0 && new_pos.x < MAP_W - 1  &&
+                new_pos.y > 0 && new_pos.y < MAP_H - 1  &&
+                !blocked[new_pos.x][new_pos.y]          &&
+                out[new_pos.x][new_pos.y] == 0          &&
+                new_pos != p0)
             {
-                const Pos new_pos(cur_pos + d);
+                cur_val = out[cur_pos.x][cur_pos.y];
 
-                if (
-                    !blocked[new_pos.x][new_pos.y]          &&
-                    utils::is_pos_inside(new_pos, bounds)   &&
-                    out[new_pos.x][new_pos.y] == 0          &&
-                    new_pos != p0)
-                {
-                    cur_val = out[cur_pos.x][cur_pos.y];
+                if (cur_val < travel_lmt) {out[new_pos.x][new_pos.y] = cur_val + 1;}
 
-                    if (cur_val < travel_lmt) {out[new_pos.x][new_pos.y] = cur_val + 1;}
+                if (IS_STOPPING_AT_P1 && new_pos == p1)
+                {
+                    is_at_tgt = true;
+                    break;
+                }
 
-                    if (is_stopping_at_p1 && cur_pos == p1 - d)
-                    {
-                        is_at_tgt = true;
-                        break;
-                    }
+                assert(queue_back < QUEUE_SIZE);
 
-                    if (!is_stopping_at_p1 || !is_at_tgt)
-                    {
-                        positions.push_back(new_pos);
-                    }
-                }
+                queue_[queue_back] = new_pos;
+                ++queue_back;
             }
         }
 
-        if (is_stopping_at_p1)
+        if (is_at_tgt || queue_front == queue_back || cur_val == travel_lmt)
         {
-            if (positions.size() == nr_elements_to_skip)
-            {
-                path_exists = false;
-            }
+            return;
+        }
 
-            if (is_at_tgt || !path_exists)
-            {
-                done = true;
-            }
+        cur_pos = queue_[queue_front];
+        ++queue_front;
+    }
+}
+
+} //Flood_fill
+
+//------------------------------------------------------------ PATHFINDER
+namespace path_find
+{
+
+namespace
+{
+
+Path_algo algo_ = Path_algo::a_star;
+
+int nr_cells_searched_ = 0;
+
+//A* search state. The travel distances and closed flags are only valid where the stamp
+//equals the stamp of the current search, so nothing needs to be cleared between searches.
+int         dist_           [MAP_W][MAP_H];
+int         dist_stamp_     [MAP_W][MAP_H];
+int         closed_stamp_   [MAP_W][MAP_H];
+int         cur_stamp_      = 0;
+
+//Cells to expand, bucketed by travel distance plus estimated remaining distance ("f").
+//Each step costs one, and the estimate changes by at most one per step, so new cells
+//always go into the bucket being expanded or one of the two after it.
+const int   NR_OPEN_BUCKETS = 3;
+
+std::vector<Pos> open_[NR_OPEN_BUCKETS];
+
+int estimated_dist(const Pos& p, const Pos& tgt, const bool ALLOW_DIAGONAL)
+{
+    const int DX = std::abs(tgt.x - p.x);
+    const int DY = std::abs(tgt.y - p.y);
+
+    return ALLOW_DIAGONAL ? std::max(DX, DY) : (DX + DY);
+}
+
+//Returns the travel distance to p1, or 0 if there is no path. Afterwards, every cell which
+//can be on a shortest path has its correct travel distance, which is all the walk back
+//from the target needs.
+int run_a_star(const Pos& p0, const Pos& p1, const bool blocked[MAP_W][MAP_H],
+               const bool ALLOW_DIAGONAL)
+{
+    //A blocked target is never reached, no need to search all reachable cells to find out
+    if (
+        p1.x <= 0 || p1.x >= MAP_W - 1 ||
+        p1.y <= 0 || p1.y >= MAP_H - 1 ||
+        blocked[p1.x][p1.y])
+    {
+        nr_cells_searched_ = 0;
+        return 0;
+    }
+
+    ++cur_stamp_;
+
+    for (auto& bucket : open_) {bucket.clear();}
+
+    const std::vector<Pos>& dirs = ALLOW_DIAGONAL ?
+                                   dir_utils::dir_list :
+                                   dir_utils::cardinal_list;
+
+    dist_       [p0.x][p0.y] = 0;
+    dist_stamp_ [p0.x][p0.y] = cur_stamp_;
+
+    nr_cells_searched_ = 1;
+
+    int cur_f       = estimated_dist(p0, p1, ALLOW_DIAGONAL);
+    int nr_open     = 1;
+    int tgt_dist    = 0;
+
+    open_[cur_f % NR_OPEN_BUCKETS].push_back(p0);
+
+    while (nr_open > 0)
+    {
+        std::vector<Pos>& bucket = open_[cur_f % NR_OPEN_BUCKETS];
+
+        if (bucket.empty())
+        {
+            ++cur_f;
+            continue;
         }
-        else if (positions.size() == nr_elements_to_skip)
+
+        //When the target is found, the remaining cells with the same f may still be on
+        //other shortest paths (which the walk back may choose), but no cells after them
+        if (tgt_dist != 0 && cur_f > tgt_dist)
+        {
+            break;
+        }
+
+        const Pos p = bucket.back();
+        bucket.pop_back();
+        --nr_open;
+
+        //A cell can be added several times if a shorter way to it is found, the first
+        //time it's expanded is with the shortest distance
+        if (closed_stamp_[p.x][p.y] == cur_stamp_)
         {
-            done = true;
+            continue;
         }
 
-        if (cur_val == travel_lmt)
+        closed_stamp_[p.x][p.y] = cur_stamp_;
+
+        if (p == p1)
         {
-            done = true;
+            tgt_dist = dist_[p.x][p.y];
+            continue;
         }
 
-        if (!is_stopping_at_p1 || !is_at_tgt)
+        const int NEW_DIST = dist_[p.x][p.y] + 1;
+
+        for (const Pos& d : dirs)
         {
-            if (positions.size() == nr_elements_to_skip)
+            const Pos new_pos(p + d);
+
+            //NOTE: The map edge is never searched (same as the flood fill)
+            if (
+                new_pos.x <= 0 || new_pos.x >= MAP_W - 1    ||
+                new_pos.y <= 0 || new_pos.y >= MAP_H - 1    ||
+                blocked[new_pos.x][new_pos.y]               ||
+                closed_stamp_[new_pos.x][new_pos.y] == cur_stamp_)
+            {
+                continue;
+            }
+
+            if (dist_stamp_[new_pos.x][new_pos.y] != cur_stamp_)
             {
-                path_exists = false;
+                dist_stamp_[new_pos.x][new_pos.y] = cur_stamp_;
+                ++nr_cells_searched_;
             }
-            else
+            else if (dist_[new_pos.x][new_pos.y] <= NEW_DIST)
             {
-                cur_pos = positions[nr_elements_to_skip];
-                nr_elements_to_skip++;
+                continue;
             }
+
+            dist_[new_pos.x][new_pos.y] = NEW_DIST;
+
+            const int F = NEW_DIST + estimated_dist(new_pos, p1, ALLOW_DIAGONAL);
+
+            open_[F % NR_OPEN_BUCKETS].push_back(new_pos);
+            ++nr_open;
         }
     }
+
+    return tgt_dist;
 }
 
-} //Flood_fill
+} //namespace
 
-//------------------------------------------------------------ PATHFINDER
-namespace path_find
+void set_algo(const Path_algo algo)
+{
+    algo_ = algo;
+}
+
+Path_algo algo()
+{
+    return algo_;
+}
+
+int nr_cells_searched()
 {
+    return nr_cells_searched_;
+}
 
 void run(const Pos& p0, const Pos& p1, bool blocked[MAP_W][MAP_H], std::vector<Pos>& out,
          const bool ALLOW_DIAGONAL, const bool RANDOMIZE_STEP_CHOICES)
@@ -696,29 +810,63 @@ void run(const Pos& p0, const Pos& p1, bool blocked[MAP_W][MAP_H], std::vector<P
     if (p0 == p1)
     {
         //Origin and target is same cell
+        nr_cells_searched_ = 0;
         return;
     }
 
+    //Travel distances from the origin - zero means not reached (or the origin itself)
     int flood[MAP_W][MAP_H];
-    flood_fill::run(p0, blocked, flood, 10000, p1, ALLOW_DIAGONAL);
 
-    if (flood[p1.x][p1.y] == 0)
+    int tgt_dist = 0;
+
+    if (algo_ == Path_algo::flood_fill)
+    {
+        flood_fill::run(p0, blocked, flood, 10000, p1, ALLOW_DIAGONAL);
+
+        tgt_dist = flood[p1.x][p1.y];
+
+        nr_cells_searched_ = 1;
+
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                if (flood[x][y] != 0) {++nr_cells_searched_;}
+            }
+        }
+    }
+    else //A*
+    {
+        tgt_dist = run_a_star(p0, p1, blocked, ALLOW_DIAGONAL);
+    }
+
+    if (tgt_dist == 0)
     {
         //No path exists
         return;
     }
 
+    auto val_at = [&](const Pos& p)
+    {
+        if (algo_ == Path_algo::flood_fill)
+        {
+            return flood[p.x][p.y];
+        }
+
+        return dist_stamp_[p.x][p.y] == cur_stamp_ ? dist_[p.x][p.y] : 0;
+    };
+
     const std::vector<Pos>& dirs =  ALLOW_DIAGONAL ?
                                     dir_utils::dir_list :
                                     dir_utils::cardinal_list;
 
     const size_t NR_DIRS = dirs.size();
 
-    std::vector<bool> valid_offsets(NR_DIRS, false); //Corresponds to the elements in "dirs"
+    bool valid_offsets[8]; //Corresponds to the elements in "dirs"
 
-    //The path length will be equal to the flood value at the target cell, so we can
+    //The path length will be equal to the travel distance to the target cell, so we can
     //reserve that many elements.
-    out.reserve(flood[p1.x][p1.y]);
+    out.reserve(tgt_dist);
 
     Pos cur_pos(p1);
     out.push_back(cur_pos);
@@ -727,6 +875,8 @@ void run(const Pos& p0, const Pos& p1, bool blocked[MAP_W][MAP_H], std::vector<P
     {
         Pos adj_pos;
 
+        const int VAL_AT_CUR = val_at(cur_pos);
+
         //Find valid offsets, and check if origin is reached
         for (size_t i = 0; i < NR_DIRS; ++i)
         {
@@ -742,9 +892,7 @@ void run(const Pos& p0, const Pos& p1, bool blocked[MAP_W][MAP_H], std::vector<P
 
             const bool IS_INSIDE_MAP = utils::is_pos_inside_map(adj_pos);
 
-            const int VAL_AT_ADJ = IS_INSIDE_MAP ? flood[adj_pos.x][adj_pos.y] : 0;
-
-            const int VAL_AT_CUR = flood[cur_pos.x][cur_pos.y];
+            const int VAL_AT_ADJ = IS_INSIDE_MAP ? val_at(adj_pos) : 0;
 
             valid_offsets[i] = VAL_AT_ADJ < VAL_AT_CUR && VAL_AT_ADJ != 0;
         }
@@ -753,19 +901,21 @@ void run(const Pos& p0, const Pos& p1, bool blocked[MAP_W][MAP_H], std::vector<P
         //Either pick one of the valid offsets at random, or iterate over an offset list
         if (RANDOMIZE_STEP_CHOICES)
         {
-            std::vector<Pos> adj_pos_bucket;
+            Pos adj_pos_bucket[8];
+            int nr_adj_pos = 0;
 
             for (size_t i = 0; i < NR_DIRS; ++i)
             {
                 if (valid_offsets[i])
                 {
-                    adj_pos_bucket.push_back(cur_pos + dirs[i]);
+                    adj_pos_bucket[nr_adj_pos] = cur_pos + dirs[i];
+                    ++nr_adj_pos;
                 }
             }
 
-            assert(!adj_pos_bucket.empty());
+            assert(nr_adj_pos > 0);
 
-            adj_pos = adj_pos_bucket[rnd::range(0, adj_pos_bucket.size() - 1)];
+            adj_pos = adj_pos_bucket[rnd::range(0, nr_adj_pos - 1)];
         }
         else //Do not randomize step choices - iterate over offset list
         {
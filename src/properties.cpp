@@ -21,6 +21,7 @@
 #include "feature_mob.hpp"
 #include "item.hpp"
 #include "text_format.hpp"
+#include "game_time.hpp"
 
 namespace prop_data
 {
@@ -1300,6 +1301,11 @@ void Prop_handler::incr_active_props_info(const Prop_id id)
 #endif // NDEBUG
 
     ++v;
+
+    if (id == Prop_id::slowed || id == Prop_id::hasted || id == Prop_id::frenzied)
+    {
+        game_time::update_actor_speed(*owning_actor_);
+    }
 }
 
 void Prop_handler::decr_active_props_info(const Prop_id id)
@@ -1315,6 +1321,11 @@ void Prop_handler::decr_active_props_info(const Prop_id id)
 #endif // NDEBUG
 
     --v;
+
+    if (id == Prop_id::slowed || id == Prop_id::hasted || id == Prop_id::frenzied)
+    {
+        game_time::update_actor_speed(*owning_actor_);
+    }
 }
 
 void Prop_handler::on_prop_end(Prop* const prop)
@@ -1,6 +1,7 @@
 #include "render.hpp"
 
 #include <vector>
+#include <algorithm>
 #include <iostream>
 
 #include "init.hpp"
@@ -30,13 +31,28 @@ Cell_render_data render_array_no_actors[MAP_W][MAP_H];
 namespace
 {
 
+//-----------------------------------------------------------------------------
+// Presenting - only used by the main thread (except while the game thread waits
+// for the renderer to be set up)
+//-----------------------------------------------------------------------------
 SDL_Window*     sdl_window_         = nullptr;
 SDL_Renderer*   sdl_renderer_       = nullptr;
 
+//In atlas mode, everything is drawn by the renderer onto the screen texture (which is a
+//render target), and glyphs and tiles are copied from white atlas textures with the color
+//set as color modulation. Otherwise (if the renderer does not support render targets),
+//everything is drawn on the screen surface, which is uploaded to the screen texture.
+bool            is_atlas_mode_      = false;
+
 SDL_Surface*    scr_srf_            = nullptr;
 SDL_Texture*    scr_texture_        = nullptr;
 
 SDL_Surface*    main_menu_logo_srf_ = nullptr;
+SDL_Texture*    main_menu_logo_texture_ = nullptr;
+
+//The cell size the renderer was set up for (the game may change the config meanwhile)
+int             scr_cell_px_w_      = 0;
+int             scr_cell_px_h_      = 0;
 
 const size_t PIXEL_DATA_W = 400;
 const size_t PIXEL_DATA_H = 400;
@@ -45,16 +61,169 @@ bool tile_px_data_[PIXEL_DATA_W][PIXEL_DATA_H];
 bool font_px_data_[PIXEL_DATA_W][PIXEL_DATA_H];
 bool contour_px_data_[PIXEL_DATA_W][PIXEL_DATA_H];
 
+SDL_Texture*    tile_texture_       = nullptr;
+SDL_Texture*    font_texture_       = nullptr;
+SDL_Texture*    contour_texture_    = nullptr;
+
+//The pixel data of a sheet for drawing on the screen surface. There is one bit mask for each
+//pixel row of each cell in the sheet (bit 0 is the leftmost pixel), stored row by row.
+struct Sheet_bits
+{
+    Sheet_bits() :
+        nr_cols (0),
+        rows    () {}
+
+    int                 nr_cols;
+    std::vector<Uint64> rows;
+};
+
+Sheet_bits      tile_bits_;
+Sheet_bits      font_bits_;
+Sheet_bits      contour_bits_;
+
+//Pixel values for the screen surface by color, so SDL_MapRGB() is not called for each draw.
+//Each color can only be stored in one slot (picked from the color value), which it shares
+//with other colors.
+struct Mapped_clr
+{
+    Uint32 rgb;     //The color, with bit 24 set if the slot is used
+    Uint32 px;
+};
+
+const size_t NR_MAPPED_CLR_SLOTS = 256;
+
+Mapped_clr mapped_clrs_[NR_MAPPED_CLR_SLOTS];
+
+//Screen cells drawn on since the last present (only these are uploaded)
+bool            is_scr_cell_dirty_[SCREEN_W][SCREEN_H];
+
+//When the last frame was presented
+Uint32          last_present_time_  = 0;
+
+//When the bot is playing, at most one frame is presented per this many milliseconds
+const Uint32 BOT_MIN_PRESENT_INTERVAL = 16;
+
+//-----------------------------------------------------------------------------
+// Frames - the game thread records everything it draws as commands, and
+// update_screen() publishes the commands drawn since the last update as a
+// frame. The main thread runs the commands of the published frames in order
+// (the screen keeps what is drawn, so each frame only has what changed), and
+// presents the result. Frames which are not held are only drawn, and presented
+// together with the frames after them.
+//-----------------------------------------------------------------------------
+enum class Draw_cmd_type
+{
+    fill,
+    font,
+    tile,
+    contour,
+    main_menu_logo
+};
+
+struct Draw_cmd
+{
+    Draw_cmd_type   type;
+    Pos             sheet_pos;  //Cell in the sheet (only for font, tile and contour)
+    SDL_Rect        dst;
+    Clr             clr;
+};
+
+struct Frame
+{
+    Frame() :
+        cmds    (),
+        hold    (0) {}
+
+    std::vector<Draw_cmd>   cmds;
+    Uint32                  hold;   //Shown for at least this many milliseconds
+};
+
+//Drawn by the game thread since the last screen update
+std::vector<Draw_cmd>   cmds_;
+
+//Shared between the threads, only used with the frame mutex locked
+SDL_mutex*              frame_mutex_        = nullptr;
+std::vector<Frame>      frames_;                    //Published, not yet drawn
+Uint32                  frame_hold_end_     = 0;    //The presented frame is held until this
+Uint32                  last_frame_time_    = 0;    //When frames were last taken for drawing
+bool                    is_game_running_    = false;
+
+//The size of the main menu logo, set up with the renderer
+int                     main_menu_logo_px_w_    = 0;
+int                     main_menu_logo_px_h_    = 0;
+
+//-----------------------------------------------------------------------------
+// Drawing - only used by the game thread
+//-----------------------------------------------------------------------------
+//Color channel tables for dimming seen cells by distance from the player (beyond the max
+//distance, the last table is used), seen dark cells, and remembered cells
+const int LIGHT_FADE_MAX_DIST = 8;
+
+Uint8 light_fade_lut_[LIGHT_FADE_MAX_DIST + 1][256];
+Uint8 dark_lut_[256];
+Uint8 memory_lut_[256];
+
+//What was last drawn in each map cell by draw_map(). A map cell is only redrawn if what
+//should be drawn has changed, or if anything else has been drawn on it since.
+Cell_render_data    drawn_map_[MAP_W][MAP_H];
+bool                is_map_cell_drawn_[MAP_W][MAP_H];
+bool                is_drawing_map_         = false;
+int                 nr_map_cells_redrawn_   = 0;
+
 bool is_inited()
 {
     return sdl_window_;
 }
 
-void div_clr(Clr & clr, const double DIV)
+void mk_div_lut(Uint8 lut[256], const double DIV)
+{
+    for (int v = 0; v < 256; ++v)
+    {
+        lut[v] = Uint8(double(v) / DIV);
+    }
+}
+
+void mk_clr_luts()
+{
+    for (int dist = 0; dist <= LIGHT_FADE_MAX_DIST; ++dist)
+    {
+        const double DIV = dist > 1 ? std::min(2.0, 1.0 + (double(dist - 1) * 0.33)) : 1.0;
+
+        mk_div_lut(light_fade_lut_[dist], DIV);
+    }
+
+    mk_div_lut(dark_lut_,   1.75);
+    mk_div_lut(memory_lut_, 5.0);
+}
+
+void apply_lut(Clr& clr, const Uint8 lut[256])
+{
+    clr.r = lut[clr.r];
+    clr.g = lut[clr.g];
+    clr.b = lut[clr.b];
+}
+
+void clear_mapped_clrs()
 {
-    clr.r = double(clr.r) / DIV;
-    clr.g = double(clr.g) / DIV;
-    clr.b = double(clr.b) / DIV;
+    for (Mapped_clr& mapped_clr : mapped_clrs_)
+    {
+        mapped_clr.rgb = 0;
+    }
+}
+
+Uint32 mapped_clr(const Clr& clr)
+{
+    const Uint32 RGB = (1 << 24) | (clr.r << 16) | (clr.g << 8) | clr.b;
+
+    Mapped_clr& slot = mapped_clrs_[(clr.r ^ (clr.g * 7) ^ (clr.b * 31)) % NR_MAPPED_CLR_SLOTS];
+
+    if (slot.rgb != RGB)
+    {
+        slot.rgb    = RGB;
+        slot.px     = SDL_MapRGB(scr_srf_->format, clr.r, clr.g, clr.b);
+    }
+
+    return slot.px;
 }
 
 Uint32 px(SDL_Surface& srf, const int PIXEL_X, const int PIXEL_Y)
@@ -93,49 +262,106 @@ Uint32 px(SDL_Surface& srf, const int PIXEL_X, const int PIXEL_Y)
     return -1;
 }
 
-void put_px(const SDL_Surface& srf, const int PIXEL_X, const int PIXEL_Y, Uint32 px)
+//Must be called for everything drawn on the screen
+void on_px_area_drawn(const Pos& px_pos, const Pos& px_dims)
 {
-    const int BPP = srf.format->BytesPerPixel;
+    if (is_drawing_map_)
+    {
+        return;
+    }
 
-    //p is the address to the pixel we want to set
-    Uint8* const p = (Uint8*)srf.pixels + PIXEL_Y * srf.pitch + PIXEL_X * BPP;
+    const int CELL_PX_W = config::cell_px_w();
+    const int CELL_PX_H = config::cell_px_h();
 
-    switch (BPP)
+    const int X0 = std::max(0,              px_pos.x / CELL_PX_W);
+    const int Y0 = std::max(MAP_OFFSET_H,   px_pos.y / CELL_PX_H);
+    const int X1 = std::min(MAP_W - 1,      (px_pos.x + px_dims.x - 1) / CELL_PX_W);
+    const int Y1 = std::min(MAP_OFFSET_H + MAP_H - 1,
+                            (px_pos.y + px_dims.y - 1) / CELL_PX_H);
+
+    //Something else has been drawn over these map cells
+    for (int x = X0; x <= X1; ++x)
     {
-    case 1:
-        *p = px;
-        break;
+        for (int y = Y0; y <= Y1; ++y)
+        {
+            is_map_cell_drawn_[x][y - MAP_OFFSET_H] = false;
+        }
+    }
+}
 
-    case 2:
-        *(Uint16*)p = px;
-        break;
+//Must be called for everything drawn on the screen surface or texture
+void mk_scr_px_area_dirty(const Pos& px_pos, const Pos& px_dims)
+{
+    const int X0 = std::max(0,            px_pos.x / scr_cell_px_w_);
+    const int Y0 = std::max(0,            px_pos.y / scr_cell_px_h_);
+    const int X1 = std::min(SCREEN_W - 1, (px_pos.x + px_dims.x - 1) / scr_cell_px_w_);
+    const int Y1 = std::min(SCREEN_H - 1, (px_pos.y + px_dims.y - 1) / scr_cell_px_h_);
 
-    case 3:
-        if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
+    for (int x = X0; x <= X1; ++x)
+    {
+        for (int y = Y0; y <= Y1; ++y)
         {
-            p[0] = (px >> 16) & 0xff;
-            p[1] = (px >> 8)  & 0xff;
-            p[2] = px & 0xff;
+            is_scr_cell_dirty_[x][y] = true;
         }
-        else //Little endian
+    }
+}
+
+bool is_same_drawn(const Cell_render_data& d0, const Cell_render_data& d1)
+{
+    return d0.is_aware_of_mon_here == d1.is_aware_of_mon_here    &&
+           d0.tile                 == d1.tile                    &&
+           d0.glyph                == d1.glyph                   &&
+           d0.lifebar_length       == d1.lifebar_length          &&
+           utils::is_clr_eq(d0.clr,    d1.clr)                  &&
+           utils::is_clr_eq(d0.clr_bg, d1.clr_bg);
+}
+
+//Uploads the dirty parts of the screen surface to the screen texture, one rectangle for
+//each horizontal run of dirty cells
+void upload_dirty_scr_cells()
+{
+    const int CELL_PX_W = scr_cell_px_w_;
+    const int CELL_PX_H = scr_cell_px_h_;
+    const int BPP       = scr_srf_->format->BytesPerPixel;
+
+    for (int y = 0; y < SCREEN_H; ++y)
+    {
+        int x = 0;
+
+        while (x < SCREEN_W)
         {
-            p[0] = px & 0xff;
-            p[1] = (px >> 8)  & 0xff;
-            p[2] = (px >> 16) & 0xff;
-        }
-        break;
+            if (!is_scr_cell_dirty_[x][y])
+            {
+                ++x;
+                continue;
+            }
 
-    case 4:
-        *(Uint32*)p = px;
-        break;
+            const int X0 = x;
 
-    default:
-        break;
+            while (x < SCREEN_W && is_scr_cell_dirty_[x][y])
+            {
+                is_scr_cell_dirty_[x][y] = false;
+                ++x;
+            }
+
+            const SDL_Rect sdl_rect
+            {
+                X0 * CELL_PX_W, y * CELL_PX_H, (x - X0) * CELL_PX_W, CELL_PX_H
+            };
+
+            const Uint8* const px_data = (const Uint8*)scr_srf_->pixels +
+                                         (sdl_rect.y * scr_srf_->pitch) +
+                                         (sdl_rect.x * BPP);
+
+            SDL_UpdateTexture(scr_texture_, &sdl_rect, px_data, scr_srf_->pitch);
+        }
     }
 }
 
 void blit_surface(SDL_Surface& srf, const Pos& px_pos)
 {
+    mk_scr_px_area_dirty(px_pos, Pos(srf.w, srf.h));
+
     SDL_Rect dst_rect
     {
         px_pos.x, px_pos.y, srf.w, srf.h
@@ -144,6 +370,117 @@ void blit_surface(SDL_Surface& srf, const Pos& px_pos)
     SDL_BlitSurface(&srf, nullptr, scr_srf_, &dst_rect);
 }
 
+void fill_rect(const SDL_Rect& sdl_rect, const Clr& clr)
+{
+    if (!is_inited())
+    {
+        return;
+    }
+
+    on_px_area_drawn(Pos(sdl_rect.x, sdl_rect.y), Pos(sdl_rect.w, sdl_rect.h));
+
+    cmds_.push_back({Draw_cmd_type::fill, Pos(), sdl_rect, clr});
+}
+
+//Makes a texture which is white where the pixel data is set, and transparent elsewhere
+SDL_Texture* mk_atlas_texture(const bool px_data[PIXEL_DATA_W][PIXEL_DATA_H])
+{
+    SDL_Texture* const texture = SDL_CreateTexture(sdl_renderer_,
+                                                   SDL_PIXELFORMAT_ARGB8888,
+                                                   SDL_TEXTUREACCESS_STATIC,
+                                                   PIXEL_DATA_W, PIXEL_DATA_H);
+
+    if (!texture)
+    {
+        TRACE << "Failed to create atlas texture" << std::endl;
+        assert(false);
+        return nullptr;
+    }
+
+    std::vector<Uint32> pixels(PIXEL_DATA_W * PIXEL_DATA_H, 0);
+
+    for (size_t px_x = 0; px_x < PIXEL_DATA_W; ++px_x)
+    {
+        for (size_t px_y = 0; px_y < PIXEL_DATA_H; ++px_y)
+        {
+            if (px_data[px_x][px_y])
+            {
+                pixels[(px_y * PIXEL_DATA_W) + px_x] = 0xFFFFFFFF;
+            }
+        }
+    }
+
+    SDL_UpdateTexture(texture, nullptr, pixels.data(), PIXEL_DATA_W * sizeof(Uint32));
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    return texture;
+}
+
+void mk_sheet_bits(const bool px_data[PIXEL_DATA_W][PIXEL_DATA_H], Sheet_bits& out)
+{
+    const int CELL_W = config::cell_px_w();
+
+    assert(CELL_W <= 64);
+
+    out.nr_cols = PIXEL_DATA_W / CELL_W;
+    out.rows.assign(out.nr_cols * PIXEL_DATA_H, 0);
+
+    for (size_t px_y = 0; px_y < PIXEL_DATA_H; ++px_y)
+    {
+        for (int col = 0; col < out.nr_cols; ++col)
+        {
+            Uint64& row = out.rows[(px_y * out.nr_cols) + col];
+
+            for (int i = 0; i < CELL_W; ++i)
+            {
+                if (px_data[(col * CELL_W) + i][px_y])
+                {
+                    row |= Uint64(1) << i;
+                }
+            }
+        }
+    }
+}
+
+void mk_all_sheet_bits()
+{
+    TRACE_FUNC_BEGIN;
+
+    mk_sheet_bits(font_px_data_,    font_bits_);
+    mk_sheet_bits(contour_px_data_, contour_bits_);
+
+    if (config::is_tiles_mode())
+    {
+        mk_sheet_bits(tile_px_data_, tile_bits_);
+    }
+
+    TRACE_FUNC_END;
+}
+
+void mk_atlas_textures()
+{
+    TRACE_FUNC_BEGIN;
+
+    font_texture_       = mk_atlas_texture(font_px_data_);
+    contour_texture_    = mk_atlas_texture(contour_px_data_);
+
+    if (config::is_tiles_mode())
+    {
+        tile_texture_ = mk_atlas_texture(tile_px_data_);
+    }
+
+    TRACE_FUNC_END;
+}
+
+void destroy_texture(SDL_Texture*& texture)
+{
+    if (texture)
+    {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+}
+
 void load_main_menu_logo()
 {
     TRACE_FUNC_BEGIN;
@@ -152,7 +489,18 @@ void load_main_menu_logo()
 
     assert(main_menu_logo_srf_tmp && "Failed to load main menu logo");
 
-    main_menu_logo_srf_ = SDL_ConvertSurface(main_menu_logo_srf_tmp, scr_srf_->format, 0);
+    main_menu_logo_px_w_ = main_menu_logo_srf_tmp->w;
+    main_menu_logo_px_h_ = main_menu_logo_srf_tmp->h;
+
+    if (is_atlas_mode_)
+    {
+        main_menu_logo_texture_ = SDL_CreateTextureFromSurface(sdl_renderer_,
+                                                               main_menu_logo_srf_tmp);
+    }
+    else
+    {
+        main_menu_logo_srf_ = SDL_ConvertSurface(main_menu_logo_srf_tmp, scr_srf_->format, 0);
+    }
 
     SDL_FreeSurface(main_menu_logo_srf_tmp);
 
@@ -251,49 +599,107 @@ void load_contour(const bool base[PIXEL_DATA_W][PIXEL_DATA_H])
     }
 }
 
-void put_pixels_on_scr(const bool px_data[PIXEL_DATA_W][PIXEL_DATA_H],
-                       const Pos& sheet_pos, const Pos& scr_px_pos, const Clr& clr)
+void run_put_pixels(const Sheet_bits& bits, SDL_Texture* const texture,
+                    const Pos& sheet_pos, const Pos& scr_px_pos, const Clr& clr)
 {
-    if (is_inited())
+    const int CELL_W = scr_cell_px_w_;
+    const int CELL_H = scr_cell_px_h_;
+
+    mk_scr_px_area_dirty(scr_px_pos, Pos(CELL_W, CELL_H));
+
+    if (is_atlas_mode_)
     {
-        const int PX_CLR = SDL_MapRGB(scr_srf_->format, clr.r, clr.g, clr.b);
+        const SDL_Rect src_rect
+        {
+            sheet_pos.x * CELL_W, sheet_pos.y * CELL_H, CELL_W, CELL_H
+        };
 
-        const int CELL_W      = config::cell_px_w();
-        const int CELL_H      = config::cell_px_h();
-        const int SHEET_PX_X0 = sheet_pos.x * CELL_W;
-        const int SHEET_PX_Y0 = sheet_pos.y * CELL_H;
-        const int SHEET_PX_X1 = SHEET_PX_X0 + CELL_W - 1;
-        const int SHEET_PX_Y1 = SHEET_PX_Y0 + CELL_H - 1;
-        const int SCR_PX_X0   = scr_px_pos.x;
-        const int SCR_PX_Y0   = scr_px_pos.y;
+        const SDL_Rect dst_rect
+        {
+            scr_px_pos.x, scr_px_pos.y, CELL_W, CELL_H
+        };
 
-        int scr_px_x = SCR_PX_X0;
+        SDL_SetTextureColorMod(texture, clr.r, clr.g, clr.b);
+        SDL_RenderCopy(sdl_renderer_, texture, &src_rect, &dst_rect);
+        return;
+    }
 
-        for (int sheet_px_x = SHEET_PX_X0; sheet_px_x <= SHEET_PX_X1; sheet_px_x++)
+    //The screen surface is always 32 bits per pixel
+    assert(scr_srf_->format->BytesPerPixel == 4);
+
+    const Uint32 PX_CLR = mapped_clr(clr);
+
+    //Only draw the columns and rows of the cell which are on the screen
+    const int COL0 = std::max(0,        -scr_px_pos.x);
+    const int COL1 = std::min(CELL_W,   scr_srf_->w - scr_px_pos.x);
+    const int ROW0 = std::max(0,        -scr_px_pos.y);
+    const int ROW1 = std::min(CELL_H,   scr_srf_->h - scr_px_pos.y);
+
+    if (COL0 >= COL1 || ROW0 >= ROW1)
+    {
+        return;
+    }
+
+    const Uint64 COL_MASK = (COL1 == 64 ? ~Uint64(0) : ((Uint64(1) << COL1) - 1)) &
+                            ~((Uint64(1) << COL0) - 1);
+
+    const Uint64* sheet_row = &bits.rows[(((sheet_pos.y * CELL_H) + ROW0) * bits.nr_cols) +
+                                         sheet_pos.x];
+
+    Uint8* scr_row = (Uint8*)scr_srf_->pixels + ((scr_px_pos.y + ROW0) * scr_srf_->pitch);
+
+    for (int row = ROW0; row < ROW1; ++row)
+    {
+        Uint64          mask    = *sheet_row & COL_MASK;
+        Uint32* const   scr_px  = (Uint32*)scr_row + scr_px_pos.x;
+
+        //Fill each horizontal run of set pixels at once
+        while (mask)
         {
-            int scr_px_y = SCR_PX_Y0;
+            const int       START   = __builtin_ctzll(mask);
+            const Uint64    SHIFTED = mask >> START;
+            const int       LEN     = ~SHIFTED ? __builtin_ctzll(~SHIFTED) : (64 - START);
 
-            for (int sheet_px_y = SHEET_PX_Y0; sheet_px_y <= SHEET_PX_Y1; sheet_px_y++)
-            {
-                if (px_data[sheet_px_x][sheet_px_y])
-                {
-                    put_px(*scr_srf_, scr_px_x, scr_px_y, PX_CLR);
-                }
-                ++scr_px_y;
-            }
-            ++scr_px_x;
+            std::fill_n(scr_px + START, LEN, PX_CLR);
+
+            mask = (START + LEN) >= 64 ? 0 : (mask & (~Uint64(0) << (START + LEN)));
         }
+
+        sheet_row   += bits.nr_cols;
+        scr_row     += scr_srf_->pitch;
     }
 }
 
+void put_pixels_on_scr(const Draw_cmd_type type, const Pos& sheet_pos, const Pos& scr_px_pos,
+                       const Clr& clr)
+{
+    if (!is_inited())
+    {
+        return;
+    }
+
+    //Glyphs which are not in the font have no sheet position
+    if (sheet_pos.x < 0 || sheet_pos.y < 0)
+    {
+        return;
+    }
+
+    const int CELL_W = config::cell_px_w();
+    const int CELL_H = config::cell_px_h();
+
+    on_px_area_drawn(scr_px_pos, Pos(CELL_W, CELL_H));
+
+    cmds_.push_back({type, sheet_pos, {scr_px_pos.x, scr_px_pos.y, CELL_W, CELL_H}, clr});
+}
+
 void put_pixels_on_scr_for_tile(const Tile_id tile, const Pos& scr_px_pos, const Clr& clr)
 {
-    put_pixels_on_scr(tile_px_data_, art::tile_pos(tile), scr_px_pos, clr);
+    put_pixels_on_scr(Draw_cmd_type::tile, art::tile_pos(tile), scr_px_pos, clr);
 }
 
 void put_pixels_on_scr_for_glyph(const char GLYPH, const Pos& scr_px_pos, const Clr& clr)
 {
-    put_pixels_on_scr(font_px_data_, art::glyph_pos(GLYPH), scr_px_pos, clr);
+    put_pixels_on_scr(Draw_cmd_type::font, art::glyph_pos(GLYPH), scr_px_pos, clr);
 }
 
 Pos px_pos_for_cell_in_panel(const Panel panel, const Pos& pos)
@@ -392,19 +798,65 @@ void draw_glyph_at_px(const char GLYPH, const Pos& px_pos, const Clr& clr,
         //Only draw contour if neither the foreground or background is black
         if (!utils::is_clr_eq(clr, clr_black) && !utils::is_clr_eq(bg_clr, clr_black))
         {
-            put_pixels_on_scr(contour_px_data_, art::glyph_pos(GLYPH), px_pos, clr_black);
+            put_pixels_on_scr(Draw_cmd_type::contour, art::glyph_pos(GLYPH), px_pos,
+                              clr_black);
         }
     }
 
     put_pixels_on_scr_for_glyph(GLYPH, px_pos, clr);
 }
 
-} //Namespace
+//-----------------------------------------------------------------------------
+// Main thread
+//-----------------------------------------------------------------------------
+void cleanup_renderer()
+{
+    TRACE_FUNC_BEGIN;
 
-void init()
+    //Textures must be destroyed before their renderer
+    destroy_texture(tile_texture_);
+    destroy_texture(font_texture_);
+    destroy_texture(contour_texture_);
+    destroy_texture(main_menu_logo_texture_);
+    destroy_texture(scr_texture_);
+
+    is_atlas_mode_ = false;
+
+    if (sdl_renderer_)
+    {
+        SDL_DestroyRenderer(sdl_renderer_);
+        sdl_renderer_ = nullptr;
+    }
+
+    if (sdl_window_)
+    {
+        SDL_DestroyWindow(sdl_window_);
+        sdl_window_ = nullptr;
+    }
+
+    if (scr_srf_)
+    {
+        SDL_FreeSurface(scr_srf_);
+        scr_srf_ = nullptr;
+    }
+
+    if (main_menu_logo_srf_)
+    {
+        SDL_FreeSurface(main_menu_logo_srf_);
+        main_menu_logo_srf_ = nullptr;
+    }
+
+    main_menu_logo_px_w_ = 0;
+    main_menu_logo_px_h_ = 0;
+
+    TRACE_FUNC_END;
+}
+
+void init_renderer()
 {
     TRACE_FUNC_BEGIN;
-    cleanup();
+
+    cleanup_renderer();
 
     TRACE << "Setting up rendering window" << std::endl;
 
@@ -413,6 +865,9 @@ void init()
     const int SCR_PX_W = config::scr_px_w();
     const int SCR_PX_H = config::scr_px_h();
 
+    scr_cell_px_w_ = config::cell_px_w();
+    scr_cell_px_h_ = config::cell_px_h();
+
     if (config::is_fullscreen())
     {
         sdl_window_ = SDL_CreateWindow(title.c_str(),
@@ -437,7 +892,9 @@ void init()
         assert(false);
     }
 
-    sdl_renderer_ = SDL_CreateRenderer(sdl_window_, -1, SDL_RENDERER_ACCELERATED);
+    //Presenting never blocks the game, so it can wait for vsync
+    sdl_renderer_ = SDL_CreateRenderer(sdl_window_, -1,
+                                       SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 
     if (!sdl_renderer_)
     {
@@ -445,29 +902,50 @@ void init()
         assert(false);
     }
 
-    scr_srf_ = SDL_CreateRGBSurface(0,
-                                    SCR_PX_W, SCR_PX_H,
-                                    SCREEN_BPP,
-                                    0x00FF0000,
-                                    0x0000FF00,
-                                    0x000000FF,
-                                    0xFF000000);
-
-    if (!scr_srf_)
+    if (SDL_RenderTargetSupported(sdl_renderer_))
     {
-        TRACE << "Failed to create screen surface" << std::endl;
-        assert(false);
+        scr_texture_ = SDL_CreateTexture(sdl_renderer_,
+                                         SDL_PIXELFORMAT_ARGB8888,
+                                         SDL_TEXTUREACCESS_TARGET,
+                                         SCR_PX_W, SCR_PX_H);
+
+        is_atlas_mode_ = scr_texture_ && SDL_SetRenderTarget(sdl_renderer_, scr_texture_) == 0;
+
+        if (!is_atlas_mode_ && scr_texture_)
+        {
+            destroy_texture(scr_texture_);
+        }
     }
 
-    scr_texture_ = SDL_CreateTexture(sdl_renderer_,
-                                     SDL_PIXELFORMAT_ARGB8888,
-                                     SDL_TEXTUREACCESS_STREAMING,
-                                     SCR_PX_W, SCR_PX_H);
+    TRACE << "Drawing with " << (is_atlas_mode_ ? "atlas textures" : "screen surface")
+          << std::endl;
 
-    if (!scr_texture_)
+    if (!is_atlas_mode_)
     {
-        TRACE << "Failed to create screen texture" << std::endl;
-        assert(false);
+        scr_srf_ = SDL_CreateRGBSurface(0,
+                                        SCR_PX_W, SCR_PX_H,
+                                        SCREEN_BPP,
+                                        0x00FF0000,
+                                        0x0000FF00,
+                                        0x000000FF,
+                                        0xFF000000);
+
+        if (!scr_srf_)
+        {
+            TRACE << "Failed to create screen surface" << std::endl;
+            assert(false);
+        }
+
+        scr_texture_ = SDL_CreateTexture(sdl_renderer_,
+                                         SDL_PIXELFORMAT_ARGB8888,
+                                         SDL_TEXTUREACCESS_STREAMING,
+                                         SCR_PX_W, SCR_PX_H);
+
+        if (!scr_texture_)
+        {
+            TRACE << "Failed to create screen texture" << std::endl;
+            assert(false);
+        }
     }
 
     load_font();
@@ -480,67 +958,353 @@ void init()
 
     load_contour(config::is_tiles_mode() ? tile_px_data_ : font_px_data_);
 
+    if (is_atlas_mode_)
+    {
+        mk_atlas_textures();
+    }
+    else
+    {
+        mk_all_sheet_bits();
+    }
+
+    //The pixel values depend on the format of the new screen surface
+    clear_mapped_clrs();
+
+    if (!frame_mutex_)
+    {
+        frame_mutex_ = SDL_CreateMutex();
+
+        if (!frame_mutex_)
+        {
+            TRACE << "Failed to create frame mutex" << std::endl;
+            assert(false);
+        }
+    }
+
+    //Frames drawn for the old renderer are dropped (the game redraws everything)
+    SDL_LockMutex(frame_mutex_);
+
+    frames_.clear();
+
+    frame_hold_end_ = 0;
+
+    SDL_UnlockMutex(frame_mutex_);
+
     TRACE_FUNC_END;
 }
 
-void cleanup()
+void set_window_fullscreen()
 {
-    TRACE_FUNC_BEGIN;
+    if (config::is_fullscreen())
+    {
+        SDL_SetWindowFullscreen(sdl_window_, SDL_WINDOW_FULLSCREEN_DESKTOP);
+    }
+    else
+    {
+        SDL_SetWindowFullscreen(sdl_window_, SDL_WINDOW_SHOWN);
+    }
+}
 
-    if (sdl_renderer_)
+void reset_render_target()
+{
+    //NOTE: The atlas textures are static textures, which are restored by SDL - only the
+    //contents of the screen texture (the render target) are lost
+    if (is_atlas_mode_)
     {
-        SDL_DestroyRenderer(sdl_renderer_);
-        sdl_renderer_ = nullptr;
+        SDL_SetRenderTarget(sdl_renderer_, scr_texture_);
     }
+}
 
-    if (sdl_window_)
+void run_fill(const SDL_Rect& sdl_rect, const Clr& clr)
+{
+    mk_scr_px_area_dirty(Pos(sdl_rect.x, sdl_rect.y), Pos(sdl_rect.w, sdl_rect.h));
+
+    if (is_atlas_mode_)
     {
-        SDL_DestroyWindow(sdl_window_);
-        sdl_window_ = nullptr;
+        SDL_SetRenderDrawColor(sdl_renderer_, clr.r, clr.g, clr.b, SDL_ALPHA_OPAQUE);
+        SDL_RenderFillRect(sdl_renderer_, &sdl_rect);
+    }
+    else
+    {
+        SDL_FillRect(scr_srf_, &sdl_rect, mapped_clr(clr));
     }
+}
+
+void run_draw_main_menu_logo(const SDL_Rect& dst_rect)
+{
+    if (is_atlas_mode_)
+    {
+        mk_scr_px_area_dirty(Pos(dst_rect.x, dst_rect.y), Pos(dst_rect.w, dst_rect.h));
 
-    if (scr_texture_)
+        SDL_RenderCopy(sdl_renderer_, main_menu_logo_texture_, nullptr, &dst_rect);
+    }
+    else if (main_menu_logo_srf_)
     {
-        SDL_DestroyTexture(scr_texture_);
-        scr_texture_ = nullptr;
+        blit_surface(*main_menu_logo_srf_, Pos(dst_rect.x, dst_rect.y));
     }
+}
 
-    if (scr_srf_)
+void run_cmds(const std::vector<Draw_cmd>& cmds)
+{
+    for (const Draw_cmd& cmd : cmds)
     {
-        SDL_FreeSurface(scr_srf_);
-        scr_srf_ = nullptr;
+        const Pos px_pos(cmd.dst.x, cmd.dst.y);
+
+        switch (cmd.type)
+        {
+        case Draw_cmd_type::fill:
+            run_fill(cmd.dst, cmd.clr);
+            break;
+
+        case Draw_cmd_type::font:
+            run_put_pixels(font_bits_, font_texture_, cmd.sheet_pos, px_pos, cmd.clr);
+            break;
+
+        case Draw_cmd_type::tile:
+            run_put_pixels(tile_bits_, tile_texture_, cmd.sheet_pos, px_pos, cmd.clr);
+            break;
+
+        case Draw_cmd_type::contour:
+            run_put_pixels(contour_bits_, contour_texture_, cmd.sheet_pos, px_pos, cmd.clr);
+            break;
+
+        case Draw_cmd_type::main_menu_logo:
+            run_draw_main_menu_logo(cmd.dst);
+            break;
+        }
     }
+}
 
-    if (main_menu_logo_srf_)
+void present()
+{
+    if (is_atlas_mode_)
     {
-        SDL_FreeSurface(main_menu_logo_srf_);
-        main_menu_logo_srf_ = nullptr;
+        //The screen texture keeps everything drawn so far, so only parts of the screen
+        //need to be redrawn between updates (like with the screen surface)
+        SDL_SetRenderTarget(sdl_renderer_, nullptr);
+        SDL_RenderCopy(sdl_renderer_, scr_texture_, nullptr, nullptr);
+        SDL_RenderPresent(sdl_renderer_);
+        SDL_SetRenderTarget(sdl_renderer_, scr_texture_);
+
+        for (int x = 0; x < SCREEN_W; ++x)
+        {
+            for (int y = 0; y < SCREEN_H; ++y)
+            {
+                is_scr_cell_dirty_[x][y] = false;
+            }
+        }
+    }
+    else
+    {
+        upload_dirty_scr_cells();
+        SDL_RenderCopy(sdl_renderer_, scr_texture_, nullptr, nullptr);
+        SDL_RenderPresent(sdl_renderer_);
+    }
+
+    last_present_time_ = SDL_GetTicks();
+}
+
+//Draws the published frames if the presented frame is no longer held, and presents them.
+//All frames up to (and including) the first held frame are presented together.
+void present_frames()
+{
+    static std::vector<Frame> frames_to_draw;
+
+    frames_to_draw.clear();
+
+    SDL_LockMutex(frame_mutex_);
+
+    const Uint32 NOW = SDL_GetTicks();
+
+    //When the bot is playing, frames are only presented now and then (the frames meanwhile
+    //are drawn together with the next presented frame)
+    const bool IS_BOT_WAITING =
+        config::is_bot_playing() && (NOW - last_present_time_ < BOT_MIN_PRESENT_INTERVAL);
+
+    if (!frames_.empty() && NOW >= frame_hold_end_ && !IS_BOT_WAITING)
+    {
+        size_t  nr_frames   = 0;
+        Uint32  hold        = 0;
+
+        while (nr_frames < frames_.size() && hold == 0)
+        {
+            hold = frames_[nr_frames].hold;
+
+            frames_to_draw.push_back(Frame());
+            frames_to_draw.back().cmds.swap(frames_[nr_frames].cmds);
+
+            ++nr_frames;
+        }
+
+        frames_.erase(begin(frames_), begin(frames_) + nr_frames);
+
+        frame_hold_end_     = NOW + hold;
+        last_frame_time_    = NOW;
+    }
+
+    SDL_UnlockMutex(frame_mutex_);
+
+    if (frames_to_draw.empty())
+    {
+        return;
+    }
+
+    for (const Frame& frame : frames_to_draw)
+    {
+        run_cmds(frame.cmds);
     }
 
+    present();
+}
+
+//-----------------------------------------------------------------------------
+// Game thread
+//-----------------------------------------------------------------------------
+void (*game_func_)() = nullptr;
+
+int run_game(void* data)
+{
+    (void)data;
+
+    game_func_();
+
+    SDL_LockMutex(frame_mutex_);
+    is_game_running_ = false;
+    SDL_UnlockMutex(frame_mutex_);
+
+    return 0;
+}
+
+} //Namespace
+
+void init()
+{
+    TRACE_FUNC_BEGIN;
+
+    //The window and the renderer belong to the main thread
+    sdl_wrapper::run_on_main_thread(init_renderer);
+
+    //Commands drawn for the old renderer are dropped
+    cmds_.clear();
+
+    mk_clr_luts();
+
+    //Also makes the whole screen dirty, and all map cells need to be redrawn
+    clear_screen();
+
+    TRACE_FUNC_END;
+}
+
+void cleanup()
+{
+    TRACE_FUNC_BEGIN;
+
+    sdl_wrapper::run_on_main_thread(cleanup_renderer);
+
+    cmds_.clear();
+    frames_.clear();
+
+    if (frame_mutex_)
+    {
+        SDL_DestroyMutex(frame_mutex_);
+        frame_mutex_ = nullptr;
+    }
+
+    TRACE_FUNC_END;
+}
+
+void run_game_thread(void (*game_func)())
+{
+    TRACE_FUNC_BEGIN;
+
+    assert(sdl_wrapper::is_main_thread());
+    assert(frame_mutex_);
+
+    game_func_          = game_func;
+    is_game_running_    = true;
+
+    SDL_Thread* const game_thread = SDL_CreateThread(run_game, "game", nullptr);
+
+    if (!game_thread)
+    {
+        TRACE << "Failed to create game thread" << std::endl;
+        assert(false);
+        return;
+    }
+
+    bool is_game_running = true;
+
+    while (is_game_running)
+    {
+        sdl_wrapper::pump_events();
+
+        sdl_wrapper::run_main_thread_task();
+
+        present_frames();
+
+        SDL_LockMutex(frame_mutex_);
+        is_game_running = is_game_running_;
+        SDL_UnlockMutex(frame_mutex_);
+
+        SDL_Delay(1);
+    }
+
+    SDL_WaitThread(game_thread, nullptr);
+
     TRACE_FUNC_END;
 }
 
 void on_toggle_fullscreen()
 {
-    if (config::is_fullscreen())
+    sdl_wrapper::run_on_main_thread(set_window_fullscreen);
+
+    //The map is redrawn in full on the next draw (the screen contents may have been lost,
+    //then the renderer also sends SDL_RENDER_TARGETS_RESET)
+    invalidate_map();
+
+    update_screen();
+}
+
+void hold_frame(const Uint32 DURATION)
+{
+    if (!is_inited() || config::is_bot_playing())
     {
-        SDL_SetWindowFullscreen(sdl_window_, SDL_WINDOW_FULLSCREEN_DESKTOP);
+        return;
+    }
+
+    SDL_LockMutex(frame_mutex_);
+
+    if (frames_.empty())
+    {
+        //The last frame published is already being presented
+        frame_hold_end_ = std::max(frame_hold_end_, last_frame_time_ + DURATION);
     }
     else
     {
-        SDL_SetWindowFullscreen(sdl_window_, SDL_WINDOW_SHOWN);
+        frames_.back().hold = std::max(frames_.back().hold, DURATION);
     }
 
-    update_screen();
+    SDL_UnlockMutex(frame_mutex_);
 }
 
 void update_screen()
 {
-    if (is_inited())
+    if (!is_inited())
     {
-        SDL_UpdateTexture(scr_texture_, nullptr, scr_srf_->pixels, scr_srf_->pitch);
-        SDL_RenderCopy(sdl_renderer_, scr_texture_, nullptr, nullptr);
-        SDL_RenderPresent(sdl_renderer_);
+        return;
+    }
+
+    SDL_LockMutex(frame_mutex_);
+
+    frames_.push_back(Frame());
+    frames_.back().cmds.swap(cmds_);
+
+    SDL_UnlockMutex(frame_mutex_);
+
+    //Before the game thread is started, the frame is presented right away
+    if (sdl_wrapper::is_main_thread())
+    {
+        present_frames();
     }
 }
 
@@ -548,19 +1312,64 @@ void clear_screen()
 {
     if (is_inited())
     {
-        SDL_FillRect(scr_srf_, nullptr, SDL_MapRGB(scr_srf_->format, 0, 0, 0));
+        const SDL_Rect sdl_rect = {0, 0, config::scr_px_w(), config::scr_px_h()};
+
+        fill_rect(sdl_rect, clr_black);
+
+        invalidate_map();
+    }
+}
+
+void invalidate_map()
+{
+    for (int x = 0; x < MAP_W; ++x)
+    {
+        for (int y = 0; y < MAP_H; ++y)
+        {
+            is_map_cell_drawn_[x][y] = false;
+        }
+    }
+}
+
+void on_render_targets_reset()
+{
+    if (!is_inited())
+    {
+        return;
+    }
+
+    TRACE << "Render targets reset, redrawing the screen" << std::endl;
+
+    sdl_wrapper::run_on_main_thread(reset_render_target);
+
+    clear_screen();
+
+    if (map::player)
+    {
+        draw_map_and_interface();
+    }
+    else
+    {
+        update_screen();
     }
 }
 
 void draw_main_menu_logo(const int Y_POS)
 {
-    const int SCR_PX_W  = config::scr_px_w();
-    const int LOGO_PX_H = main_menu_logo_srf_->w;
-    const int CELL_PX_H = config::cell_px_h();
+    if (!is_inited())
+    {
+        return;
+    }
 
-    const Pos px_pos((SCR_PX_W - LOGO_PX_H) / 2, CELL_PX_H * Y_POS);
+    const SDL_Rect dst_rect
+    {
+        (config::scr_px_w() - main_menu_logo_px_w_) / 2, config::cell_px_h() * Y_POS,
+        main_menu_logo_px_w_, main_menu_logo_px_h_
+    };
 
-    blit_surface(*main_menu_logo_srf_, px_pos);
+    on_px_area_drawn(Pos(dst_rect.x, dst_rect.y), Pos(dst_rect.w, dst_rect.h));
+
+    cmds_.push_back({Draw_cmd_type::main_menu_logo, Pos(), dst_rect, clr_black});
 }
 
 void draw_marker(const Pos& p, const std::vector<Pos>& trail, const int EFFECTIVE_RANGE)
@@ -668,7 +1477,7 @@ void draw_blast_at_field(const Pos& center_pos, const int RADIUS,
 
         update_screen();
 
-        if (is_any_blast_rendered) {sdl_wrapper::sleep(config::delay_explosion() / 2);}
+        if (is_any_blast_rendered) {hold_frame(config::delay_explosion() / 2);}
 
         for (
             pos.y = std::max(1, center_pos.y - RADIUS);
@@ -702,7 +1511,7 @@ void draw_blast_at_field(const Pos& center_pos, const int RADIUS,
 
         update_screen();
 
-        if (is_any_blast_rendered) {sdl_wrapper::sleep(config::delay_explosion() / 2);}
+        if (is_any_blast_rendered) {hold_frame(config::delay_explosion() / 2);}
 
         draw_map_and_interface();
     }
@@ -731,7 +1540,7 @@ void draw_blast_at_cells(const std::vector<Pos>& positions, const Clr& clr)
         }
 
         update_screen();
-        sdl_wrapper::sleep(config::delay_explosion() / 2);
+        hold_frame(config::delay_explosion() / 2);
 
         for (const Pos& pos : positions)
         {
@@ -746,7 +1555,7 @@ void draw_blast_at_cells(const std::vector<Pos>& positions, const Clr& clr)
         }
 
         update_screen();
-        sdl_wrapper::sleep(config::delay_explosion() / 2);
+        hold_frame(config::delay_explosion() / 2);
         draw_map_and_interface();
     }
 
@@ -801,7 +1610,8 @@ void draw_tile(const Tile_id tile, const Panel panel, const Pos& pos, const Clr&
 
         if (!utils::is_clr_eq(bg_clr, clr_black))
         {
-            put_pixels_on_scr(contour_px_data_, art::tile_pos(tile), px_pos, clr_black);
+            put_pixels_on_scr(Draw_cmd_type::contour, art::tile_pos(tile), px_pos,
+                              clr_black);
         }
 
         put_pixels_on_scr_for_tile(tile, px_pos, clr);
@@ -899,8 +1709,7 @@ int draw_text_centered(const std::string& str, const Panel panel, const Pos& pos
         (Uint16)W_TOT_PIXEL, (Uint16)cell_dims.y
     };
 
-    SDL_FillRect(scr_srf_, &sdl_rect,
-                 SDL_MapRGB(scr_srf_->format, bg_clr.r, bg_clr.g, bg_clr.b));
+    fill_rect(sdl_rect, bg_clr);
 
     for (int i = 0; i < LEN; ++i)
     {
@@ -990,7 +1799,7 @@ void draw_rectangle_solid(const Pos& px_pos, const Pos& px_dims, const Clr& clr)
             (Uint16)px_dims.x, (Uint16)px_dims.y
         };
 
-        SDL_FillRect(scr_srf_, &sdl_rect, SDL_MapRGB(scr_srf_->format, clr.r, clr.g, clr.b));
+        fill_rect(sdl_rect, clr);
     }
 }
 
@@ -1125,7 +1934,9 @@ void draw_map_and_interface(const bool SHOULD_UPDATE_SCREEN)
         return;
     }
 
-    clear_screen();
+    //The map is not covered, since draw_map() only redraws the cells which have changed
+    cover_panel(Panel::log);
+    cover_panel(Panel::char_lines);
 
     draw_map();
 
@@ -1312,6 +2123,9 @@ void draw_map()
     }
 
     //---------------- DRAW THE GRID
+    is_drawing_map_         = true;
+    nr_map_cells_redrawn_   = 0;
+
     for (int x = 0; x < MAP_W; ++x)
     {
         for (int y = 0; y < MAP_H; ++y)
@@ -1327,20 +2141,16 @@ void draw_map()
                     const int DIST_FROM_PLAYER =
                         utils::king_dist(map::player->pos, Pos(x, y));
 
-                    if (DIST_FROM_PLAYER > 1)
-                    {
-                        const double DIV =
-                            std::min(2.0, 1.0 + (double(DIST_FROM_PLAYER - 1) * 0.33));
+                    const Uint8* const fade_lut =
+                        light_fade_lut_[std::min(DIST_FROM_PLAYER, LIGHT_FADE_MAX_DIST)];
 
-                        div_clr(tmp_render_data.clr,    DIV);
-                        div_clr(tmp_render_data.clr_bg, DIV);
-                    }
+                    apply_lut(tmp_render_data.clr,    fade_lut);
+                    apply_lut(tmp_render_data.clr_bg, fade_lut);
 
                     if (cell.is_dark && !cell.is_lit)
                     {
-                        const double DRK_DIV = 1.75;
-                        div_clr(tmp_render_data.clr,    DRK_DIV);
-                        div_clr(tmp_render_data.clr_bg, DRK_DIV);
+                        apply_lut(tmp_render_data.clr,    dark_lut_);
+                        apply_lut(tmp_render_data.clr_bg, dark_lut_);
                     }
                 }
             }
@@ -1354,9 +2164,8 @@ void draw_map()
 
                 tmp_render_data.is_aware_of_mon_here    = is_aware_of_mon_here;
 
-                const double DIV = 5.0;
-                div_clr(tmp_render_data.clr,    DIV);
-                div_clr(tmp_render_data.clr_bg, DIV);
+                apply_lut(tmp_render_data.clr,    memory_lut_);
+                apply_lut(tmp_render_data.clr_bg, memory_lut_);
             }
 
             if (IS_TILES)
@@ -1463,34 +2272,46 @@ void draw_map()
 
             const Pos pos(x, y);
 
-            if (tmp_render_data.is_aware_of_mon_here)
-            {
-                draw_glyph('!', Panel::map, pos, clr_black, true, clr_nosf_teal_drk);
-            }
-            else if (tmp_render_data.tile != Tile_id::empty && tmp_render_data.glyph != ' ')
+            if (
+                !is_map_cell_drawn_[x][y] ||
+                !is_same_drawn(tmp_render_data, drawn_map_[x][y]))
             {
-                if (IS_TILES)
+                cover_cell_in_map(pos);
+
+                if (tmp_render_data.is_aware_of_mon_here)
                 {
-                    draw_tile(tmp_render_data.tile,
-                              Panel::map,
-                              pos,
-                              tmp_render_data.clr,
-                              tmp_render_data.clr_bg);
+                    draw_glyph('!', Panel::map, pos, clr_black, true, clr_nosf_teal_drk);
                 }
-                else //Text mode
+                else if (tmp_render_data.tile != Tile_id::empty && tmp_render_data.glyph != ' ')
                 {
-                    draw_glyph(tmp_render_data.glyph,
-                               Panel::map,
-                               pos,
-                               tmp_render_data.clr,
-                               true,
-                               tmp_render_data.clr_bg);
-                }
+                    if (IS_TILES)
+                    {
+                        draw_tile(tmp_render_data.tile,
+                                  Panel::map,
+                                  pos,
+                                  tmp_render_data.clr,
+                                  tmp_render_data.clr_bg);
+                    }
+                    else //Text mode
+                    {
+                        draw_glyph(tmp_render_data.glyph,
+                                   Panel::map,
+                                   pos,
+                                   tmp_render_data.clr,
+                                   true,
+                                   tmp_render_data.clr_bg);
+                    }
 
-                if (tmp_render_data.lifebar_length != -1)
-                {
-                    draw_life_bar(pos, tmp_render_data.lifebar_length);
+                    if (tmp_render_data.lifebar_length != -1)
+                    {
+                        draw_life_bar(pos, tmp_render_data.lifebar_length);
+                    }
                 }
+
+                drawn_map_[x][y]            = tmp_render_data;
+                is_map_cell_drawn_[x][y]    = true;
+
+                ++nr_map_cells_redrawn_;
             }
 
             if (!cell.is_explored)
@@ -1500,7 +2321,10 @@ void draw_map()
         }
     }
 
+    is_drawing_map_ = false;
+
     //---------------- DRAW PLAYER CHARACTER
+    //NOTE: This is drawn over the map cell, so the cell is redrawn next time
     const Pos&  pos         = map::player->pos;
     Item*       item        = map::player->inv().item_in_slot(Slot_id::wielded);
     const bool  IS_GHOUL    = player_bon::bg() == Bg::ghoul;
@@ -1535,4 +2359,9 @@ void draw_map()
     draw_player_shock_excl_marks();
 }
 
+int nr_map_cells_redrawn()
+{
+    return nr_map_cells_redrawn_;
+}
+
 } //render
@@ -0,0 +1,774 @@
+#include "room_graph.hpp"
+
+#include "init.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <climits>
+
+#include "map.hpp"
+#include "map_parsing.hpp"
+#include "feature_rigid.hpp"
+#include "utils.hpp"
+
+namespace room_graph
+{
+
+namespace
+{
+
+enum class Cell_kind {blocked, free, door};
+
+//NOTE: Two free areas are never adjacent (they would be one area), so all nodes adjacent to
+//a free area are doors, and every route between areas passes through door cells.
+struct Node
+{
+    Node() :
+        is_used             (false),
+        area                (),
+        adj                 (),
+        is_door_steps_set   (false),
+        door_steps          (),
+        cell_steps          () {}
+
+    bool                is_used;
+    Rect                area;   //Bounding box of the cells of the node
+    std::vector<int>    adj;
+
+    //For free areas - the steps from each adjacent door through the area, to the other doors
+    //(indexed [(door * nr doors) + other door]), and to each cell in the bounding box
+    //(indexed [(door * nr cells) + cell]). Set the first time they are needed.
+    bool                is_door_steps_set;
+    std::vector<int>    door_steps;
+    std::vector<int>    cell_steps;
+};
+
+//When more cells than this are dirty, the whole graph is rebuilt
+const size_t MAX_NR_DIRTY_CELLS = 64;
+
+Cell_kind           kind_map_[MAP_W][MAP_H];
+int                 node_map_[MAP_W][MAP_H];    //-1 for blocked cells
+std::vector<Node>   nodes_;
+std::vector<int>    free_node_ids_;
+int                 nr_nodes_ = 0;
+
+//Door route search state, per node (see mk_door_route())
+std::vector<int>    steps_;
+std::vector<int>    prev_door_;
+std::vector<int>    prev_area_;
+
+bool                is_dirty_[MAP_W][MAP_H];
+std::vector<Pos>    dirty_cells_;
+bool                is_rebuild_needed_ = true;
+
+Cell_kind kind_at(const Pos& p)
+{
+    const Rigid* const rigid = map::cells[p.x][p.y].rigid;
+
+    if (!rigid || !utils::is_pos_inside_map(p, false))
+    {
+        return Cell_kind::blocked;
+    }
+
+    if (rigid->id() == Feature_id::door)
+    {
+        return Cell_kind::door;
+    }
+
+    return map::move_cmn_blockers[p.x][p.y] ? Cell_kind::blocked : Cell_kind::free;
+}
+
+int mk_node()
+{
+    ++nr_nodes_;
+
+    if (free_node_ids_.empty())
+    {
+        nodes_.push_back(Node());
+        nodes_.back().is_used = true;
+        return nodes_.size() - 1;
+    }
+
+    const int ID = free_node_ids_.back();
+    free_node_ids_.pop_back();
+
+    nodes_[ID].is_used = true;
+
+    return ID;
+}
+
+//Removes the node and its edges, and returns the positions of its cells
+void erase_node(const int ID, std::vector<Pos>& cells_out)
+{
+    Node& node = nodes_[ID];
+
+    assert(node.is_used);
+
+    for (const int ADJ_ID : node.adj)
+    {
+        std::vector<int>& adj_of_adj = nodes_[ADJ_ID].adj;
+
+        adj_of_adj.erase(std::find(begin(adj_of_adj), end(adj_of_adj), ID));
+    }
+
+    for (int x = node.area.p0.x; x <= node.area.p1.x; ++x)
+    {
+        for (int y = node.area.p0.y; y <= node.area.p1.y; ++y)
+        {
+            if (node_map_[x][y] == ID)
+            {
+                node_map_[x][y] = -1;
+                cells_out.push_back(Pos(x, y));
+            }
+        }
+    }
+
+    node.is_used            = false;
+    node.area.p0            = Pos();
+    node.area.p1            = Pos();
+    node.is_door_steps_set  = false;
+    node.adj.clear();
+    node.door_steps.clear();
+    node.cell_steps.clear();
+
+    free_node_ids_.push_back(ID);
+
+    --nr_nodes_;
+}
+
+//Gives a new node to the cell, and to all free cells connected to it (unless it's a door)
+int mk_node_from(const Pos& origin)
+{
+    assert(node_map_[origin.x][origin.y] == -1);
+
+    const Cell_kind KIND = kind_map_[origin.x][origin.y];
+
+    assert(KIND != Cell_kind::blocked);
+
+    const int ID = mk_node();
+
+    Rect& area = nodes_[ID].area;
+
+    area.p0 = origin;
+    area.p1 = origin;
+
+    node_map_[origin.x][origin.y] = ID;
+
+    if (KIND == Cell_kind::door)
+    {
+        return ID;
+    }
+
+    static std::vector<Pos> stack;
+
+    stack.clear();
+    stack.push_back(origin);
+
+    while (!stack.empty())
+    {
+        const Pos p = stack.back();
+        stack.pop_back();
+
+        for (const Pos& d : dir_utils::dir_list)
+        {
+            const Pos adj_p(p + d);
+
+            //NOTE: Free cells are never at the map edge, so no bounds check is needed
+            if (
+                node_map_[adj_p.x][adj_p.y] == -1 &&
+                kind_map_[adj_p.x][adj_p.y] == Cell_kind::free)
+            {
+                node_map_[adj_p.x][adj_p.y] = ID;
+
+                area.p0.x = std::min(area.p0.x, adj_p.x);
+                area.p0.y = std::min(area.p0.y, adj_p.y);
+                area.p1.x = std::max(area.p1.x, adj_p.x);
+                area.p1.y = std::max(area.p1.y, adj_p.y);
+
+                stack.push_back(adj_p);
+            }
+        }
+    }
+
+    return ID;
+}
+
+void add_edge(const int ID0, const int ID1)
+{
+    std::vector<int>& adj = nodes_[ID0].adj;
+
+    if (std::find(begin(adj), end(adj), ID1) == end(adj))
+    {
+        adj.push_back(ID1);
+        nodes_[ID1].adj.push_back(ID0);
+    }
+}
+
+void mk_edges_from(const int ID)
+{
+    const Rect area = nodes_[ID].area;
+
+    for (int x = area.p0.x; x <= area.p1.x; ++x)
+    {
+        for (int y = area.p0.y; y <= area.p1.y; ++y)
+        {
+            if (node_map_[x][y] != ID)
+            {
+                continue;
+            }
+
+            for (const Pos& d : dir_utils::dir_list)
+            {
+                const int ADJ_ID = node_map_[x + d.x][y + d.y];
+
+                if (ADJ_ID != -1 && ADJ_ID != ID)
+                {
+                    add_edge(ID, ADJ_ID);
+                }
+            }
+        }
+    }
+}
+
+void rebuild()
+{
+    nodes_.clear();
+    free_node_ids_.clear();
+    nr_nodes_ = 0;
+
+    for (int x = 0; x < MAP_W; ++x)
+    {
+        for (int y = 0; y < MAP_H; ++y)
+        {
+            kind_map_[x][y] = kind_at(Pos(x, y));
+            node_map_[x][y] = -1;
+        }
+    }
+
+    for (int x = 0; x < MAP_W; ++x)
+    {
+        for (int y = 0; y < MAP_H; ++y)
+        {
+            if (node_map_[x][y] == -1 && kind_map_[x][y] != Cell_kind::blocked)
+            {
+                mk_node_from(Pos(x, y));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < nodes_.size(); ++i)
+    {
+        mk_edges_from(i);
+    }
+}
+
+//Rebuilds the nodes at and around the cell, if the kind of the cell has changed
+void update_cell(const Pos& p)
+{
+    const Cell_kind NEW_KIND = kind_at(p);
+
+    if (NEW_KIND == kind_map_[p.x][p.y])
+    {
+        return;
+    }
+
+    //The node of the cell, and all free areas around it, may be split or merged
+    std::vector<Pos> cells_to_rebuild;
+
+    const int OLD_ID = node_map_[p.x][p.y];
+
+    if (OLD_ID != -1)
+    {
+        erase_node(OLD_ID, cells_to_rebuild);
+    }
+
+    for (const Pos& d : dir_utils::dir_list)
+    {
+        const Pos adj_p(p + d);
+
+        if (!utils::is_pos_inside_map(adj_p))
+        {
+            continue;
+        }
+
+        const int ADJ_ID = node_map_[adj_p.x][adj_p.y];
+
+        if (ADJ_ID != -1 && kind_map_[adj_p.x][adj_p.y] == Cell_kind::free)
+        {
+            erase_node(ADJ_ID, cells_to_rebuild);
+        }
+    }
+
+    kind_map_[p.x][p.y] = NEW_KIND;
+
+    if (NEW_KIND != Cell_kind::blocked)
+    {
+        cells_to_rebuild.push_back(p);
+    }
+
+    std::vector<int> new_ids;
+
+    for (const Pos& cell : cells_to_rebuild)
+    {
+        if (
+            node_map_[cell.x][cell.y] == -1 &&
+            kind_map_[cell.x][cell.y] != Cell_kind::blocked)
+        {
+            new_ids.push_back(mk_node_from(cell));
+        }
+    }
+
+    for (const int ID : new_ids)
+    {
+        mk_edges_from(ID);
+    }
+}
+
+void update()
+{
+    if (is_rebuild_needed_)
+    {
+        for (const Pos& p : dirty_cells_)
+        {
+            is_dirty_[p.x][p.y] = false;
+        }
+
+        dirty_cells_.clear();
+
+        rebuild();
+
+        is_rebuild_needed_ = false;
+        return;
+    }
+
+    for (const Pos& p : dirty_cells_)
+    {
+        is_dirty_[p.x][p.y] = false;
+
+        update_cell(p);
+    }
+
+    dirty_cells_.clear();
+}
+
+bool is_door(const int ID)
+{
+    //NOTE: The corner of the bounding box of a free area may be a door of another node
+    const Pos& p = nodes_[ID].area.p0;
+
+    return kind_map_[p.x][p.y] == Cell_kind::door && node_map_[p.x][p.y] == ID;
+}
+
+int cell_idx(const Rect& area, const Pos& p)
+{
+    return ((p.x - area.p0.x) * area.h()) + (p.y - area.p0.y);
+}
+
+//Walks from each door of the free area through the area, and stores the steps to the other
+//doors and to the cells of the area
+void mk_door_steps(Node& node, const int AREA_ID)
+{
+    const size_t NR_DOORS = node.adj.size();
+    const size_t NR_CELLS = node.area.w() * node.area.h();
+
+    node.door_steps.assign(NR_DOORS * NR_DOORS, -1);
+    node.cell_steps.assign(NR_DOORS * NR_CELLS, -1);
+
+    static std::vector<Pos> queue;
+
+    for (size_t door_idx = 0; door_idx < NR_DOORS; ++door_idx)
+    {
+        int* const door_steps = &node.door_steps[door_idx * NR_DOORS];
+        int* const cell_steps = &node.cell_steps[door_idx * NR_CELLS];
+
+        queue.clear();
+        queue.push_back(nodes_[node.adj[door_idx]].area.p0);
+
+        for (size_t i = 0; i < queue.size(); ++i)
+        {
+            const Pos p = queue[i];
+
+            const int STEPS = i == 0 ? 0 : cell_steps[cell_idx(node.area, p)];
+
+            for (const Pos& d : dir_utils::dir_list)
+            {
+                const Pos adj_p(p + d);
+
+                const int ADJ_ID = node_map_[adj_p.x][adj_p.y];
+
+                if (ADJ_ID == AREA_ID)
+                {
+                    int& adj_steps = cell_steps[cell_idx(node.area, adj_p)];
+
+                    if (adj_steps == -1)
+                    {
+                        adj_steps = STEPS + 1;
+                        queue.push_back(adj_p);
+                    }
+                }
+                else if (i > 0 && ADJ_ID != -1)
+                {
+                    //Another door of the area (only walked to, not through)
+                    const size_t OTHER_IDX =
+                        std::find(begin(node.adj), end(node.adj), ADJ_ID) - begin(node.adj);
+
+                    if (door_steps[OTHER_IDX] == -1)
+                    {
+                        door_steps[OTHER_IDX] = STEPS + 1;
+                    }
+                }
+            }
+        }
+
+        door_steps[door_idx] = 0;
+    }
+
+    node.is_door_steps_set = true;
+}
+
+//The steps from a door of the free area to another door, or to a cell in the area
+int door_to_door_steps(const int AREA_ID, const size_t DOOR_IDX, const size_t OTHER_IDX)
+{
+    Node& node = nodes_[AREA_ID];
+
+    if (!node.is_door_steps_set)
+    {
+        mk_door_steps(node, AREA_ID);
+    }
+
+    return node.door_steps[(DOOR_IDX * node.adj.size()) + OTHER_IDX];
+}
+
+int door_to_cell_steps(const int AREA_ID, const size_t DOOR_IDX, const Pos& p)
+{
+    Node& node = nodes_[AREA_ID];
+
+    if (!node.is_door_steps_set)
+    {
+        mk_door_steps(node, AREA_ID);
+    }
+
+    const size_t NR_CELLS = node.area.w() * node.area.h();
+
+    return node.cell_steps[(DOOR_IDX * NR_CELLS) + cell_idx(node.area, p)];
+}
+
+//Finds the doors of a shortest route (by number of steps) from p0 to p1 which passes a door.
+//Each door on the route gets the door before it (-1 for the first door), and the free area
+//walked through to reach it (-1 if it is next to the door before it). Returns the last door,
+//or -1 if there is no such route.
+int mk_door_route(const Pos& p0, const Pos& p1)
+{
+    const int ID0 = node_map_[p0.x][p0.y];
+    const int ID1 = node_map_[p1.x][p1.y];
+
+    const size_t NR_NODES = nodes_.size();
+
+    steps_     .assign(NR_NODES, INT_MAX);
+    prev_door_ .assign(NR_NODES, -1);
+    prev_area_ .assign(NR_NODES, -1);
+
+    typedef std::pair<int, int> Steps_and_id;
+
+    std::priority_queue<Steps_and_id,
+                        std::vector<Steps_and_id>,
+                        std::greater<Steps_and_id>> queue;
+
+    if (is_door(ID0))
+    {
+        steps_[ID0] = 0;
+        queue.push(Steps_and_id(0, ID0));
+    }
+    else
+    {
+        const std::vector<int>& adj = nodes_[ID0].adj;
+
+        for (size_t i = 0; i < adj.size(); ++i)
+        {
+            steps_[adj[i]]      = door_to_cell_steps(ID0, i, p0);
+            prev_area_[adj[i]]  = ID0;
+            queue.push(Steps_and_id(steps_[adj[i]], adj[i]));
+        }
+    }
+
+    while (!queue.empty())
+    {
+        const Steps_and_id cur = queue.top();
+        queue.pop();
+
+        const int ID = cur.second;
+
+        if (cur.first > steps_[ID])
+        {
+            continue;
+        }
+
+        for (const int ADJ_ID : nodes_[ID].adj)
+        {
+            if (is_door(ADJ_ID))
+            {
+                if (cur.first + 1 < steps_[ADJ_ID])
+                {
+                    steps_[ADJ_ID]      = cur.first + 1;
+                    prev_door_[ADJ_ID]  = ID;
+                    prev_area_[ADJ_ID]  = -1;
+                    queue.push(Steps_and_id(steps_[ADJ_ID], ADJ_ID));
+                }
+
+                continue;
+            }
+
+            //Through a free area to its other doors
+            const std::vector<int>& area_adj = nodes_[ADJ_ID].adj;
+
+            const size_t FROM_IDX =
+                std::find(begin(area_adj), end(area_adj), ID) - begin(area_adj);
+
+            for (size_t i = 0; i < area_adj.size(); ++i)
+            {
+                const int STEPS_THROUGH = door_to_door_steps(ADJ_ID, FROM_IDX, i);
+
+                const int DOOR_ID = area_adj[i];
+
+                if (STEPS_THROUGH > 0 && cur.first + STEPS_THROUGH < steps_[DOOR_ID])
+                {
+                    steps_[DOOR_ID]     = cur.first + STEPS_THROUGH;
+                    prev_door_[DOOR_ID] = ID;
+                    prev_area_[DOOR_ID] = ADJ_ID;
+                    queue.push(Steps_and_id(steps_[DOOR_ID], DOOR_ID));
+                }
+            }
+        }
+    }
+
+    if (is_door(ID1))
+    {
+        return steps_[ID1] == INT_MAX ? -1 : ID1;
+    }
+
+    int last_door   = -1;
+    int best_steps  = INT_MAX;
+
+    const std::vector<int>& adj = nodes_[ID1].adj;
+
+    for (size_t i = 0; i < adj.size(); ++i)
+    {
+        const int DOOR_ID = adj[i];
+
+        if (steps_[DOOR_ID] == INT_MAX)
+        {
+            continue;
+        }
+
+        const int STEPS = steps_[DOOR_ID] + door_to_cell_steps(ID1, i, p1);
+
+        if (STEPS < best_steps)
+        {
+            last_door   = DOOR_ID;
+            best_steps  = STEPS;
+        }
+    }
+
+    return last_door;
+}
+
+//Walks from the position (a cell of the free area, or one of its doors) through the area to
+//the door, always to a cell one step closer to the door. The cells walked to are appended,
+//ending with the door. Returns false if the blocked array does not allow the walk.
+bool walk_to_door(const Pos& p, const int AREA_ID, const int DOOR_ID,
+                  bool blocked[MAP_W][MAP_H], std::vector<Pos>& out)
+{
+    const std::vector<int>& adj = nodes_[AREA_ID].adj;
+
+    const size_t DOOR_IDX = std::find(begin(adj), end(adj), DOOR_ID) - begin(adj);
+
+    int steps_left = node_map_[p.x][p.y] == AREA_ID ?
+                     door_to_cell_steps(AREA_ID, DOOR_IDX, p) :
+                     door_to_door_steps(AREA_ID,
+                                        DOOR_IDX,
+                                        std::find(begin(adj), end(adj), node_map_[p.x][p.y]) -
+                                        begin(adj));
+
+    const Pos& door_p = nodes_[DOOR_ID].area.p0;
+
+    Pos cur_p = p;
+
+    while (steps_left > 1)
+    {
+        bool is_step_found = false;
+
+        for (const Pos& d : dir_utils::dir_list)
+        {
+            const Pos adj_p(cur_p + d);
+
+            if (
+                node_map_[adj_p.x][adj_p.y] == AREA_ID                                  &&
+                !blocked[adj_p.x][adj_p.y]                                              &&
+                door_to_cell_steps(AREA_ID, DOOR_IDX, adj_p) == steps_left - 1)
+            {
+                cur_p = adj_p;
+                is_step_found = true;
+                break;
+            }
+        }
+
+        if (!is_step_found)
+        {
+            return false;
+        }
+
+        out.push_back(cur_p);
+
+        --steps_left;
+    }
+
+    if (blocked[door_p.x][door_p.y])
+    {
+        return false;
+    }
+
+    out.push_back(door_p);
+
+    return true;
+}
+
+//Sets the path from p1 back to p0 (not including p0) along the door route
+bool mk_path_along_door_route(const Pos& p0, const Pos& p1, const int LAST_DOOR,
+                              bool blocked[MAP_W][MAP_H], std::vector<Pos>& out)
+{
+    const int ID1 = node_map_[p1.x][p1.y];
+
+    out.clear();
+
+    if (ID1 == LAST_DOOR)
+    {
+        if (blocked[p1.x][p1.y])
+        {
+            return false;
+        }
+
+        out.push_back(p1);
+    }
+    else //The target is in a free area
+    {
+        if (blocked[p1.x][p1.y])
+        {
+            return false;
+        }
+
+        out.push_back(p1);
+
+        if (!walk_to_door(p1, ID1, LAST_DOOR, blocked, out))
+        {
+            return false;
+        }
+    }
+
+    for (int id = LAST_DOOR; prev_door_[id] != -1 || prev_area_[id] != -1; id = prev_door_[id])
+    {
+        const Pos&  door_p      = nodes_[id].area.p0;
+        const int   PREV_DOOR   = prev_door_[id];
+        const int   AREA_ID     = prev_area_[id];
+
+        if (PREV_DOOR == -1)
+        {
+            //The first door, walked to from p0 through its area (the path goes backwards, so
+            //walk from p0 and reverse)
+            std::vector<Pos> walk;
+
+            if (!walk_to_door(p0, AREA_ID, id, blocked, walk))
+            {
+                return false;
+            }
+
+            walk.pop_back();
+
+            out.insert(end(out), walk.rbegin(), walk.rend());
+
+            break;
+        }
+
+        if (AREA_ID == -1)
+        {
+            const Pos& prev_door_p = nodes_[PREV_DOOR].area.p0;
+
+            if (blocked[prev_door_p.x][prev_door_p.y])
+            {
+                return false;
+            }
+
+            out.push_back(prev_door_p);
+        }
+        else if (!walk_to_door(door_p, AREA_ID, PREV_DOOR, blocked, out))
+        {
+            return false;
+        }
+    }
+
+    //The origin is not included
+    if (!out.empty() && out.back() == p0)
+    {
+        out.pop_back();
+    }
+
+    return true;
+}
+
+} //namespace
+
+void mk_dirty(const Pos& p)
+{
+    if (is_rebuild_needed_ || is_dirty_[p.x][p.y])
+    {
+        return;
+    }
+
+    if (dirty_cells_.size() >= MAX_NR_DIRTY_CELLS)
+    {
+        is_rebuild_needed_ = true;
+        return;
+    }
+
+    is_dirty_[p.x][p.y] = true;
+    dirty_cells_.push_back(p);
+}
+
+void reset()
+{
+    is_rebuild_needed_ = true;
+}
+
+int nr_nodes()
+{
+    update();
+
+    return nr_nodes_;
+}
+
+void find_path(const Pos& p0, const Pos& p1, bool blocked[MAP_W][MAP_H],
+               std::vector<Pos>& out)
+{
+    update();
+
+    const int ID0 = node_map_[p0.x][p0.y];
+    const int ID1 = node_map_[p1.x][p1.y];
+
+    //When both positions are in the same free area, the shortest path may or may not leave
+    //the area - this is left to the cell search
+    if (ID0 != -1 && ID1 != -1 && ID0 != ID1)
+    {
+        const int LAST_DOOR = mk_door_route(p0, p1);
+
+        if (
+            LAST_DOOR != -1 &&
+            mk_path_along_door_route(p0, p1, LAST_DOOR, blocked, out))
+        {
+            return;
+        }
+    }
+
+    path_find::run(p0, p1, blocked, out);
+}
+
+} //room_graph
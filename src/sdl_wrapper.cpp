@@ -1,6 +1,7 @@
 #include "sdl_wrapper.hpp"
 
 #include <iostream>
+#include <deque>
 
 #include <SDL_image.h>
 #include <SDL_mixer.h>
@@ -19,14 +20,39 @@ namespace
 
 bool is_inited = false;
 
+SDL_threadID main_thread_id_ = 0;
+
+//Shared between the threads, only used with the mutex locked
+SDL_mutex*              mutex_      = nullptr;
+std::deque<SDL_Event>   events_;
+void                    (*main_thread_task_)() = nullptr;
+
+bool is_handled_by_game(const SDL_Event& event)
+{
+    switch (event.type)
+    {
+    case SDL_QUIT:
+    case SDL_WINDOWEVENT:
+    case SDL_KEYDOWN:
+    case SDL_TEXTINPUT:
+    case SDL_RENDER_TARGETS_RESET:
+        return true;
+
+    default:
+        return false;
+    }
 }
 
+} //namespace
+
 void init()
 {
     TRACE_FUNC_BEGIN;
 
     is_inited = true;
 
+    main_thread_id_ = SDL_ThreadID();
+
     if (SDL_Init(SDL_INIT_EVERYTHING) == -1)
     {
         TRACE << "Failed to init SDL" << endl;
@@ -52,32 +78,125 @@ void init()
 
     Mix_AllocateChannels(AUDIO_ALLOCATED_CHANNELS);
 
+    mutex_ = SDL_CreateMutex();
+
+    if (!mutex_)
+    {
+        TRACE << "Failed to create mutex" << endl;
+        assert(false);
+    }
+
     TRACE_FUNC_END;
 }
 
 void cleanup()
 {
     is_inited = false;
+
+    if (mutex_)
+    {
+        SDL_DestroyMutex(mutex_);
+        mutex_ = nullptr;
+    }
+
+    events_.clear();
+
     IMG_Quit();
     Mix_AllocateChannels(0);
     Mix_CloseAudio();
     SDL_Quit();
 }
 
-void sleep(const Uint32 DURATION)
+bool is_main_thread()
 {
-    if (is_inited && !config::is_bot_playing())
+    return SDL_ThreadID() == main_thread_id_;
+}
+
+void run_on_main_thread(void (*func)())
+{
+    if (is_main_thread())
+    {
+        func();
+        return;
+    }
+
+    SDL_LockMutex(mutex_);
+
+    assert(!main_thread_task_);
+
+    main_thread_task_ = func;
+
+    SDL_UnlockMutex(mutex_);
+
+    bool is_done = false;
+
+    while (!is_done)
     {
-        if (DURATION == 1)
+        SDL_Delay(1);
+
+        SDL_LockMutex(mutex_);
+        is_done = !main_thread_task_;
+        SDL_UnlockMutex(mutex_);
+    }
+}
+
+void run_main_thread_task()
+{
+    assert(is_main_thread());
+
+    SDL_LockMutex(mutex_);
+    void (*const func)() = main_thread_task_;
+    SDL_UnlockMutex(mutex_);
+
+    if (func)
+    {
+        func();
+
+        SDL_LockMutex(mutex_);
+        main_thread_task_ = nullptr;
+        SDL_UnlockMutex(mutex_);
+    }
+}
+
+void pump_events()
+{
+    assert(is_main_thread());
+
+    SDL_Event event;
+
+    while (SDL_PollEvent(&event))
+    {
+        if (is_handled_by_game(event))
         {
-            SDL_Delay(DURATION);
+            SDL_LockMutex(mutex_);
+            events_.push_back(event);
+            SDL_UnlockMutex(mutex_);
         }
-        else
-        {
-            const Uint32 WAIT_UNTIL = SDL_GetTicks() + DURATION;
+    }
+}
 
-            while (SDL_GetTicks() < WAIT_UNTIL) {SDL_PumpEvents();}
-        }
+bool poll_event(SDL_Event& event)
+{
+    SDL_LockMutex(mutex_);
+
+    const bool IS_ANY_EVENT = !events_.empty();
+
+    if (IS_ANY_EVENT)
+    {
+        event = events_.front();
+        events_.pop_front();
+    }
+
+    SDL_UnlockMutex(mutex_);
+
+    return IS_ANY_EVENT;
+}
+
+void sleep(const Uint32 DURATION)
+{
+    if (is_inited && !config::is_bot_playing())
+    {
+        SDL_Delay(DURATION);
     }
 }
 
@@ -39,9 +39,55 @@ namespace
 
 int nr_snd_msg_printed_cur_turn_;
 
-bool is_snd_heard_at_range(const int RANGE, const Snd& snd)
+//Sound is never heard further away than this, so the flood can stop here
+const int SND_DIST_MAX = SND_DIST_LOUD;
+
+//Distances flooded from recent sound origins. Several sounds are often emitted from the same
+//origin before the map changes (e.g. an attack, the victim crying out, and a corpse falling),
+//and these can all use the same flood.
+struct Snd_flood
+{
+    Snd_flood() :
+        origin          (-1, -1),
+        map_generation  (-1) {}
+
+    Pos origin;
+    int map_generation;
+    int vals[MAP_W][MAP_H];
+};
+
+const int NR_CACHED_FLOODS = 4;
+
+Snd_flood   floods_[NR_CACHED_FLOODS];
+int         nxt_flood_idx_ = 0;
+
+const Snd_flood& snd_flood(const Pos& origin)
+{
+    const int MAP_GENERATION = map::blockers_generation();
+
+    for (const Snd_flood& flood : floods_)
+    {
+        if (flood.origin == origin && flood.map_generation == MAP_GENERATION)
+        {
+            return flood;
+        }
+    }
+
+    Snd_flood& flood = floods_[nxt_flood_idx_];
+
+    nxt_flood_idx_ = (nxt_flood_idx_ + 1) % NR_CACHED_FLOODS;
+
+    flood_fill::run(origin, map::sound_blockers, flood.vals, SND_DIST_MAX, Pos(-1, -1), true);
+
+    flood.origin            = origin;
+    flood.map_generation    = MAP_GENERATION;
+
+    return flood;
+}
+
+int snd_max_dist(const Snd& snd)
 {
-    return snd.is_loud() ? (RANGE <= SND_DIST_LOUD) : (RANGE <= SND_DIST_NORMAL);
+    return snd.is_loud() ? SND_DIST_LOUD : SND_DIST_NORMAL;
 }
 
 } //namespace
@@ -53,30 +99,46 @@ void reset_nr_snd_msg_printed_cur_turn()
 
 void emit_snd(Snd snd)
 {
-    bool blocked[MAP_W][MAP_H];
+    const Pos&  origin          = snd.origin();
+    const int   SND_MAX_DIST    = snd_max_dist(snd);
+
+    //No flood is needed if nobody is near enough to hear the sound
+    bool is_any_actor_in_range = false;
 
-    for (int x = 0; x < MAP_W; ++x)
+    for (const Actor* const actor : game_time::actors_)
     {
-        for (int y = 0; y < MAP_H; ++y)
+        if (utils::king_dist(origin, actor->pos) <= SND_MAX_DIST)
         {
-            const auto f  = map::cells[x][y].rigid;
-            blocked[x][y] = !f->is_sound_passable();
+            is_any_actor_in_range = true;
+            break;
         }
     }
 
-    int flood_fill[MAP_W][MAP_H];
-    const Pos& origin = snd.origin();
-    flood_fill::run(origin, blocked, flood_fill, 999, Pos(-1, -1), true);
-    flood_fill[origin.x][origin.y] = 0;
+    if (!is_any_actor_in_range)
+    {
+        return;
+    }
+
+    const Snd_flood& flood = snd_flood(origin);
 
     for (Actor* actor : game_time::actors_)
     {
-        const int FLOOD_VALUE_AT_ACTOR = flood_fill[actor->pos.x][actor->pos.y];
+        const Pos& actor_pos = actor->pos;
+
+        if (utils::king_dist(origin, actor_pos) > SND_MAX_DIST)
+        {
+            continue;
+        }
+
+        const int FLOOD_VALUE_AT_ACTOR = flood.vals[actor_pos.x][actor_pos.y];
+
+        //Cells which the sound did not reach within the travel limit have the value zero
+        const bool IS_REACHED = FLOOD_VALUE_AT_ACTOR > 0 || actor_pos == origin;
 
         const bool IS_ORIGIN_SEEN_BY_PLAYER =
             map::cells[origin.x][origin.y].is_seen_by_player;
 
-        if (is_snd_heard_at_range(FLOOD_VALUE_AT_ACTOR, snd))
+        if (IS_REACHED && FLOOD_VALUE_AT_ACTOR <= SND_MAX_DIST)
         {
             if (actor->is_player())
             {
@@ -103,10 +165,8 @@ void emit_snd(Snd snd)
                     ++nr_snd_msg_printed_cur_turn_;
                 }
 
-                const int SND_MAX_DISTANCE =
-                    snd.is_loud() ? SND_DIST_LOUD : SND_DIST_NORMAL;
                 const int PERCENT_DISTANCE =
-                    (FLOOD_VALUE_AT_ACTOR * 100) / SND_MAX_DISTANCE;
+                    (FLOOD_VALUE_AT_ACTOR * 100) / SND_MAX_DIST;
 
                 const Pos offset = (origin - player_pos).signs();
                 const Dir dir_to_origin = dir_utils::dir(offset);
@@ -19,7 +19,6 @@
 #include "inventory.hpp"
 #include "map_parsing.hpp"
 #include "line_calc.hpp"
-#include "sdl_wrapper.hpp"
 #include "player_bon.hpp"
 #include "utils.hpp"
 #include "dungeon_master.hpp"
@@ -381,7 +380,7 @@ Spell_effect_noticed Spell_darkbolt::cast_impl(Actor* const caster) const
         }
 
         render::update_screen();
-        sdl_wrapper::sleep(config::delay_projectile_draw());
+        render::hold_frame(config::delay_projectile_draw());
     }
 
     render::draw_blast_at_cells({tgt->pos}, clr_magenta);
@@ -764,6 +763,7 @@ Spell_effect_noticed Spell_det_items::cast_impl(Actor* const caster) const
     if (!items_revealed_cells.empty())
     {
         render::draw_map_and_interface();
+        map::player->mk_fov_dirty();
         map::player->update_fov();
         render::draw_blast_at_cells(items_revealed_cells, clr_white);
         render::draw_map_and_interface();
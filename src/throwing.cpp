@@ -18,7 +18,6 @@
 #include "line_calc.hpp"
 #include "player_bon.hpp"
 #include "utils.hpp"
-#include "sdl_wrapper.hpp"
 #include "feature_rigid.hpp"
 #include "feature_mob.hpp"
 
@@ -74,7 +73,7 @@ void player_throw_lit_explosive(const Pos& aim_cell)
                 }
 
                 render::update_screen();
-                sdl_wrapper::sleep(config::delay_projectile_draw());
+                render::hold_frame(config::delay_projectile_draw());
             }
         }
     }
@@ -148,7 +147,7 @@ void throw_item(Actor& actor_throwing, const Pos& tgt_cell, Item& item_thrown)
                 {
                     render::draw_glyph('*', Panel::map, cur_pos, clr_red_lgt);
                     render::update_screen();
-                    sdl_wrapper::sleep(config::delay_projectile_draw() * 4);
+                    render::hold_frame(config::delay_projectile_draw() * 4);
                 }
 
                 const Clr hit_message_clr = actor_here == map::player ? clr_msg_bad : clr_msg_good;
@@ -181,7 +180,7 @@ void throw_item(Actor& actor_throwing, const Pos& tgt_cell, Item& item_thrown)
         {
             render::draw_glyph(glyph, Panel::map, cur_pos, clr);
             render::update_screen();
-            sdl_wrapper::sleep(config::delay_projectile_draw());
+            render::hold_frame(config::delay_projectile_draw());
         }
 
         const auto* feature_here = map::cells[cur_pos.x][cur_pos.y].rigid;
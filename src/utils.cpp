@@ -172,24 +172,17 @@ void reset_array(bool a[MAP_W][MAP_H], const bool value)
 
 void reverse_bool_array(bool array[MAP_W][MAP_H])
 {
-    for (int x = 0; x < MAP_W; ++x)
+    bool* const flat = &array[0][0];
+
+    for (int i = 0; i < MAP_W * MAP_H; ++i)
     {
-        for (int y = 0; y < MAP_H; ++y)
-        {
-            array[x][y] = !array[x][y];
-        }
+        flat[i] = !flat[i];
     }
 }
 
 void copy_bool_array(const bool in[MAP_W][MAP_H], bool out[MAP_W][MAP_H])
 {
-    for (int x = 0; x < MAP_W; ++x)
-    {
-        for (int y = 0; y < MAP_H; ++y)
-        {
-            out[x][y] = in[x][y];
-        }
-    }
+    std::copy(&in[0][0], &in[0][0] + (MAP_W * MAP_H), &out[0][0]);
 }
 
 void mk_vector_from_bool_map(const bool VALUE_TO_STORE, const bool a[MAP_W][MAP_H],
@@ -231,9 +224,9 @@ void actor_cells(const std::vector<Actor*>& actors, std::vector<Pos>& out)
 
 Actor* actor_at_pos(const Pos& pos, Actor_state state)
 {
-    for (auto* const actor : game_time::actors_)
+    for (auto* const actor : game_time::actors_at_pos(pos))
     {
-        if (actor->pos == pos && actor->state() == state)
+        if (actor->state() == state)
         {
             return actor;
         }
@@ -244,15 +237,9 @@ Actor* actor_at_pos(const Pos& pos, Actor_state state)
 
 Mob* first_mob_at_pos(const Pos& pos)
 {
-    for (auto* const mob : game_time::mobs_)
-    {
-        if (mob->pos() == pos)
-        {
-            return mob;
-        }
-    }
+    const auto& mobs = game_time::mobs_at_pos(pos);
 
-    return nullptr;
+    return mobs.empty() ? nullptr : mobs.front();
 }
 
 void mk_actor_array(Actor* a[MAP_W][MAP_H])
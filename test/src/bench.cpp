@@ -0,0 +1,530 @@
+#include "init.hpp"
+
+#include <climits>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <SDL.h>
+
+#include "config.hpp"
+#include "utils.hpp"
+#include "map.hpp"
+#include "actor_player.hpp"
+#include "map_gen.hpp"
+#include "map_parsing.hpp"
+#include "line_calc.hpp"
+#include "fov.hpp"
+#include "map_bits.hpp"
+#include "game_time.hpp"
+#include "room_graph.hpp"
+#include "feature_rigid.hpp"
+
+#include "prev_impl.hpp"
+
+//-----------------------------------------------------------------------------
+// Timings of performance sensitive code, built by the "Bench" target. The
+// results are only printed - correctness is checked by the unit tests.
+//-----------------------------------------------------------------------------
+namespace
+{
+
+struct Bench_session
+{
+    Bench_session()
+    {
+        init::init_game();
+        init::init_session();
+        map::player->pos = Pos(1, 1);
+        game_time::update_actor_pos(*map::player);
+        map::reset_map();
+    }
+
+    ~Bench_session()
+    {
+        init::cleanup_session();
+        init::cleanup_game();
+    }
+};
+
+//Microseconds spent running the given function
+template<typename Func>
+double time_us(Func func)
+{
+    const auto start_time = std::chrono::steady_clock::now();
+
+    func();
+
+    const auto diff_time = std::chrono::steady_clock::now() - start_time;
+
+    return std::chrono::duration<double, std::micro>(diff_time).count();
+}
+
+//Walks each line from the origin until it is blocked
+template<typename Line_ptrs>
+void walk_lines(const Pos& origin, const Line_ptrs& lines, const bool blocked[MAP_W][MAP_H],
+                int& nr_blocked)
+{
+    for (const auto& line : lines)
+    {
+        for (size_t i = 1; i < line->size(); ++i)
+        {
+            const Pos p(origin + (*line)[i]);
+
+            if (utils::is_pos_inside_map(p) && blocked[p.x][p.y])
+            {
+                ++nr_blocked;
+                break;
+            }
+        }
+    }
+}
+
+void bench_fov_delta_line_storage()
+{
+    //Walk the FOV lines from every floor cell of a generated level, using the packed lines,
+    //and using the same lines stored the previous way (one heap allocated vector per line)
+    Bench_session session;
+
+    map::dlvl = 3;
+
+    while (!map_gen::mk_std_lvl()) {}
+
+    bool blocked[MAP_W][MAP_H];
+    map_parse::run(cell_check::Blocks_los(), blocked);
+
+    const int R = FOV_STD_RADI_INT;
+
+    std::vector<const line_calc::Fov_delta_line*>   packed_lines;
+    std::vector<std::vector<Pos>>                   heap_lines;
+
+    size_t nr_steps = 0;
+
+    for (int dx = -R; dx <= R; ++dx)
+    {
+        for (int dy = -R; dy <= R; ++dy)
+        {
+            const auto* const line = line_calc::fov_delta_line(Pos(dx, dy), FOV_STD_RADI_DB);
+
+            if (line)
+            {
+                packed_lines.push_back(line);
+
+                heap_lines.push_back(std::vector<Pos>());
+
+                for (size_t i = 0; i < line->size(); ++i)
+                {
+                    heap_lines.back().push_back((*line)[i]);
+                }
+
+                nr_steps += line->size();
+            }
+        }
+    }
+
+    const size_t NR_LINES = packed_lines.size();
+
+    //The game does a lot of other things between FOV runs, so the line data is normally not
+    //in the cache. Simulate this by walking a large buffer before each timed walk.
+    std::vector<char> cache_evict_buffer(4 * 1024 * 1024, 1);
+
+    auto evict_cache = [&]()
+    {
+        for (size_t i = 0; i < cache_evict_buffer.size(); i += 64)
+        {
+            ++cache_evict_buffer[i];
+        }
+    };
+
+    std::vector<const std::vector<Pos>*> heap_line_ptrs;
+
+    for (const auto& line : heap_lines) {heap_line_ptrs.push_back(&line);}
+
+    int nr_blocked      = 0;
+    double packed_us    = 0.0;
+    double heap_us      = 0.0;
+
+    for (int x = R; x < MAP_W - R; ++x)
+    {
+        for (int y = 1; y < MAP_H - 1; ++y)
+        {
+            if (blocked[x][y]) {continue;}
+
+            const Pos origin(x, y);
+
+            evict_cache();
+            packed_us += time_us([&]() {walk_lines(origin, packed_lines, blocked, nr_blocked);});
+
+            evict_cache();
+            heap_us += time_us([&]() {walk_lines(origin, heap_line_ptrs, blocked, nr_blocked);});
+        }
+    }
+
+    std::cout << "FOV delta line storage, "
+              << NR_LINES << " lines, " << nr_steps << " steps" << std::endl
+              << "  packed: " << packed_us << " us, "
+              << (nr_steps * sizeof(line_calc::Line_step)) << " bytes of steps" << std::endl
+              << "  heap:   " << heap_us << " us, "
+              << (nr_steps * sizeof(Pos)) << " bytes of steps in "
+              << NR_LINES << " allocations" << std::endl
+              << "  " << nr_blocked << " lines blocked" << std::endl << std::endl;
+}
+
+void bench_fov_hard_multi()
+{
+    //Hard blocking FOV from a batch of light sources or monsters (as when the light map or
+    //monster LOS is recalculated), one origin at a time, and all origins in one sweep
+    Bench_session session;
+
+    map::dlvl = 3;
+
+    while (!map_gen::mk_std_lvl()) {}
+
+    bool blocked[MAP_W][MAP_H];
+    map_parse::run(cell_check::Blocks_los(), blocked);
+
+    const Map_bits blocked_bits(blocked);
+
+    std::vector<Pos> free_cells;
+    utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+    std::cout << "Hard blocking FOV, several origins" << std::endl;
+
+    for (const size_t NR_ORIGINS : {4, 16, 64})
+    {
+        const int NR_RUNS = 200;
+
+        double single_us    = 0.0;
+        double multi_us     = 0.0;
+        int    nr_seen      = 0;
+
+        std::vector<Pos>        origins;
+        std::vector<Map_bits>   fovs;
+
+        for (int run = 0; run < NR_RUNS; ++run)
+        {
+            origins.clear();
+
+            for (size_t i = 0; i < NR_ORIGINS; ++i)
+            {
+                origins.push_back(free_cells[rnd::range(0, free_cells.size() - 1)]);
+            }
+
+            single_us += time_us([&]()
+            {
+                fovs.assign(NR_ORIGINS, Map_bits());
+
+                for (size_t i = 0; i < NR_ORIGINS; ++i)
+                {
+                    fov::run_hard(origins[i], blocked, fovs[i]);
+                }
+            });
+
+            nr_seen += fovs.back().count();
+
+            multi_us += time_us([&]() {fov::run_hard_multi(origins, blocked_bits, fovs);});
+
+            nr_seen += fovs.back().count();
+        }
+
+        std::cout << "  " << NR_ORIGINS << " origins" << std::endl
+                  << "    one at a time: " << (single_us / NR_RUNS) << " us/batch" << std::endl
+                  << "    one sweep:     " << (multi_us / NR_RUNS) << " us/batch" << std::endl;
+
+        if (nr_seen == 0) {std::cout << "  (nothing seen)" << std::endl;}
+    }
+
+    std::cout << std::endl;
+}
+
+void bench_line_calc()
+{
+    //Lines from a few origins to all cells on the map, with the parameter combinations used
+    //by the game. The line cache is filled by a first untimed run.
+    Bench_session session;
+
+    const Pos origins[] = {Pos(1, 1), Pos(MAP_W_HALF, MAP_H_HALF), Pos(MAP_W - 2, 5)};
+
+    struct Line_params
+    {
+        bool    is_stopping_at_tgt;
+        int     travel_lmt;
+    };
+
+    const Line_params params[] = {{true, 9999}, {false, 9999}, {true, 3}, {false, 11}};
+
+    std::vector<Pos> line;
+
+    auto calc_all_lines = [&](const bool IS_FLOAT_REF)
+    {
+        for (const Pos& origin : origins)
+        {
+            for (const Line_params& p : params)
+            {
+                for (int x = 0; x < MAP_W; ++x)
+                {
+                    for (int y = 0; y < MAP_H; ++y)
+                    {
+                        if (IS_FLOAT_REF)
+                        {
+                            prev_impl::calc_new_line_float(origin, Pos(x, y),
+                                                           p.is_stopping_at_tgt, p.travel_lmt,
+                                                           false, line);
+                        }
+                        else
+                        {
+                            line_calc::calc_new_line(origin, Pos(x, y),
+                                                     p.is_stopping_at_tgt, p.travel_lmt,
+                                                     false, line);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    calc_all_lines(false);
+
+    const double REF_US = time_us([&]() {calc_all_lines(true);});
+    const double US     = time_us([&]() {calc_all_lines(false);});
+
+    const int NR_LINES = (sizeof(origins) / sizeof(origins[0])) *
+                         (sizeof(params) / sizeof(params[0])) * MAP_W * MAP_H;
+
+    std::cout << "Line calculation, " << NR_LINES << " lines" << std::endl
+              << "  floating point: " << int(NR_LINES / (REF_US / 1000000.0)) << " lines/s"
+              << std::endl
+              << "  cached integer: " << int(NR_LINES / (US / 1000000.0)) << " lines/s"
+              << std::endl << std::endl;
+}
+
+void bench_flood_fill()
+{
+    //The previous and current flood fill on generated maps, with and without a target and
+    //travel limit
+    Bench_session session;
+
+    int flood[MAP_W][MAP_H];
+
+    double  ref_us          = 0.0;
+    double  us              = 0.0;
+    int     nr_flood_fills  = 0;
+
+    for (int lvl = 0; lvl < 4; ++lvl)
+    {
+        map::dlvl = 1 + (lvl * 8);
+
+        while (!map_gen::mk_std_lvl()) {}
+
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+
+        std::vector<Pos> free_cells;
+        utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+        struct Flood_params
+        {
+            Pos     p0;
+            Pos     p1;
+            int     travel_lmt;
+            bool    allow_diagonal;
+        };
+
+        std::vector<Flood_params> params;
+
+        for (int i = 0; i < 100; ++i)
+        {
+            const Pos p0 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            const Pos p1 = rnd::coin_toss() ?
+                           Pos(-1, -1) :
+                           free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            const int   TRAVEL_LMT      = rnd::one_in(3) ? rnd::range(0, 12) : INT_MAX;
+            const bool  ALLOW_DIAGONAL  = rnd::coin_toss();
+
+            params.push_back({p0, p1, TRAVEL_LMT, ALLOW_DIAGONAL});
+        }
+
+        ref_us += time_us([&]()
+        {
+            for (const Flood_params& p : params)
+            {
+                prev_impl::flood_fill(p.p0, blocked, flood, p.travel_lmt, p.p1,
+                                      p.allow_diagonal);
+            }
+        });
+
+        us += time_us([&]()
+        {
+            for (const Flood_params& p : params)
+            {
+                flood_fill::run(p.p0, blocked, flood, p.travel_lmt, p.p1, p.allow_diagonal);
+            }
+        });
+
+        nr_flood_fills += int(params.size());
+    }
+
+    std::cout << "Flood fill, " << nr_flood_fills << " runs" << std::endl
+              << "  vector queue: " << (ref_us / nr_flood_fills) << " us/run" << std::endl
+              << "  fixed queue:  " << (us / nr_flood_fills) << " us/run" << std::endl
+              << std::endl;
+}
+
+void bench_path_find()
+{
+    //Flood fill and A* path finding on generated maps, mostly to nearby targets (e.g.
+    //monsters chasing the player)
+    Bench_session session;
+
+    const Path_algo algo_before = path_find::algo();
+
+    std::vector<Pos> path;
+
+    long    nr_searched_flood   = 0;
+    long    nr_searched_a_star  = 0;
+    double  flood_us            = 0.0;
+    double  a_star_us           = 0.0;
+    int     nr_paths            = 0;
+
+    for (int lvl = 0; lvl < 4; ++lvl)
+    {
+        map::dlvl = 1 + (lvl * 8);
+
+        while (!map_gen::mk_std_lvl()) {}
+
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+
+        std::vector<Pos> free_cells;
+        utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const Pos p0 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            Pos p1 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            if (rnd::fraction(2, 3))
+            {
+                const Pos d(rnd::range(-FOV_STD_RADI_INT, FOV_STD_RADI_INT),
+                            rnd::range(-FOV_STD_RADI_INT, FOV_STD_RADI_INT));
+
+                p1 = Pos(utils::constr_in_range(1, p0.x + d.x, MAP_W - 2),
+                         utils::constr_in_range(1, p0.y + d.y, MAP_H - 2));
+            }
+
+            const bool ALLOW_DIAGONAL = rnd::fraction(3, 4);
+
+            path_find::set_algo(Path_algo::flood_fill);
+
+            flood_us += time_us([&]()
+            {
+                path_find::run(p0, p1, blocked, path, ALLOW_DIAGONAL);
+            });
+
+            nr_searched_flood += path_find::nr_cells_searched();
+
+            path_find::set_algo(Path_algo::a_star);
+
+            a_star_us += time_us([&]()
+            {
+                path_find::run(p0, p1, blocked, path, ALLOW_DIAGONAL);
+            });
+
+            nr_searched_a_star += path_find::nr_cells_searched();
+
+            ++nr_paths;
+        }
+    }
+
+    path_find::set_algo(algo_before);
+
+    std::cout << "Path finding, " << nr_paths << " paths" << std::endl
+              << "  flood fill: " << (nr_searched_flood / nr_paths) << " cells/path, "
+              << (flood_us / nr_paths) << " us/path" << std::endl
+              << "  A*:         " << (nr_searched_a_star / nr_paths) << " cells/path, "
+              << (a_star_us / nr_paths) << " us/path" << std::endl << std::endl;
+}
+
+void bench_room_graph()
+{
+    //Long paths over the whole map, and planned over the room graph
+    Bench_session session;
+
+    std::vector<Pos> path;
+
+    long    len_flat    = 0;
+    long    len_graph   = 0;
+    double  flat_us     = 0.0;
+    double  graph_us    = 0.0;
+    int     nr_paths    = 0;
+    int     nr_nodes    = 0;
+
+    for (int lvl = 0; lvl < 4; ++lvl)
+    {
+        map::dlvl = 1 + (lvl * 8);
+
+        while (!map_gen::mk_std_lvl()) {}
+
+        nr_nodes += room_graph::nr_nodes();
+
+        //Like the bot travelling to the stairs - doors are allowed
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                if (map::cells[x][y].rigid->id() == Feature_id::door)
+                {
+                    blocked[x][y] = false;
+                }
+            }
+        }
+
+        std::vector<Pos> free_cells;
+        utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const Pos p0 = free_cells[rnd::range(0, free_cells.size() - 1)];
+            const Pos p1 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            flat_us += time_us([&]() {path_find::run(p0, p1, blocked, path);});
+
+            len_flat += path.size();
+
+            graph_us += time_us([&]() {room_graph::find_path(p0, p1, blocked, path);});
+
+            len_graph += path.size();
+
+            ++nr_paths;
+        }
+    }
+
+    std::cout << "Long paths, " << nr_paths << " paths, "
+              << (nr_nodes / 4) << " graph nodes per level" << std::endl
+              << "  whole map:  " << (double(len_flat) / nr_paths) << " steps/path, "
+              << (flat_us / nr_paths) << " us/path" << std::endl
+              << "  room graph: " << (double(len_graph) / nr_paths) << " steps/path, "
+              << (graph_us / nr_paths) << " us/path" << std::endl << std::endl;
+}
+
+} //namespace
+
+#ifdef _WIN32
+#undef main
+#endif
+int main()
+{
+    bench_fov_delta_line_storage();
+    bench_fov_hard_multi();
+    bench_line_calc();
+    bench_flood_fill();
+    bench_path_find();
+    bench_room_graph();
+    return 0;
+}
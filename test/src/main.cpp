@@ -3,6 +3,7 @@
 #include "UnitTest++.h"
 
 #include <climits>
+#include <algorithm>
 #include <string>
 
 #include <SDL.h>
@@ -33,6 +34,14 @@
 #include "feature_Trap.hpp"
 #include "drop.hpp"
 #include "map_Travel.hpp"
+#include "feature_door.hpp"
+#include "feature_mob.hpp"
+#include "game_time.hpp"
+#include "ai.hpp"
+#include "room_graph.hpp"
+#include "sound.hpp"
+
+#include "prev_impl.hpp"
 
 struct Basic_fixture
 {
@@ -41,6 +50,7 @@ struct Basic_fixture
         init::init_game();
         init::init_session();
         map::player->pos = Pos(1, 1);
+        game_time::update_actor_pos(*map::player);
         map::reset_map(); //Because map generation is not run
     }
 
@@ -317,7 +327,8 @@ TEST_FIXTURE(Basic_fixture, line_calculation)
     CHECK(line[2] == Pos(2, 0));
 
     //Test precalculated FOV line offsets
-    const std::vector<Pos>* delta_line = line_calc::fov_delta_line(Pos(3, 3), FOV_STD_RADI_DB);
+    const line_calc::Fov_delta_line* delta_line =
+        line_calc::fov_delta_line(Pos(3, 3), FOV_STD_RADI_DB);
     CHECK(delta_line->size() == 4);
     CHECK(delta_line->at(0) == Pos(0, 0));
     CHECK(delta_line->at(1) == Pos(1, 1));
@@ -354,6 +365,43 @@ TEST_FIXTURE(Basic_fixture, line_calculation)
     CHECK(!delta_line);
 }
 
+TEST_FIXTURE(Basic_fixture, fov_delta_lines)
+{
+    //The packed FOV lines must have the same steps as lines calculated from the origin
+    const int R = FOV_STD_RADI_INT;
+
+    std::vector<Pos> line;
+
+    int nr_lines = 0;
+
+    for (int dx = -R; dx <= R; ++dx)
+    {
+        for (int dy = -R; dy <= R; ++dy)
+        {
+            const Pos delta(dx, dy);
+
+            const auto* const delta_line = line_calc::fov_delta_line(delta, FOV_STD_RADI_DB);
+
+            if (!delta_line) {continue;}
+
+            ++nr_lines;
+
+            line_calc::calc_new_line(Pos(0, 0), delta, true, 999, true, line);
+
+            CHECK_EQUAL(line.size(), delta_line->size());
+
+            if (line.size() != delta_line->size()) {continue;}
+
+            for (size_t i = 0; i < line.size(); ++i)
+            {
+                CHECK(delta_line->at(i) == line[i]);
+            }
+        }
+    }
+
+    CHECK(nr_lines > 0);
+}
+
 TEST_FIXTURE(Basic_fixture, fov)
 {
     bool blocked[MAP_W][MAP_H];
@@ -364,6 +412,7 @@ TEST_FIXTURE(Basic_fixture, fov)
     const int Y = MAP_H_HALF;
 
     map::player->pos = Pos(X, Y);
+    game_time::update_actor_pos(*map::player);
 
     Los_result fov[MAP_W][MAP_H];
 
@@ -404,770 +453,2273 @@ TEST_FIXTURE(Basic_fixture, fov)
     CHECK(fov[X - R + 1][Y + R - 1].is_blocked_hard);
 }
 
-TEST_FIXTURE(Basic_fixture, throw_items)
+TEST_FIXTURE(Basic_fixture, fov_algos_give_same_result)
 {
-    //-----------------------------------------------------------------
-    // Throwing a throwing knife at a wall should make it land
-    // in front of the wall - i.e. the cell it travelled through
-    // before encountering the wall.
-    //
-    // . <- (5, 7)
-    // # <- If aiming at wall here... (5, 8)
-    // . <- ...throwing knife should finally land here (5, 9)
-    // @ <- Player position (5, 10).
-    //-----------------------------------------------------------------
-
-    map::put(new Floor(Pos(5, 7)));
-    map::put(new Floor(Pos(5, 9)));
-    map::put(new Floor(Pos(5, 10)));
-    map::player->pos = Pos(5, 10);
-    Pos tgt(5, 8);
-    Item* item = item_factory::mk(Item_id::thr_knife);
-    throwing::throw_item(*(map::player), tgt, *item);
-    CHECK(map::cells[5][9].item);
-}
+    //Differential test - the ray sweep must give exactly the same result as checking the
+    //line to each cell separately, on generated levels with random darkness and light
+    const Fov_algo algo_before = fov::algo();
 
-TEST_FIXTURE(Basic_fixture, explosions)
-{
-    const int X0 = 5;
-    const int Y0 = 7;
+    Los_result fov_cell_lines[MAP_W][MAP_H];
+    Los_result fov_ray_sweep[MAP_W][MAP_H];
 
-    //auto* const floor = new Floor(Pos(X0, Y0));
-    map::put(new Floor(Pos(X0, Y0)));
+    int nr_diffs = 0;
 
-    //Check wall destruction
-    for (int i = 0; i < 2; ++i)
+    for (int i = 0; i < 4; ++i)
     {
-        explosion::run_explosion_at(Pos(X0, Y0), Expl_type::expl);
+        map::dlvl = 1 + (i * 4);
 
-        //Cells around the center, at a distance of 1, should be destroyed
-        int r = 1;
-        CHECK(map::cells[X0 + r][Y0    ].rigid->id() != Feature_id::wall);
-        CHECK(map::cells[X0 - r][Y0    ].rigid->id() != Feature_id::wall);
-        CHECK(map::cells[X0    ][Y0 + r].rigid->id() != Feature_id::wall);
-        CHECK(map::cells[X0    ][Y0 - r].rigid->id() != Feature_id::wall);
-        CHECK(map::cells[X0 + r][Y0 + r].rigid->id() != Feature_id::wall);
-        CHECK(map::cells[X0 + r][Y0 - r].rigid->id() != Feature_id::wall);
-        CHECK(map::cells[X0 - r][Y0 + r].rigid->id() != Feature_id::wall);
-        CHECK(map::cells[X0 - r][Y0 - r].rigid->id() != Feature_id::wall);
+        while (!map_gen::mk_std_lvl()) {}
 
-        //Cells around the center, at a distance of 2, should NOT be destroyed
-        r = 2;
-        CHECK(map::cells[X0 + r][Y0    ].rigid->id() == Feature_id::wall);
-        CHECK(map::cells[X0 - r][Y0    ].rigid->id() == Feature_id::wall);
-        CHECK(map::cells[X0    ][Y0 + r].rigid->id() == Feature_id::wall);
-        CHECK(map::cells[X0    ][Y0 - r].rigid->id() == Feature_id::wall);
-        CHECK(map::cells[X0 + r][Y0 + r].rigid->id() == Feature_id::wall);
-        CHECK(map::cells[X0 + r][Y0 - r].rigid->id() == Feature_id::wall);
-        CHECK(map::cells[X0 - r][Y0 + r].rigid->id() == Feature_id::wall);
-        CHECK(map::cells[X0 - r][Y0 - r].rigid->id() == Feature_id::wall);
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                map::cells[x][y].is_dark = rnd::one_in(3);
+                map::cells[x][y].is_lit  = rnd::one_in(5);
+            }
+        }
+
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_los(), blocked);
+
+        for (int x = 1; x < MAP_W - 1; ++x)
+        {
+            for (int y = 1; y < MAP_H - 1; ++y)
+            {
+                if (blocked[x][y] && !rnd::one_in(10))
+                {
+                    continue;
+                }
+
+                const Pos p0(x, y);
+
+                fov::set_algo(Fov_algo::cell_lines);
+                fov::run(p0, blocked, fov_cell_lines);
+
+                fov::set_algo(Fov_algo::ray_sweep);
+                fov::run(p0, blocked, fov_ray_sweep);
+
+                for (int cmp_x = 0; cmp_x < MAP_W; ++cmp_x)
+                {
+                    for (int cmp_y = 0; cmp_y < MAP_H; ++cmp_y)
+                    {
+                        const Los_result& l0 = fov_cell_lines[cmp_x][cmp_y];
+                        const Los_result& l1 = fov_ray_sweep[cmp_x][cmp_y];
+
+                        if (
+                            l0.is_blocked_hard   != l1.is_blocked_hard ||
+                            l0.is_blocked_by_drk != l1.is_blocked_by_drk)
+                        {
+                            ++nr_diffs;
+                        }
+                    }
+                }
+            }
+        }
     }
 
-    //Check damage to actors
-    Actor* a1 = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
-    explosion::run_explosion_at(Pos(X0, Y0), Expl_type::expl);
-    CHECK_EQUAL(int(Actor_state::destroyed), int(a1->state()));
+    CHECK_EQUAL(0, nr_diffs);
 
-    //Check that corpses can be destroyed, and do not block living actors
-    const int NR_CORPSES = 3;
-    Actor* corpses[NR_CORPSES];
+    fov::set_algo(algo_before);
+}
 
-    for (int i = 0; i < NR_CORPSES; ++i)
-    {
-        corpses[i] = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
-        corpses[i]->die(false, false, false);
-    }
+TEST_FIXTURE(Basic_fixture, fov_radius)
+{
+    //Both FOV algorithms must agree for all radii, and nothing outside the radius is seen
+    const Fov_algo algo_before = fov::algo();
 
-    a1 = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
-    explosion::run_explosion_at(Pos(X0, Y0), Expl_type::expl);
+    map::dlvl = 5;
 
-    for (int i = 0; i < NR_CORPSES; ++i)
-    {
-        CHECK_EQUAL(int(Actor_state::destroyed), int(corpses[i]->state()));
-    }
+    while (!map_gen::mk_std_lvl()) {}
 
-    CHECK_EQUAL(int(Actor_state::destroyed), int(a1->state()));
+    bool blocked[MAP_W][MAP_H];
+    map_parse::run(cell_check::Blocks_los(), blocked);
 
-    //Check explosion applying Burning to living and dead actors
-    a1        = actor_factory::mk(Actor_id::rat, Pos(X0 - 1, Y0));
-    Actor* a2 = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
+    Los_result fov_cell_lines[MAP_W][MAP_H];
+    Los_result fov_ray_sweep[MAP_W][MAP_H];
 
-    for (int i = 0; i < NR_CORPSES; ++i)
+    int nr_diffs        = 0;
+    int nr_outside_radi = 0;
+
+    for (const int R : {1, 3, FOV_STD_RADI_INT, 12, FOV_MAX_RADI_INT})
     {
-        corpses[i] = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
-        corpses[i]->die(false, false, false);
-    }
+        for (int i = 0; i < 40; ++i)
+        {
+            const Pos p0(rnd::range(1, MAP_W - 2), rnd::range(1, MAP_H - 2));
 
-    explosion::run_explosion_at(Pos(X0, Y0), Expl_type::apply_prop, Expl_src::misc,
-                                Emit_expl_snd::no, 0, new Prop_burning(Prop_turns::std));
-    CHECK(a1->prop_handler().prop(Prop_id::burning));
-    CHECK(a2->prop_handler().prop(Prop_id::burning));
+            fov::set_algo(Fov_algo::cell_lines);
+            fov::run(p0, blocked, fov_cell_lines, R);
 
-    CHECK(a1->has_prop(Prop_id::burning));
-    CHECK(a2->has_prop(Prop_id::burning));
+            fov::set_algo(Fov_algo::ray_sweep);
+            fov::run(p0, blocked, fov_ray_sweep, R);
 
-    for (int i = 0; i < NR_CORPSES; ++i)
-    {
-        Prop_handler& prop_hlr = corpses[i]->prop_handler();
-        CHECK(prop_hlr.prop(Prop_id::burning));
-        CHECK(prop_hlr.has_prop(Prop_id::burning));
+            for (int x = 0; x < MAP_W; ++x)
+            {
+                for (int y = 0; y < MAP_H; ++y)
+                {
+                    const Los_result& l0 = fov_cell_lines[x][y];
+                    const Los_result& l1 = fov_ray_sweep[x][y];
+
+                    if (
+                        l0.is_blocked_hard   != l1.is_blocked_hard ||
+                        l0.is_blocked_by_drk != l1.is_blocked_by_drk)
+                    {
+                        ++nr_diffs;
+                    }
+
+                    if (!l1.is_blocked_hard && !fov::is_in_fov_range(p0, Pos(x, y), R))
+                    {
+                        ++nr_outside_radi;
+                    }
+                }
+            }
+        }
     }
 
-    //Check that the explosion can handle the map edge (e.g. that it does not
-    //destroy the edge wall, or go outside the map - possibly causing a crash)
-
-    //North-west edge
-    int x = 1;
-    int y = 1;
-    map::put(new Floor(Pos(x, y)));
-    explosion::run_explosion_at(Pos(x, y), Expl_type::expl);
-    CHECK(map::cells[x + 1][y    ].rigid->id() != Feature_id::wall);
-    CHECK(map::cells[x    ][y + 1].rigid->id() != Feature_id::wall);
-    CHECK(map::cells[x - 1][y    ].rigid->id() == Feature_id::wall);
-    CHECK(map::cells[x    ][y - 1].rigid->id() == Feature_id::wall);
+    CHECK_EQUAL(0, nr_diffs);
+    CHECK_EQUAL(0, nr_outside_radi);
 
-    //South-east edge
-    x = MAP_W - 2;
-    y = MAP_H - 2;
-    map::put(new Floor(Pos(x, y)));
-    explosion::run_explosion_at(Pos(x, y), Expl_type::expl);
-    CHECK(map::cells[x - 1][y    ].rigid->id() != Feature_id::wall);
-    CHECK(map::cells[x    ][y - 1].rigid->id() != Feature_id::wall);
-    CHECK(map::cells[x + 1][y    ].rigid->id() == Feature_id::wall);
-    CHECK(map::cells[x    ][y + 1].rigid->id() == Feature_id::wall);
+    fov::set_algo(algo_before);
 }
 
-TEST_FIXTURE(Basic_fixture, monster_stuck_in_spider_web)
+TEST_FIXTURE(Basic_fixture, fov_hard)
 {
-    //-----------------------------------------------------------------
-    // Test that-
-    // * a monster can get stuck in a spider web,
-    // * the monster can get loose, and
-    // * the web can get destroyed
-    //-----------------------------------------------------------------
+    //The hard blocking FOV must give the same hard blocking as the full FOV
+    const Fov_algo algo_before = fov::algo();
 
-    const Pos pos_l(1, 4);
-    const Pos pos_r(2, 4);
+    map::dlvl = 5;
 
-    //Spawn left floor cell
-    map::put(new Floor(pos_l));
+    while (!map_gen::mk_std_lvl()) {}
 
-    //Conditions for finished test
-    bool tested_stuck               = false;
-    bool tested_loose_web_interact  = false;
-    bool tested_loose_web_destroyed = false;
+    bool blocked[MAP_W][MAP_H];
+    map_parse::run(cell_check::Blocks_los(), blocked);
 
-    while (!tested_stuck || !tested_loose_web_interact || !tested_loose_web_destroyed)
+    std::vector<Pos> origins;
+
+    for (int x = 1; x < MAP_W - 1; x += 3)
     {
+        for (int y = 1; y < MAP_H - 1; y += 2)
+        {
+            origins.push_back(Pos(x, y));
+        }
+    }
 
-        //Spawn right floor cell
-        map::put(new Floor(pos_r));
+    Los_result  fov[MAP_W][MAP_H];
+    int         nr_diffs = 0;
 
-        //Spawn a monster that can get stuck in the web
-        Actor* const actor = actor_factory::mk(Actor_id::zombie, pos_l);
-        Mon* const mon = static_cast<Mon*>(actor);
+    for (const Fov_algo algo : {Fov_algo::cell_lines, Fov_algo::ray_sweep})
+    {
+        fov::set_algo(algo);
 
-        //Create a spider web in the right cell
-        const auto  mimicId     = map::cells[pos_r.x][pos_r.x].rigid->id();
-        const auto& mimic_data  = feature_data::data(mimicId);
-        const auto* const mimic = static_cast<const Rigid*>(mimic_data.mk_obj(pos_r));
-        map::put(new Trap(pos_r, mimic, Trap_id::web));
+        Map_bits all_unblocked;
 
-        //Move the monster into the trap, and back again
-        mon->aware_counter_ = 20000; // > 0 req. for triggering trap
-        mon->pos = pos_l;
-        mon->move(Dir::right);
-        CHECK(mon->pos == pos_r);
-        mon->move(Dir::left);
-        mon->move(Dir::left);
+        bool is_any_unblocked[MAP_W][MAP_H] = {};
 
-        //Check conditions
-        if (mon->pos == pos_r)
-        {
-            tested_stuck = true;
-        }
-        else if (mon->pos == pos_l)
+        for (const Pos& origin : origins)
         {
-            const auto featureId = map::cells[pos_r.x][pos_r.y].rigid->id();
+            Map_bits fov_hard;
 
-            if (featureId == Feature_id::floor)
+            fov::run_hard(origin, blocked, fov_hard);
+
+            fov::run(origin, blocked, fov);
+
+            for (int x = 0; x < MAP_W; ++x)
             {
-                tested_loose_web_destroyed = true;
+                for (int y = 0; y < MAP_H; ++y)
+                {
+                    if (fov_hard.at(x, y) == fov[x][y].is_blocked_hard)
+                    {
+                        ++nr_diffs;
+                    }
+
+                    if (fov_hard.at(x, y))
+                    {
+                        is_any_unblocked[x][y] = true;
+                    }
+                }
             }
-            else
+
+            //Running for several origins on the same output gives the union
+            fov::run_hard(origin, blocked, all_unblocked);
+        }
+
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
             {
-                tested_loose_web_interact = true;
+                if (all_unblocked.at(x, y) != is_any_unblocked[x][y])
+                {
+                    ++nr_diffs;
+                }
             }
         }
-
-        //Remove the monster
-        actor_factory::delete_all_mon();
     }
 
-    //Check that all cases have been triggered (not really necessary, it just
-    //verifies that the loop above is correctly written).
-    CHECK(tested_stuck);
-    CHECK(tested_loose_web_interact);
-    CHECK(tested_loose_web_destroyed);
+    CHECK_EQUAL(0, nr_diffs);
+
+    fov::set_algo(algo_before);
 }
 
-TEST_FIXTURE(Basic_fixture, inventory_handling)
+TEST_FIXTURE(Basic_fixture, fov_hard_multi)
 {
-    const Pos p(10, 10);
-    map::put(new Floor(p));
-    map::player->pos = p;
+    //Running the hard blocking FOV for many origins at once must give the same result as
+    //running it for each origin (with more origins than fit in one sweep)
+    map::dlvl = 5;
 
-    Inventory&  inv         = map::player->inv();
-    Inv_slot&   body_slot   = inv.slots_[size_t(Slot_id::body)];
+    while (!map_gen::mk_std_lvl()) {}
 
-    delete body_slot.item;
-    body_slot.item = nullptr;
+    bool blocked[MAP_W][MAP_H];
+    map_parse::run(cell_check::Blocks_los(), blocked);
 
-    Prop_handler& prop_hlr = map::player->prop_handler();
+    std::vector<Pos> origins;
 
-    //Check that no props are enabled
-    for (size_t i = 0; i < size_t(Prop_id::END); ++i)
+    for (int i = 0; i < 150; ++i)
     {
-        CHECK(!prop_hlr.has_prop(Prop_id(i)));
-        CHECK(!prop_hlr.prop(Prop_id(i)));
+        origins.push_back(Pos(rnd::range(0, MAP_W - 1), rnd::range(0, MAP_H - 1)));
     }
 
-    //Wear asbesthos suit
-    Item* item = item_factory::mk(Item_id::armor_asb_suit);
+    int nr_diffs = 0;
 
-    inv.put_in_slot(Slot_id::body, item);
+    for (const int R : {1, FOV_STD_RADI_INT, FOV_MAX_RADI_INT})
+    {
+        std::vector<Map_bits> fovs;
 
-    //Check that the props are applied
-    size_t nr_props = 0;
+        fov::run_hard_multi(origins, Map_bits(blocked), fovs, R);
 
-    for (size_t i = 0; i < size_t(Prop_id::END); ++i)
-    {
-        if (prop_hlr.has_prop(Prop_id(i)))
+        CHECK_EQUAL(origins.size(), fovs.size());
+
+        for (size_t i = 0; i < origins.size(); ++i)
         {
-            CHECK(prop_hlr.prop(Prop_id(i)));
-            ++nr_props;
+            Map_bits fov_expected;
+
+            fov::run_hard(origins[i], blocked, fov_expected, R);
+
+            for (int x = 0; x < MAP_W; ++x)
+            {
+                for (int y = 0; y < MAP_H; ++y)
+                {
+                    if (fovs[i].at(x, y) != fov_expected.at(x, y))
+                    {
+                        ++nr_diffs;
+                    }
+                }
+            }
         }
     }
 
-    CHECK_EQUAL(4, int(nr_props));
+    CHECK_EQUAL(0, nr_diffs);
+}
 
-    CHECK(prop_hlr.prop(Prop_id::rFire));
-    CHECK(prop_hlr.prop(Prop_id::rElec));
-    CHECK(prop_hlr.prop(Prop_id::rAcid));
-    CHECK(prop_hlr.prop(Prop_id::rBreath));
+TEST_FIXTURE(Basic_fixture, player_fov_cache)
+{
+    //The player FOV is only recalculated when something has changed which may affect it.
+    //Compare the result of each update with a forced full recalculation, while moving the
+    //player, replacing features, opening doors, and adding and removing mobs.
+    bool    seen[MAP_W][MAP_H];
+    bool    explored[MAP_W][MAP_H];
+    bool    blocked_hard[MAP_W][MAP_H];
+    int     nr_diffs = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        map::dlvl = 1 + (i * 4);
 
-    CHECK(prop_hlr.has_prop(Prop_id::rFire));
-    CHECK(prop_hlr.has_prop(Prop_id::rElec));
-    CHECK(prop_hlr.has_prop(Prop_id::rAcid));
-    CHECK(prop_hlr.has_prop(Prop_id::rBreath));
+        while (!map_gen::mk_std_lvl()) {}
 
-    //Take off asbeshos suit
-    inv.try_unequip_slot(Slot_id::body);
+        for (int step = 0; step < 400; ++step)
+        {
+            const Pos player_pos = map::player->pos;
 
-    CHECK(inv.backpack_idx(Item_id::armor_asb_suit) != -1);
+            const Pos p(rnd::range(std::max(1, player_pos.x - 10),
+                                   std::min(MAP_W - 2, player_pos.x + 10)),
+                        rnd::range(std::max(1, player_pos.y - 10),
+                                   std::min(MAP_H - 2, player_pos.y + 10)));
 
-    //Check that the properties are cleared
-    for (int i = 0; i < int(Prop_id::END); ++i)
-    {
-        CHECK(!prop_hlr.has_prop(Prop_id(i)));
-        CHECK(!prop_hlr.prop(Prop_id(i)));
+            Rigid* const rigid = map::cells[p.x][p.y].rigid;
+
+            switch (rnd::range(1, 6))
+            {
+            case 1:
+                if (rigid->id() == Feature_id::floor)
+                {
+                    map::player->pos = p;
+                    game_time::update_actor_pos(*map::player);
+                }
+                break;
+
+            case 2:
+                if (p != player_pos)
+                {
+                    if (rnd::coin_toss())
+                    {
+                        map::put(new Wall(p));
+                    }
+                    else
+                    {
+                        map::put(new Floor(p));
+                    }
+                }
+                break;
+
+            case 3:
+                if (rigid->id() == Feature_id::door)
+                {
+                    static_cast<Door*>(rigid)->open(nullptr);
+                }
+                break;
+
+            case 4:
+                game_time::add_mob(new Smoke(p, 10));
+                break;
+
+            case 5:
+                if (!game_time::mobs_.empty())
+                {
+                    game_time::erase_mob(game_time::mobs_.front(), true);
+                }
+                break;
+
+            default: //Nothing changed
+                break;
+            }
+
+            map::player->update_fov();
+
+            for (int x = 0; x < MAP_W; ++x)
+            {
+                for (int y = 0; y < MAP_H; ++y)
+                {
+                    const Cell& cell    = map::cells[x][y];
+                    seen[x][y]          = cell.is_seen_by_player;
+                    explored[x][y]      = cell.is_explored;
+                    blocked_hard[x][y]  = cell.player_los.is_blocked_hard;
+                }
+            }
+
+            map::player->mk_fov_dirty();
+            map::player->update_fov();
+
+            for (int x = 0; x < MAP_W; ++x)
+            {
+                for (int y = 0; y < MAP_H; ++y)
+                {
+                    const Cell& cell = map::cells[x][y];
+
+                    if (
+                        seen[x][y]          != cell.is_seen_by_player ||
+                        explored[x][y]      != cell.is_explored       ||
+                        blocked_hard[x][y]  != cell.player_los.is_blocked_hard)
+                    {
+                        ++nr_diffs;
+                    }
+                }
+            }
+        }
     }
 
-    //Wear the asbeshos suit again
-    inv.equip_backpack_item(inv.backpack_idx(Item_id::armor_asb_suit), Slot_id::body);
+    CHECK_EQUAL(0, nr_diffs);
 
-    game_time::tick();
+    game_time::erase_all_mobs();
+}
 
-    //Check that the props are applied
-    nr_props = 0;
+TEST_FIXTURE(Basic_fixture, los_cache)
+{
+    //Cached LOS results must be the same as checking the line on the current map, while
+    //features are replaced, doors are opened, and mobs are added and removed
+    int nr_diffs = 0;
 
-    for (int i = 0; i < int(Prop_id::END); ++i)
+    map::dlvl = 5;
+
+    while (!map_gen::mk_std_lvl()) {}
+
+    for (int step = 0; step < 200; ++step)
     {
-        if (prop_hlr.has_prop(Prop_id(i)))
+        const Pos p(rnd::range(1, MAP_W - 2), rnd::range(1, MAP_H - 2));
+
+        Rigid* const rigid = map::cells[p.x][p.y].rigid;
+
+        switch (rnd::range(1, 4))
         {
-            CHECK(prop_hlr.prop(Prop_id(i)));
-            ++nr_props;
+        case 1:
+            if (rnd::coin_toss())
+            {
+                map::put(new Wall(p));
+            }
+            else
+            {
+                map::put(new Floor(p));
+            }
+            break;
+
+        case 2:
+            if (rigid->id() == Feature_id::door)
+            {
+                static_cast<Door*>(rigid)->open(nullptr);
+            }
+            break;
+
+        case 3:
+            game_time::add_mob(new Smoke(p, 10));
+            break;
+
+        default:
+            if (!game_time::mobs_.empty())
+            {
+                game_time::erase_mob(game_time::mobs_.front(), true);
+            }
+            break;
+        }
+
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_los(), blocked);
+
+        std::vector<Pos> origins;
+
+        for (int i = 0; i < 12; ++i)
+        {
+            origins.push_back(Pos(rnd::range(1, MAP_W - 2), rnd::range(1, MAP_H - 2)));
+        }
+
+        //The LOS from half of the origins is prepared together, the rest is checked per line
+        fov::prepare_los_on_map(std::vector<Pos>(begin(origins), begin(origins) + 6));
+
+        //Look up each result twice, so that cached results are also checked
+        for (const Pos& p0 : origins)
+        {
+            for (int dx = -FOV_STD_RADI_INT; dx <= FOV_STD_RADI_INT; ++dx)
+            {
+                for (int dy = -FOV_STD_RADI_INT; dy <= FOV_STD_RADI_INT; ++dy)
+                {
+                    const Pos p1(p0 + Pos(dx, dy));
+
+                    const Los_result l0 = fov::check_cell(p0, p1, blocked);
+
+                    for (int j = 0; j < 2; ++j)
+                    {
+                        const Los_result l1 = fov::check_cell_on_map(p0, p1);
+
+                        if (
+                            l0.is_blocked_hard   != l1.is_blocked_hard ||
+                            l0.is_blocked_by_drk != l1.is_blocked_by_drk)
+                        {
+                            ++nr_diffs;
+                        }
+                    }
+                }
+            }
         }
     }
 
-    CHECK_EQUAL(4, int(nr_props));
+    CHECK_EQUAL(0, nr_diffs);
 
-    CHECK(prop_hlr.prop(Prop_id::rFire));
-    CHECK(prop_hlr.prop(Prop_id::rElec));
-    CHECK(prop_hlr.prop(Prop_id::rAcid));
-    CHECK(prop_hlr.prop(Prop_id::rBreath));
+    game_time::erase_all_mobs();
+}
 
-    CHECK(prop_hlr.has_prop(Prop_id::rFire));
-    CHECK(prop_hlr.has_prop(Prop_id::rElec));
-    CHECK(prop_hlr.has_prop(Prop_id::rAcid));
-    CHECK(prop_hlr.has_prop(Prop_id::rBreath));
+TEST_FIXTURE(Basic_fixture, blocker_layers)
+{
+    //The cell traits and live blocker layers must always be the same as checking each rigid
+    //and mob, while levels are generated, features are replaced, doors are opened, and mobs
+    //are added and removed
+    const cell_check::Blocks_los         blocks_los;
+    const cell_check::Blocks_move_cmn    blocks_move(false);
+    const cell_check::Blocks_projectiles blocks_projectiles;
 
-    //Drop the asbeshos suit on the ground
-    item_drop::try_drop_item_from_inv(*map::player, Inv_type::slots, int(Slot_id::body), 1);
+    int nr_diffs = 0;
 
-    //Check that no item exists in body slot
-    CHECK(!body_slot.item);
+    auto check_layers = [&]()
+    {
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                const Cell&     cell    = map::cells[x][y];
+                const Rigid&    rigid   = *cell.rigid;
+                const bool      IS_EDGE = !utils::is_pos_inside_map(Pos(x, y), false);
+
+                bool is_los_blocked         = IS_EDGE || !rigid.is_los_passable();
+                bool is_move_blocked        = IS_EDGE || !rigid.can_move_cmn();
+                bool is_projectile_blocked  = IS_EDGE || !rigid.is_projectile_passable();
+
+                if (
+                    cell.has_trait(cell_trait::blocks_los)          != is_los_blocked           ||
+                    cell.has_trait(cell_trait::blocks_move_cmn)     != is_move_blocked          ||
+                    cell.has_trait(cell_trait::blocks_projectiles)  != is_projectile_blocked    ||
+                    cell.has_trait(cell_trait::blocks_sound)        != !rigid.is_sound_passable())
+                {
+                    ++nr_diffs;
+                }
+
+                for (const Mob* const mob : game_time::mobs_)
+                {
+                    if (mob->pos() == Pos(x, y))
+                    {
+                        is_los_blocked          |= blocks_los.check(*mob);
+                        is_move_blocked         |= blocks_move.check(*mob);
+                        is_projectile_blocked   |= blocks_projectiles.check(*mob);
+                    }
+                }
+
+                if (
+                    map::los_blockers[x][y]         != is_los_blocked   ||
+                    map::move_cmn_blockers[x][y]    != is_move_blocked  ||
+                    map::projectile_blockers[x][y]  != is_projectile_blocked)
+                {
+                    ++nr_diffs;
+                }
+            }
+        }
+    };
 
-    //Check that the item is on the ground
-    Cell& cell = map::cells[p.x][p.y];
-    CHECK(cell.item);
+    for (int lvl = 0; lvl < 3; ++lvl)
+    {
+        map::dlvl = 1 + (lvl * 10);
 
-    //Check that the properties are cleared
-    for (int i = 0; i < int(Prop_id::END); ++i)
+        while (!map_gen::mk_std_lvl()) {}
+
+        check_layers();
+
+        for (int step = 0; step < 100; ++step)
+        {
+            const Pos p(rnd::range(1, MAP_W - 2), rnd::range(1, MAP_H - 2));
+
+            Rigid* const rigid = map::cells[p.x][p.y].rigid;
+
+            switch (rnd::range(1, 4))
+            {
+            case 1:
+                if (rnd::coin_toss())
+                {
+                    map::put(new Wall(p));
+                }
+                else
+                {
+                    map::put(new Floor(p));
+                }
+                break;
+
+            case 2:
+                if (rigid->id() == Feature_id::door)
+                {
+                    static_cast<Door*>(rigid)->open(nullptr);
+                }
+                break;
+
+            case 3:
+                game_time::add_mob(new Smoke(p, 10));
+                break;
+
+            default:
+                if (!game_time::mobs_.empty())
+                {
+                    game_time::erase_mob(game_time::mobs_.front(), true);
+                }
+                break;
+            }
+
+            check_layers();
+        }
+    }
+
+    CHECK_EQUAL(0, nr_diffs);
+}
+
+TEST_FIXTURE(Basic_fixture, lgt_cache)
+{
+    //Cached light must be the same as the cells not hard blocked from the light source,
+    //while features are replaced, doors are opened, and mobs are added and removed
+    int nr_diffs = 0;
+
+    map::dlvl = 5;
+
+    while (!map_gen::mk_std_lvl()) {}
+
+    //A few light sources, which are used repeatedly
+    std::vector<Pos> origins;
+
+    for (int i = 0; i < 8; ++i)
     {
-        CHECK(!prop_hlr.has_prop(Prop_id(i)));
-        CHECK(!prop_hlr.prop(Prop_id(i)));
+        origins.push_back(Pos(rnd::range(1, MAP_W - 2), rnd::range(1, MAP_H - 2)));
     }
 
-    //Wear the same dropped asbesthos suit again
-    inv.put_in_slot(Slot_id::body, cell.item);
+    for (int step = 0; step < 200; ++step)
+    {
+        const Pos p(rnd::range(1, MAP_W - 2), rnd::range(1, MAP_H - 2));
 
-    cell.item = nullptr;
+        Rigid* const rigid = map::cells[p.x][p.y].rigid;
 
-    //Check that the props are applied
-    nr_props = 0;
+        switch (rnd::range(1, 5))
+        {
+        case 1:
+            map::put(new Wall(p));
+            break;
 
-    for (int i = 0; i < int(Prop_id::END); ++i)
+        case 2:
+            map::put(new Floor(p));
+            break;
+
+        case 3:
+            if (rigid->id() == Feature_id::door)
+            {
+                static_cast<Door*>(rigid)->open(nullptr);
+            }
+            break;
+
+        case 4:
+            game_time::add_mob(new Smoke(p, 10));
+            break;
+
+        default:
+            if (!game_time::mobs_.empty())
+            {
+                game_time::erase_mob(game_time::mobs_.front(), true);
+            }
+            break;
+        }
+
+        //Every other step, the light of all origins is added in one batch
+        const bool IS_BATCH = step % 2 == 0;
+
+        std::vector<Map_bits> lights(origins.size());
+
+        if (IS_BATCH)
+        {
+            fov::begin_lgt_batch();
+
+            for (size_t i = 0; i < origins.size(); ++i)
+            {
+                fov::add_lgt(origins[i], lights[i]);
+            }
+
+            fov::end_lgt_batch();
+        }
+
+        for (size_t i = 0; i < origins.size(); ++i)
+        {
+            const Pos& origin = origins[i];
+
+            bool hard_blocked[MAP_W][MAP_H];
+            map_parse::run(cell_check::Blocks_los(), hard_blocked);
+
+            Los_result fov[MAP_W][MAP_H];
+            fov::run(origin, hard_blocked, fov);
+
+            Map_bits& light = lights[i];
+
+            if (!IS_BATCH)
+            {
+                fov::add_lgt(origin, light);
+            }
+
+            const Rect fov_lmt = fov::get_fov_rect(origin);
+
+            for (int x = 0; x < MAP_W; ++x)
+            {
+                for (int y = 0; y < MAP_H; ++y)
+                {
+                    const bool IS_LIT_EXPECTED =
+                        utils::is_pos_inside(Pos(x, y), fov_lmt) && !fov[x][y].is_blocked_hard;
+
+                    if (light.at(x, y) != IS_LIT_EXPECTED)
+                    {
+                        ++nr_diffs;
+                    }
+                }
+            }
+        }
+    }
+
+    CHECK_EQUAL(0, nr_diffs);
+
+    game_time::erase_all_mobs();
+}
+
+TEST_FIXTURE(Basic_fixture, lgt_radius)
+{
+    //Light sources of different sizes light areas of different sizes
+    for (int x = 10; x < 70; ++x)
     {
-        if (prop_hlr.has_prop(Prop_id(i)))
+        for (int y = 1; y < MAP_H - 1; ++y)
         {
-            CHECK(prop_hlr.prop(Prop_id(i)));
-            ++nr_props;
+            map::put(new Floor(Pos(x, y)));
         }
     }
 
-    CHECK_EQUAL(4, int(nr_props));
+    const Pos origin(40, MAP_H / 2);
 
-    CHECK(prop_hlr.prop(Prop_id::rFire));
-    CHECK(prop_hlr.prop(Prop_id::rElec));
-    CHECK(prop_hlr.prop(Prop_id::rAcid));
-    CHECK(prop_hlr.prop(Prop_id::rBreath));
+    map::player->pos = origin;
+    game_time::update_actor_pos(*map::player);
 
-    CHECK(prop_hlr.has_prop(Prop_id::rFire));
-    CHECK(prop_hlr.has_prop(Prop_id::rElec));
-    CHECK(prop_hlr.has_prop(Prop_id::rAcid));
-    CHECK(prop_hlr.has_prop(Prop_id::rBreath));
+    auto nr_lit_cells = []() -> int
+    {
+        game_time::update_light_map();
 
-    //Destroy the asbesthos suit
-    map::player->restore_hp(99999, true /* Restoring above max */);
+        int nr_lit = 0;
 
-    for (int i = 0; i < 10; ++i)
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                if (map::cells[x][y].is_lit) {++nr_lit;}
+            }
+        }
+
+        return nr_lit;
+    };
+
+    CHECK_EQUAL(0, nr_lit_cells());
+
+    //Lantern, working and flickering
+    Item* const item = item_factory::mk(Item_id::electric_lantern);
+    Device_lantern* const lantern = static_cast<Device_lantern*>(item);
+
+    map::player->inv().put_in_backpack(item);
+
+    lantern->is_activated_  = true;
+    lantern->working_state_ = Lantern_working_state::working;
+
+    const int NR_LIT_LANTERN = nr_lit_cells();
+
+    lantern->working_state_ = Lantern_working_state::flicker;
+
+    const int NR_LIT_FLICKER = nr_lit_cells();
+
+    //Flare
+    lantern->is_activated_ = false;
+
+    game_time::add_mob(new Lit_flare(origin, 10));
+
+    const int NR_LIT_FLARE = nr_lit_cells();
+
+    const int SMALL_W = (LGT_SMALL_RADI_INT * 2) + 1;
+
+    CHECK_EQUAL(SMALL_W * SMALL_W, NR_LIT_FLICKER);
+
+    CHECK(NR_LIT_LANTERN    > NR_LIT_FLICKER);
+    CHECK(NR_LIT_FLARE      > NR_LIT_LANTERN);
+
+    game_time::erase_all_mobs();
+}
+
+TEST_FIXTURE(Basic_fixture, throw_items)
+{
+    //-----------------------------------------------------------------
+    // Throwing a throwing knife at a wall should make it land
+    // in front of the wall - i.e. the cell it travelled through
+    // before encountering the wall.
+    //
+    // . <- (5, 7)
+    // # <- If aiming at wall here... (5, 8)
+    // . <- ...throwing knife should finally land here (5, 9)
+    // @ <- Player position (5, 10).
+    //-----------------------------------------------------------------
+
+    map::put(new Floor(Pos(5, 7)));
+    map::put(new Floor(Pos(5, 9)));
+    map::put(new Floor(Pos(5, 10)));
+    map::player->pos = Pos(5, 10);
+    game_time::update_actor_pos(*map::player);
+    Pos tgt(5, 8);
+    Item* item = item_factory::mk(Item_id::thr_knife);
+    throwing::throw_item(*(map::player), tgt, *item);
+    CHECK(map::cells[5][9].item);
+}
+
+TEST_FIXTURE(Basic_fixture, explosions)
+{
+    const int X0 = 5;
+    const int Y0 = 7;
+
+    //auto* const floor = new Floor(Pos(X0, Y0));
+    map::put(new Floor(Pos(X0, Y0)));
+
+    //Check wall destruction
+    for (int i = 0; i < 2; ++i)
     {
-        explosion::run_explosion_at(map::player->pos, Expl_type::expl);
-    }
+        explosion::run_explosion_at(Pos(X0, Y0), Expl_type::expl);
+
+        //Cells around the center, at a distance of 1, should be destroyed
+        int r = 1;
+        CHECK(map::cells[X0 + r][Y0    ].rigid->id() != Feature_id::wall);
+        CHECK(map::cells[X0 - r][Y0    ].rigid->id() != Feature_id::wall);
+        CHECK(map::cells[X0    ][Y0 + r].rigid->id() != Feature_id::wall);
+        CHECK(map::cells[X0    ][Y0 - r].rigid->id() != Feature_id::wall);
+        CHECK(map::cells[X0 + r][Y0 + r].rigid->id() != Feature_id::wall);
+        CHECK(map::cells[X0 + r][Y0 - r].rigid->id() != Feature_id::wall);
+        CHECK(map::cells[X0 - r][Y0 + r].rigid->id() != Feature_id::wall);
+        CHECK(map::cells[X0 - r][Y0 - r].rigid->id() != Feature_id::wall);
+
+        //Cells around the center, at a distance of 2, should NOT be destroyed
+        r = 2;
+        CHECK(map::cells[X0 + r][Y0    ].rigid->id() == Feature_id::wall);
+        CHECK(map::cells[X0 - r][Y0    ].rigid->id() == Feature_id::wall);
+        CHECK(map::cells[X0    ][Y0 + r].rigid->id() == Feature_id::wall);
+        CHECK(map::cells[X0    ][Y0 - r].rigid->id() == Feature_id::wall);
+        CHECK(map::cells[X0 + r][Y0 + r].rigid->id() == Feature_id::wall);
+        CHECK(map::cells[X0 + r][Y0 - r].rigid->id() == Feature_id::wall);
+        CHECK(map::cells[X0 - r][Y0 + r].rigid->id() == Feature_id::wall);
+        CHECK(map::cells[X0 - r][Y0 - r].rigid->id() == Feature_id::wall);
+    }
+
+    //Check damage to actors
+    Actor* a1 = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
+    explosion::run_explosion_at(Pos(X0, Y0), Expl_type::expl);
+    CHECK_EQUAL(int(Actor_state::destroyed), int(a1->state()));
+
+    //Check that corpses can be destroyed, and do not block living actors
+    const int NR_CORPSES = 3;
+    Actor* corpses[NR_CORPSES];
+
+    for (int i = 0; i < NR_CORPSES; ++i)
+    {
+        corpses[i] = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
+        corpses[i]->die(false, false, false);
+    }
+
+    a1 = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
+    explosion::run_explosion_at(Pos(X0, Y0), Expl_type::expl);
+
+    for (int i = 0; i < NR_CORPSES; ++i)
+    {
+        CHECK_EQUAL(int(Actor_state::destroyed), int(corpses[i]->state()));
+    }
+
+    CHECK_EQUAL(int(Actor_state::destroyed), int(a1->state()));
+
+    //Check explosion applying Burning to living and dead actors
+    a1        = actor_factory::mk(Actor_id::rat, Pos(X0 - 1, Y0));
+    Actor* a2 = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
+
+    for (int i = 0; i < NR_CORPSES; ++i)
+    {
+        corpses[i] = actor_factory::mk(Actor_id::rat, Pos(X0 + 1, Y0));
+        corpses[i]->die(false, false, false);
+    }
+
+    explosion::run_explosion_at(Pos(X0, Y0), Expl_type::apply_prop, Expl_src::misc,
+                                Emit_expl_snd::no, 0, new Prop_burning(Prop_turns::std));
+    CHECK(a1->prop_handler().prop(Prop_id::burning));
+    CHECK(a2->prop_handler().prop(Prop_id::burning));
+
+    CHECK(a1->has_prop(Prop_id::burning));
+    CHECK(a2->has_prop(Prop_id::burning));
+
+    for (int i = 0; i < NR_CORPSES; ++i)
+    {
+        Prop_handler& prop_hlr = corpses[i]->prop_handler();
+        CHECK(prop_hlr.prop(Prop_id::burning));
+        CHECK(prop_hlr.has_prop(Prop_id::burning));
+    }
+
+    //Check that the explosion can handle the map edge (e.g. that it does not
+    //destroy the edge wall, or go outside the map - possibly causing a crash)
+
+    //North-west edge
+    int x = 1;
+    int y = 1;
+    map::put(new Floor(Pos(x, y)));
+    explosion::run_explosion_at(Pos(x, y), Expl_type::expl);
+    CHECK(map::cells[x + 1][y    ].rigid->id() != Feature_id::wall);
+    CHECK(map::cells[x    ][y + 1].rigid->id() != Feature_id::wall);
+    CHECK(map::cells[x - 1][y    ].rigid->id() == Feature_id::wall);
+    CHECK(map::cells[x    ][y - 1].rigid->id() == Feature_id::wall);
+
+    //South-east edge
+    x = MAP_W - 2;
+    y = MAP_H - 2;
+    map::put(new Floor(Pos(x, y)));
+    explosion::run_explosion_at(Pos(x, y), Expl_type::expl);
+    CHECK(map::cells[x - 1][y    ].rigid->id() != Feature_id::wall);
+    CHECK(map::cells[x    ][y - 1].rigid->id() != Feature_id::wall);
+    CHECK(map::cells[x + 1][y    ].rigid->id() == Feature_id::wall);
+    CHECK(map::cells[x    ][y + 1].rigid->id() == Feature_id::wall);
+}
+
+TEST_FIXTURE(Basic_fixture, monster_stuck_in_spider_web)
+{
+    //-----------------------------------------------------------------
+    // Test that-
+    // * a monster can get stuck in a spider web,
+    // * the monster can get loose, and
+    // * the web can get destroyed
+    //-----------------------------------------------------------------
+
+    const Pos pos_l(1, 4);
+    const Pos pos_r(2, 4);
+
+    //Spawn left floor cell
+    map::put(new Floor(pos_l));
+
+    //Conditions for finished test
+    bool tested_stuck               = false;
+    bool tested_loose_web_interact  = false;
+    bool tested_loose_web_destroyed = false;
+
+    while (!tested_stuck || !tested_loose_web_interact || !tested_loose_web_destroyed)
+    {
+
+        //Spawn right floor cell
+        map::put(new Floor(pos_r));
+
+        //Spawn a monster that can get stuck in the web
+        Actor* const actor = actor_factory::mk(Actor_id::zombie, pos_l);
+        Mon* const mon = static_cast<Mon*>(actor);
+
+        //Create a spider web in the right cell
+        const auto  mimicId     = map::cells[pos_r.x][pos_r.x].rigid->id();
+        const auto& mimic_data  = feature_data::data(mimicId);
+        const auto* const mimic = static_cast<const Rigid*>(mimic_data.mk_obj(pos_r));
+        map::put(new Trap(pos_r, mimic, Trap_id::web));
+
+        //Move the monster into the trap, and back again
+        mon->aware_counter_ = 20000; // > 0 req. for triggering trap
+        mon->pos = pos_l;
+        game_time::update_actor_pos(*mon);
+        mon->move(Dir::right);
+        CHECK(mon->pos == pos_r);
+        mon->move(Dir::left);
+        mon->move(Dir::left);
+
+        //Check conditions
+        if (mon->pos == pos_r)
+        {
+            tested_stuck = true;
+        }
+        else if (mon->pos == pos_l)
+        {
+            const auto featureId = map::cells[pos_r.x][pos_r.y].rigid->id();
+
+            if (featureId == Feature_id::floor)
+            {
+                tested_loose_web_destroyed = true;
+            }
+            else
+            {
+                tested_loose_web_interact = true;
+            }
+        }
+
+        //Remove the monster
+        actor_factory::delete_all_mon();
+    }
+
+    //Check that all cases have been triggered (not really necessary, it just
+    //verifies that the loop above is correctly written).
+    CHECK(tested_stuck);
+    CHECK(tested_loose_web_interact);
+    CHECK(tested_loose_web_destroyed);
+}
+
+TEST_FIXTURE(Basic_fixture, inventory_handling)
+{
+    const Pos p(10, 10);
+    map::put(new Floor(p));
+    map::player->pos = p;
+    game_time::update_actor_pos(*map::player);
+
+    Inventory&  inv         = map::player->inv();
+    Inv_slot&   body_slot   = inv.slots_[size_t(Slot_id::body)];
+
+    delete body_slot.item;
+    body_slot.item = nullptr;
+
+    Prop_handler& prop_hlr = map::player->prop_handler();
+
+    //Check that no props are enabled
+    for (size_t i = 0; i < size_t(Prop_id::END); ++i)
+    {
+        CHECK(!prop_hlr.has_prop(Prop_id(i)));
+        CHECK(!prop_hlr.prop(Prop_id(i)));
+    }
+
+    //Wear asbesthos suit
+    Item* item = item_factory::mk(Item_id::armor_asb_suit);
+
+    inv.put_in_slot(Slot_id::body, item);
+
+    //Check that the props are applied
+    size_t nr_props = 0;
+
+    for (size_t i = 0; i < size_t(Prop_id::END); ++i)
+    {
+        if (prop_hlr.has_prop(Prop_id(i)))
+        {
+            CHECK(prop_hlr.prop(Prop_id(i)));
+            ++nr_props;
+        }
+    }
+
+    CHECK_EQUAL(4, int(nr_props));
+
+    CHECK(prop_hlr.prop(Prop_id::rFire));
+    CHECK(prop_hlr.prop(Prop_id::rElec));
+    CHECK(prop_hlr.prop(Prop_id::rAcid));
+    CHECK(prop_hlr.prop(Prop_id::rBreath));
+
+    CHECK(prop_hlr.has_prop(Prop_id::rFire));
+    CHECK(prop_hlr.has_prop(Prop_id::rElec));
+    CHECK(prop_hlr.has_prop(Prop_id::rAcid));
+    CHECK(prop_hlr.has_prop(Prop_id::rBreath));
+
+    //Take off asbeshos suit
+    inv.try_unequip_slot(Slot_id::body);
+
+    CHECK(inv.backpack_idx(Item_id::armor_asb_suit) != -1);
+
+    //Check that the properties are cleared
+    for (int i = 0; i < int(Prop_id::END); ++i)
+    {
+        CHECK(!prop_hlr.has_prop(Prop_id(i)));
+        CHECK(!prop_hlr.prop(Prop_id(i)));
+    }
+
+    //Wear the asbeshos suit again
+    inv.equip_backpack_item(inv.backpack_idx(Item_id::armor_asb_suit), Slot_id::body);
+
+    game_time::tick();
+
+    //Check that the props are applied
+    nr_props = 0;
+
+    for (int i = 0; i < int(Prop_id::END); ++i)
+    {
+        if (prop_hlr.has_prop(Prop_id(i)))
+        {
+            CHECK(prop_hlr.prop(Prop_id(i)));
+            ++nr_props;
+        }
+    }
+
+    CHECK_EQUAL(4, int(nr_props));
+
+    CHECK(prop_hlr.prop(Prop_id::rFire));
+    CHECK(prop_hlr.prop(Prop_id::rElec));
+    CHECK(prop_hlr.prop(Prop_id::rAcid));
+    CHECK(prop_hlr.prop(Prop_id::rBreath));
+
+    CHECK(prop_hlr.has_prop(Prop_id::rFire));
+    CHECK(prop_hlr.has_prop(Prop_id::rElec));
+    CHECK(prop_hlr.has_prop(Prop_id::rAcid));
+    CHECK(prop_hlr.has_prop(Prop_id::rBreath));
+
+    //Drop the asbeshos suit on the ground
+    item_drop::try_drop_item_from_inv(*map::player, Inv_type::slots, int(Slot_id::body), 1);
+
+    //Check that no item exists in body slot
+    CHECK(!body_slot.item);
+
+    //Check that the item is on the ground
+    Cell& cell = map::cells[p.x][p.y];
+    CHECK(cell.item);
+
+    //Check that the properties are cleared
+    for (int i = 0; i < int(Prop_id::END); ++i)
+    {
+        CHECK(!prop_hlr.has_prop(Prop_id(i)));
+        CHECK(!prop_hlr.prop(Prop_id(i)));
+    }
+
+    //Wear the same dropped asbesthos suit again
+    inv.put_in_slot(Slot_id::body, cell.item);
+
+    cell.item = nullptr;
+
+    //Check that the props are applied
+    nr_props = 0;
+
+    for (int i = 0; i < int(Prop_id::END); ++i)
+    {
+        if (prop_hlr.has_prop(Prop_id(i)))
+        {
+            CHECK(prop_hlr.prop(Prop_id(i)));
+            ++nr_props;
+        }
+    }
+
+    CHECK_EQUAL(4, int(nr_props));
+
+    CHECK(prop_hlr.prop(Prop_id::rFire));
+    CHECK(prop_hlr.prop(Prop_id::rElec));
+    CHECK(prop_hlr.prop(Prop_id::rAcid));
+    CHECK(prop_hlr.prop(Prop_id::rBreath));
+
+    CHECK(prop_hlr.has_prop(Prop_id::rFire));
+    CHECK(prop_hlr.has_prop(Prop_id::rElec));
+    CHECK(prop_hlr.has_prop(Prop_id::rAcid));
+    CHECK(prop_hlr.has_prop(Prop_id::rBreath));
+
+    //Destroy the asbesthos suit
+    map::player->restore_hp(99999, true /* Restoring above max */);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        explosion::run_explosion_at(map::player->pos, Expl_type::expl);
+    }
+
+    //Check that the asbesthos suit is destroyed
+    CHECK(!body_slot.item);
+
+    //Check that the properties are cleared
+    for (int i = 0; i < int(Prop_id::END); ++i)
+    {
+        CHECK(!prop_hlr.has_prop(Prop_id(i)));
+        CHECK(!prop_hlr.prop(Prop_id(i)));
+    }
+}
+
+TEST_FIXTURE(Basic_fixture, saving_game)
+{
+    //Item data
+    item_data::data[int(Item_id::scroll_telep)].is_tried = true;
+    item_data::data[int(Item_id::scroll_opening)].is_identified = true;
+
+    //Bonus
+    player_bon::pick_bg(Bg::rogue);
+    player_bon::traits[int(Trait::healer)] = true;
+
+    //Player inventory
+    Inventory& inv = map::player->inv();
+
+    //First, remove all present items
+    std::vector<Item*>& gen = inv.backpack_;
+
+    for (Item* item : gen)
+    {
+        delete item;
+    }
+
+    gen.clear();
+
+    for (size_t i = 0; i < size_t(Slot_id::END); ++i)
+    {
+        auto& slot = inv.slots_[i];
+
+        if (slot.item)
+        {
+            delete slot.item;
+            slot.item = nullptr;
+        }
+    }
+
+    //Put new items
+    Item* item = item_factory::mk(Item_id::mi_go_gun);
+    inv.put_in_slot(Slot_id::wielded, item);
+
+    //Wear asbestos suit to test properties from wearing items
+    item = item_factory::mk(Item_id::armor_asb_suit);
+    inv.put_in_slot(Slot_id::body, item);
+    item = item_factory::mk(Item_id::pistol_clip);
+    static_cast<Ammo_clip*>(item)->ammo_ = 1;
+    inv.put_in_backpack(item);
+    item = item_factory::mk(Item_id::pistol_clip);
+    static_cast<Ammo_clip*>(item)->ammo_ = 2;
+    inv.put_in_backpack(item);
+    item = item_factory::mk(Item_id::pistol_clip);
+    static_cast<Ammo_clip*>(item)->ammo_ = 3;
+    inv.put_in_backpack(item);
+    item = item_factory::mk(Item_id::pistol_clip);
+    static_cast<Ammo_clip*>(item)->ammo_ = 3;
+    inv.put_in_backpack(item);
+    item = item_factory::mk(Item_id::device_blaster);
+    static_cast<Strange_device*>(item)->condition_ = Condition::shoddy;
+    inv.put_in_backpack(item);
+    item = item_factory::mk(Item_id::electric_lantern);
+    Device_lantern* lantern         = static_cast<Device_lantern*>(item);
+    lantern->nr_turns_left_         = 789;
+    lantern->nr_flicker_turns_left_ = 456;
+    lantern->working_state_         = Lantern_working_state::flicker;
+    lantern->is_activated_          = true;
+    inv.put_in_backpack(item);
+
+    //Player
+    Actor_data_t& def = map::player->data();
+    def.name_a = def.name_the = "TEST PLAYER";
+    map::player->change_max_hp(5, Verbosity::silent);
+
+    //map
+    map::dlvl = 7;
+
+    //Actor data
+    actor_data::data[int(Actor_id::END) - 1].nr_kills = 123;
+
+    //Learned spells
+    player_spells_handling::learn_spell_if_not_known(Spell_id::bless);
+    player_spells_handling::learn_spell_if_not_known(Spell_id::aza_wrath);
+
+    //Applied properties
+    Prop_handler& prop_hlr = map::player->prop_handler();
+    prop_hlr.try_add_prop(new Prop_rSleep(Prop_turns::specific, 3));
+    prop_hlr.try_add_prop(new Prop_diseased(Prop_turns::indefinite));
+    prop_hlr.try_add_prop(new Prop_blessed(Prop_turns::std));
+
+    //Check a a few of the props applied
+    Prop* prop = prop_hlr.prop(Prop_id::diseased);
+    CHECK(prop);
+
+    prop = prop_hlr.prop(Prop_id::blessed);
+    CHECK(prop);
+
+    //Check a prop that was NOT applied
+    prop = prop_hlr.prop(Prop_id::confused);
+    CHECK(!prop);
+
+    //map sequence
+    map_travel::map_list[5] = {Map_type::rats_in_the_walls, Is_main_dungeon::yes};
+    map_travel::map_list[7] = {Map_type::leng,              Is_main_dungeon::no};
+
+    save_handling::save();
+    CHECK(save_handling::is_save_available());
+}
+
+TEST_FIXTURE(Basic_fixture, loading_game)
+{
+    CHECK(save_handling::is_save_available());
+
+    const int PLAYER_MAX_HP_BEFORE_LOAD = map::player->hp_max(true);
+
+    save_handling::load();
+
+    //Item data
+    CHECK_EQUAL(true,  item_data::data[int(Item_id::scroll_telep)].is_tried);
+    CHECK_EQUAL(false, item_data::data[int(Item_id::scroll_telep)].is_identified);
+    CHECK_EQUAL(true,  item_data::data[int(Item_id::scroll_opening)].is_identified);
+    CHECK_EQUAL(false, item_data::data[int(Item_id::scroll_opening)].is_tried);
+    CHECK_EQUAL(false, item_data::data[int(Item_id::scroll_det_mon)].is_tried);
+    CHECK_EQUAL(false, item_data::data[int(Item_id::scroll_det_mon)].is_identified);
+
+    //Bonus
+    CHECK_EQUAL(int(Bg::rogue), int(player_bon::bg()));
+    CHECK(player_bon::traits[int(Trait::healer)]);
+    CHECK(!player_bon::traits[int(Trait::sharp_shooter)]);
+
+    //Player inventory
+    Inventory& inv  = map::player->inv();
+    auto& genInv    = inv.backpack_;
+
+    CHECK_EQUAL(6, int(genInv.size()));
+    CHECK_EQUAL(int(Item_id::mi_go_gun), int(inv.item_in_slot(Slot_id::wielded)->data().id));
+    CHECK_EQUAL(int(Item_id::armor_asb_suit), int(inv.item_in_slot(Slot_id::body)->data().id));
+
+    int nr_clip_with_1 = 0;
+    int nr_clip_with_2 = 0;
+    int nr_clip_with_3 = 0;
+    bool is_sentry_device_found     = false;
+    bool is_electric_lantern_found  = false;
+
+    for (Item* item : genInv)
+    {
+        Item_id id = item->id();
+
+        if (id == Item_id::pistol_clip)
+        {
+            switch (static_cast<Ammo_clip*>(item)->ammo_)
+            {
+            case 1:
+                nr_clip_with_1++;
+                break;
+
+            case 2:
+                nr_clip_with_2++;
+                break;
+
+            case 3:
+                nr_clip_with_3++;
+                break;
+
+            default:
+                break;
+            }
+        }
+        else if (id == Item_id::device_blaster)
+        {
+            is_sentry_device_found = true;
+            CHECK_EQUAL(int(Condition::shoddy),
+                        int(static_cast<Strange_device*>(item)->condition_));
+        }
+        else if (id == Item_id::electric_lantern)
+        {
+            is_electric_lantern_found = true;
+            Device_lantern* lantern = static_cast<Device_lantern*>(item);
+            CHECK_EQUAL(789, lantern->nr_turns_left_);
+            CHECK_EQUAL(456, lantern->nr_flicker_turns_left_);
+            CHECK_EQUAL(int(Lantern_working_state::flicker), int(lantern->working_state_));
+            CHECK(lantern->is_activated_);
+        }
+    }
+
+    CHECK_EQUAL(1, nr_clip_with_1);
+    CHECK_EQUAL(1, nr_clip_with_2);
+    CHECK_EQUAL(2, nr_clip_with_3);
+    CHECK(is_sentry_device_found);
+    CHECK(is_electric_lantern_found);
+
+    //Player
+    Actor_data_t& def = map::player->data();
+    def.name_a = def.name_the = "TEST PLAYER";
+    CHECK_EQUAL("TEST PLAYER", def.name_a);
+    CHECK_EQUAL("TEST PLAYER", def.name_the);
+    //Check max HP (affected by disease)
+    CHECK_EQUAL((PLAYER_MAX_HP_BEFORE_LOAD + 5) / 2, map::player->hp_max(true));
+
+    //map
+    CHECK_EQUAL(7, map::dlvl);
+
+    //Actor data
+    CHECK_EQUAL(123, actor_data::data[int(Actor_id::END) - 1].nr_kills);
+
+    //Learned spells
+    CHECK(player_spells_handling::is_spell_learned(Spell_id::bless));
+    CHECK(player_spells_handling::is_spell_learned(Spell_id::aza_wrath));
+    CHECK_EQUAL(false, player_spells_handling::is_spell_learned(Spell_id::mayhem));
+
+    //Properties
+    Prop_handler& prop_hlr = map::player->prop_handler();
+    Prop* prop = prop_hlr.prop(Prop_id::diseased);
+    CHECK(prop);
+    CHECK(prop_hlr.has_prop(Prop_id::diseased));
+    CHECK_EQUAL(-1, prop->nr_turns_left());
+    //Check currrent HP (affected by disease)
+    CHECK_EQUAL((map::player->data().hp + 5) / 2, map::player->hp());
+
+    prop = prop_hlr.prop(Prop_id::rSleep);
+    CHECK(prop);
+    CHECK(prop_hlr.has_prop(Prop_id::rSleep));
+    CHECK_EQUAL(3, prop->nr_turns_left());
+
+    prop = prop_hlr.prop(Prop_id::blessed);
+    CHECK(prop);
+    CHECK(prop_hlr.has_prop(Prop_id::blessed));
+    CHECK(prop->nr_turns_left() > 0);
+
+    //Properties from worn item
+    prop = prop_hlr.prop(Prop_id::rAcid);
+    CHECK(prop);
+    CHECK(prop->nr_turns_left() == -1);
+    prop = prop_hlr.prop(Prop_id::rFire);
+    CHECK(prop);
+    CHECK(prop->nr_turns_left() == -1);
+
+    //map sequence
+    auto mapData = map_travel::map_list[3];
+    CHECK(mapData.type              == Map_type::std);
+    CHECK(mapData.is_main_dungeon   == Is_main_dungeon::yes);
+
+    mapData = map_travel::map_list[5];
+    CHECK(mapData.type              == Map_type::rats_in_the_walls);
+    CHECK(mapData.is_main_dungeon   == Is_main_dungeon::yes);
+
+    mapData = map_travel::map_list[7];
+    CHECK(mapData.type              == Map_type::leng);
+    CHECK(mapData.is_main_dungeon   == Is_main_dungeon::no);
+
+    //Game time
+    CHECK_EQUAL(0, game_time::turn());
+}
+
+TEST_FIXTURE(Basic_fixture, flood_filling)
+{
+    bool b[MAP_W][MAP_H];
+    utils::reset_array(b, false);
+
+    for (int y = 0; y < MAP_H; ++y)
+    {
+        b[0][y] = b[MAP_W - 1][y] = false;
+    }
+
+    for (int x = 0; x < MAP_W; ++x)
+    {
+        b[x][0] = b[x][MAP_H - 1] = false;
+    }
+
+    int flood[MAP_W][MAP_H];
+    flood_fill::run(Pos(20, 10), b, flood, 999, Pos(-1, -1), true);
+
+    CHECK_EQUAL(0, flood[20][10]);
+    CHECK_EQUAL(1, flood[19][10]);
+    CHECK_EQUAL(1, flood[21][10]);
+    CHECK_EQUAL(1, flood[20][11]);
+    CHECK_EQUAL(1, flood[21][11]);
+    CHECK_EQUAL(4, flood[24][12]);
+    CHECK_EQUAL(4, flood[24][14]);
+    CHECK_EQUAL(5, flood[24][15]);
+    CHECK_EQUAL(0, flood[0][0]);
+    CHECK_EQUAL(0, flood[MAP_W - 1][MAP_H - 1]);
+}
+
+TEST_FIXTURE(Basic_fixture, path_finding)
+{
+    std::vector<Pos> path;
+    bool b[MAP_W][MAP_H];
+    utils::reset_array(b, false);
+
+    for (int y = 0; y < MAP_H; ++y)
+    {
+        b[0][y] = b[MAP_W - 1][y] = false;
+    }
+
+    for (int x = 0; x < MAP_W; ++x)
+    {
+        b[x][0] = b[x][MAP_H - 1] = false;
+    }
+
+    path_find::run(Pos(20, 10), Pos(25, 10), b, path);
+
+    CHECK(!path.empty());
+    CHECK(path.back() != Pos(20, 10));
+    CHECK_EQUAL(25, path.front().x);
+    CHECK_EQUAL(10, path.front().y);
+    CHECK_EQUAL(5, int(path.size()));
+
+    path_find::run(Pos(20, 10), Pos(5, 3), b, path);
+
+    CHECK(!path.empty());
+    CHECK(path.back() != Pos(20, 10));
+    CHECK_EQUAL(5, path.front().x);
+    CHECK_EQUAL(3, path.front().y);
+    CHECK_EQUAL(15, int(path.size()));
+
+    b[10][5] = true;
+
+    path_find::run(Pos(7, 5), Pos(20, 5), b, path);
+
+    CHECK(!path.empty());
+    CHECK(path.back() != Pos(7, 5));
+    CHECK_EQUAL(20, path.front().x);
+    CHECK_EQUAL(5, path.front().y);
+    CHECK_EQUAL(13, int(path.size()));
+    CHECK(find(begin(path), end(path), Pos(10, 5)) == end(path));
+
+    b[19][4] = b[19][5] =  b[19][6] = true;
+
+    path_find::run(Pos(7, 5), Pos(20, 5), b, path);
+
+    CHECK(!path.empty());
+    CHECK(path.back() != Pos(7, 5));
+    CHECK_EQUAL(20, path.front().x);
+    CHECK_EQUAL(5, path.front().y);
+    CHECK_EQUAL(14, int(path.size()));
+    CHECK(find(begin(path), end(path), Pos(19, 4)) == end(path));
+    CHECK(find(begin(path), end(path), Pos(19, 5)) == end(path));
+    CHECK(find(begin(path), end(path), Pos(19, 6)) == end(path));
+
+    path_find::run(Pos(40, 10), Pos(43, 15), b, path, false);
+
+    CHECK(!path.empty());
+    CHECK(path.back() != Pos(40, 10));
+    CHECK_EQUAL(43, path.front().x);
+    CHECK_EQUAL(15, path.front().y);
+    CHECK_EQUAL(8, int(path.size()));
+
+    b[41][10] = b[40][11]  = true;
+
+    path_find::run(Pos(40, 10), Pos(43, 15), b, path, false);
+
+    CHECK(!path.empty());
+    CHECK(path.back() != Pos(40, 10));
+    CHECK_EQUAL(43, path.front().x);
+    CHECK_EQUAL(15, path.front().y);
+    CHECK_EQUAL(10, int(path.size()));
+}
+
+TEST_FIXTURE(Basic_fixture, map_parse_expand_one)
+{
+    bool in[MAP_W][MAP_H];
+    utils::reset_array(in, false);
+
+    in[10][5] = true;
+
+    bool out[MAP_W][MAP_H];
+    map_parse::expand(in, out);
+
+    CHECK(!out[8][5]);
+    CHECK(out[9][5]);
+    CHECK(out[10][5]);
+    CHECK(out[11][5]);
+    CHECK(!out[12][5]);
+
+    CHECK(!out[8][4]);
+    CHECK(out[9][4]);
+    CHECK(out[10][4]);
+    CHECK(out[11][4]);
+    CHECK(!out[12][4]);
+
+    in[14][5] = true;
+    map_parse::expand(in, out);
+
+    CHECK(out[10][5]);
+    CHECK(out[11][5]);
+    CHECK(!out[12][5]);
+    CHECK(out[13][5]);
+    CHECK(out[14][5]);
+
+    in[12][5] = true;
+    map_parse::expand(in, out);
+    CHECK(out[12][4]);
+    CHECK(out[12][5]);
+    CHECK(out[12][6]);
+
+    //Check that old values are cleared
+    utils::reset_array(in, false);
+    in[40][10] = true;
+    map_parse::expand(in, out);
+    CHECK(out[39][10]);
+    CHECK(out[40][10]);
+    CHECK(out[41][10]);
+    CHECK(!out[10][5]);
+    CHECK(!out[12][5]);
+    CHECK(!out[14][5]);
+}
+
+TEST_FIXTURE(Basic_fixture, map_bits_ops)
+{
+    //Compare the word-parallel operations against simple cell by cell versions
+    bool in[MAP_W][MAP_H];
+    bool out[MAP_W][MAP_H];
+
+    int nr_diffs = 0;
+
+    for (int i = 0; i < 20; ++i)
+    {
+        //Sparse in some runs, dense in others (also set the map edges sometimes)
+        const int ONE_IN = (i % 2 == 0) ? 50 : 3;
+
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                in[x][y] = rnd::one_in(ONE_IN);
+            }
+        }
+
+        const Map_bits bits(in);
+
+        //Conversion and counting
+        int nr_set = 0;
+
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                if (bits.at(x, y) != in[x][y]) {++nr_diffs;}
+                if (in[x][y]) {++nr_set;}
+            }
+        }
+
+        CHECK_EQUAL(nr_set, bits.count());
+
+        //Inverting
+        Map_bits flipped(bits);
+        flipped.flip();
+
+        CHECK_EQUAL(MAP_W * MAP_H - nr_set, flipped.count());
+
+        //Expanding
+        for (const int DIST : {1, 2, 5})
+        {
+            Map_bits expanded(bits);
+            expanded.expand(DIST);
+
+            for (int x = 0; x < MAP_W; ++x)
+            {
+                for (int y = 0; y < MAP_H; ++y)
+                {
+                    bool is_near = false;
+
+                    for (int cmp_x = x - DIST; cmp_x <= x + DIST && !is_near; ++cmp_x)
+                    {
+                        for (int cmp_y = y - DIST; cmp_y <= y + DIST && !is_near; ++cmp_y)
+                        {
+                            is_near = utils::is_pos_inside_map(Pos(cmp_x, cmp_y)) &&
+                                      in[cmp_x][cmp_y];
+                        }
+                    }
+
+                    if (expanded.at(x, y) != is_near) {++nr_diffs;}
+                }
+            }
+
+            map_parse::expand(in, out, DIST);
+
+            Map_bits out_bits(out);
+
+            if (out_bits != expanded) {++nr_diffs;}
+        }
+
+        //Checking areas
+        for (int j = 0; j < 50; ++j)
+        {
+            const Pos p0(rnd::range(0, MAP_W - 1), rnd::range(0, MAP_H - 1));
+            const Pos p1(rnd::range(p0.x, MAP_W - 1), rnd::range(p0.y, MAP_H - 1));
+
+            const Rect area(p0, p1);
+
+            if (bits.is_any_in_area(area) != map_parse::is_val_in_area(area, in))
+            {
+                ++nr_diffs;
+            }
+        }
+    }
+
+    CHECK_EQUAL(0, nr_diffs);
+}
+
+namespace
+{
+
+//The previous path to player - with a blocking array built and a path searched separately
+//for each monster
+void path_to_player_ref(Mon& mon, std::vector<Pos>& path, bool blocked[MAP_W][MAP_H])
+{
+    path.clear();
+
+    utils::reset_array(blocked, false);
+
+    for (int x = 1; x < MAP_W - 1; ++x)
+    {
+        for (int y = 1; y < MAP_H - 1; ++y)
+        {
+            const auto* const f = map::cells[x][y].rigid;
+
+            if (!f->can_move(mon))
+            {
+                if (f->id() == Feature_id::door)
+                {
+                    const Actor_data_t& d = mon.data();
+
+                    if (!d.can_open_doors && !d.can_bash_doors)
+                    {
+                        blocked[x][y] = true;
+                    }
+                }
+                else
+                {
+                    blocked[x][y] = true;
+                }
+            }
+        }
+    }
+
+    const Pos& player_pos = map::player->pos;
+
+    Los_result los_result = fov::check_cell(mon.pos, player_pos, blocked);
+
+    if (los_result.is_blocked_hard || los_result.is_blocked_by_drk)
+    {
+        map_parse::run(cell_check::Living_actors_adj_to_pos(mon.pos), blocked,
+                       Map_parse_mode::append);
+
+        path_find::run(mon.pos, player_pos, blocked, path);
+    }
+}
+
+} //namespace
+
+TEST_FIXTURE(Basic_fixture, path_to_player)
+{
+    //Paths from the shared distance map must be as long as the paths searched separately
+    //for each monster, and must only step through free cells
+    const Actor_id mon_ids[] =
+    {
+        Actor_id::rat, Actor_id::zombie, Actor_id::cultist, Actor_id::ghost,
+        Actor_id::locust, Actor_id::worm_mass
+    };
+
+    std::vector<Pos> path_ref;
+    std::vector<Pos> path;
+
+    int nr_diffs    = 0;
+    int nr_paths    = 0;
+
+    for (int lvl = 0; lvl < 3; ++lvl)
+    {
+        map::dlvl = 3 + (lvl * 8);
+
+        while (!map_gen::mk_std_lvl()) {}
+
+        actor_factory::delete_all_mon();
+
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_move_cmn(true), blocked);
+
+        std::vector<Pos> free_cells;
+        utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+        std::random_shuffle(begin(free_cells), end(free_cells));
+
+        //Place many monsters, so that they often block each other
+        const size_t NR_MON = std::min(size_t(150), free_cells.size());
+
+        for (size_t i = 0; i < NR_MON; ++i)
+        {
+            const Actor_id id = mon_ids[rnd::range(0, 5)];
+
+            Mon* const mon = static_cast<Mon*>(actor_factory::mk(id, free_cells[i]));
+
+            mon->aware_counter_ = 10;
+        }
+
+        for (int step = 0; step < 10; ++step)
+        {
+            //Move the player to a free cell now and then
+            if (step % 3 == 0)
+            {
+                for (size_t i = NR_MON; i < free_cells.size(); ++i)
+                {
+                    if (rnd::one_in(10))
+                    {
+                        map::player->pos = free_cells[i];
+                        game_time::update_actor_pos(*map::player);
+                        break;
+                    }
+                }
+            }
+
+            for (Actor* const actor : game_time::actors_)
+            {
+                if (actor->is_player()) {continue;}
+
+                Mon& mon = *static_cast<Mon*>(actor);
+
+                bool blocked_ref[MAP_W][MAP_H];
+                path_to_player_ref(mon, path_ref, blocked_ref);
+
+                ai::info::try_set_path_to_player(mon, path);
+
+                ++nr_paths;
+
+                if (path.size() != path_ref.size())
+                {
+                    ++nr_diffs;
+                    continue;
+                }
+
+                //Check that the path is connected, and only goes through free cells
+                Pos prev_pos = mon.pos;
+
+                for (auto it = path.rbegin(); it != path.rend(); ++it)
+                {
+                    if (!utils::is_pos_adj(prev_pos, *it, false) || blocked_ref[it->x][it->y])
+                    {
+                        ++nr_diffs;
+                        break;
+                    }
+
+                    prev_pos = *it;
+                }
+
+                if (!path.empty() && path.front() != map::player->pos)
+                {
+                    ++nr_diffs;
+                }
+            }
+        }
+    }
+
+    actor_factory::delete_all_mon();
+
+    CHECK(nr_paths > 0);
+    CHECK_EQUAL(0, nr_diffs);
+}
+
+TEST_FIXTURE(Basic_fixture, path_reuse)
+{
+    //Put a monster in a corridor-like area, out of sight from the player behind a wall
+    for (int x = 10; x <= 30; ++x)
+    {
+        map::put(new Floor(Pos(x, 10)));
+        map::put(new Floor(Pos(x, 12)));
+    }
+
+    map::put(new Floor(Pos(30, 11)));
+
+    map::player->pos = Pos(10, 10);
+    game_time::update_actor_pos(*map::player);
+
+    Mon* const mon = static_cast<Mon*>(actor_factory::mk(Actor_id::rat, Pos(10, 12)));
+
+    mon->aware_counter_ = 10;
+
+    const int NR_SEARCHED   = ai::info::nr_paths_searched();
+    const int NR_REUSED     = ai::info::nr_paths_reused();
+
+    std::vector<Pos> path;
+    ai::info::try_set_path_to_player(*mon, path);
+
+    CHECK(!path.empty());
+    CHECK_EQUAL(NR_SEARCHED + 1, ai::info::nr_paths_searched());
+
+    //Same situation, the path is reused
+    std::vector<Pos> path_reused;
+    ai::info::try_set_path_to_player(*mon, path_reused);
+
+    CHECK(path == path_reused);
+    CHECK_EQUAL(NR_REUSED + 1, ai::info::nr_paths_reused());
+
+    //The monster moves along the path, the rest of it is reused
+    mon->pos = path.back();
+    game_time::update_actor_pos(*mon);
+    path.pop_back();
+
+    ai::info::try_set_path_to_player(*mon, path_reused);
+
+    CHECK(path == path_reused);
+    CHECK_EQUAL(NR_SEARCHED + 1, ai::info::nr_paths_searched());
+    CHECK_EQUAL(NR_REUSED + 2, ai::info::nr_paths_reused());
+
+    //The next step is blocked by another monster
+    Actor* const blocker = actor_factory::mk(Actor_id::rat, path.back());
+
+    ai::info::try_set_path_to_player(*mon, path_reused);
+
+    CHECK_EQUAL(NR_SEARCHED + 2, ai::info::nr_paths_searched());
+    CHECK(path_reused.empty());
+
+    //The blocking monster moves away again
+    blocker->pos = Pos(30, 11);
+    game_time::update_actor_pos(*blocker);
+
+    ai::info::try_set_path_to_player(*mon, path_reused);
+
+    CHECK(path == path_reused);
+    CHECK_EQUAL(NR_SEARCHED + 3, ai::info::nr_paths_searched());
+
+    //The player moves
+    map::player->pos = Pos(11, 10);
+    game_time::update_actor_pos(*map::player);
+
+    ai::info::try_set_path_to_player(*mon, path_reused);
+
+    CHECK_EQUAL(path.size() - 1, path_reused.size());
+    CHECK_EQUAL(NR_SEARCHED + 4, ai::info::nr_paths_searched());
+
+    //The map changes
+    map::put(new Floor(Pos(20, 11)));
 
-    //Check that the asbesthos suit is destroyed
-    CHECK(!body_slot.item);
+    ai::info::try_set_path_to_player(*mon, path_reused);
 
-    //Check that the properties are cleared
-    for (int i = 0; i < int(Prop_id::END); ++i)
-    {
-        CHECK(!prop_hlr.has_prop(Prop_id(i)));
-        CHECK(!prop_hlr.prop(Prop_id(i)));
-    }
+    CHECK(path_reused.size() < path.size() - 1);
+    CHECK_EQUAL(NR_SEARCHED + 5, ai::info::nr_paths_searched());
+    CHECK_EQUAL(NR_REUSED + 2, ai::info::nr_paths_reused());
+
+    actor_factory::delete_all_mon();
 }
 
-TEST_FIXTURE(Basic_fixture, saving_game)
+TEST_FIXTURE(Basic_fixture, room_graph_updates)
 {
-    //Item data
-    item_data::data[int(Item_id::scroll_telep)].is_tried = true;
-    item_data::data[int(Item_id::scroll_opening)].is_identified = true;
-
-    //Bonus
-    player_bon::pick_bg(Bg::rogue);
-    player_bon::traits[int(Trait::healer)] = true;
+    //Updating the graph cell by cell must give the same graph as rebuilding it
+    map::dlvl = 5;
 
-    //Player inventory
-    Inventory& inv = map::player->inv();
+    while (!map_gen::mk_std_lvl()) {}
 
-    //First, remove all present items
-    std::vector<Item*>& gen = inv.backpack_;
+    CHECK(room_graph::nr_nodes() > 1);
 
-    for (Item* item : gen)
+    for (int i = 0; i < 40; ++i)
     {
-        delete item;
-    }
+        //A few changes at a time, so that the graph is updated and not rebuilt
+        for (int j = 0; j < 4; ++j)
+        {
+            const Pos p(rnd::range(1, MAP_W - 2), rnd::range(1, MAP_H - 2));
 
-    gen.clear();
+            const int TYPE = rnd::range(0, 2);
 
-    for (size_t i = 0; i < size_t(Slot_id::END); ++i)
-    {
-        auto& slot = inv.slots_[i];
+            if (TYPE == 0)
+            {
+                map::put(new Floor(p));
+            }
+            else if (TYPE == 1)
+            {
+                map::put(new Wall(p));
+            }
+            else
+            {
+                map::put(new Door(p, new Wall(p), Door_spawn_state::closed));
+            }
+        }
 
-        if (slot.item)
+        //Paths over the updated graph and over the whole map must have the same length
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+
+        for (int x = 0; x < MAP_W; ++x)
         {
-            delete slot.item;
-            slot.item = nullptr;
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                if (map::cells[x][y].rigid->id() == Feature_id::door)
+                {
+                    blocked[x][y] = false;
+                }
+            }
+        }
+
+        std::vector<Pos> free_cells;
+        utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+        std::vector<Pos> path_flat;
+        std::vector<Pos> path_graph;
+
+        for (int j = 0; j < 4; ++j)
+        {
+            const Pos p0 = free_cells[rnd::range(0, free_cells.size() - 1)];
+            const Pos p1 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            path_find::run(p0, p1, blocked, path_flat);
+            room_graph::find_path(p0, p1, blocked, path_graph);
+
+            CHECK_EQUAL(path_flat.size(), path_graph.size());
         }
+
+        const int NR_NODES_UPDATED = room_graph::nr_nodes();
+
+        room_graph::reset();
+
+        CHECK_EQUAL(room_graph::nr_nodes(), NR_NODES_UPDATED);
     }
+}
 
-    //Put new items
-    Item* item = item_factory::mk(Item_id::mi_go_gun);
-    inv.put_in_slot(Slot_id::wielded, item);
+TEST_FIXTURE(Basic_fixture, snd_range)
+{
+    //A corridor with a monster near the origin, one beyond hearing range, and one behind
+    //a wall - only the first should hear the sound
+    for (int x = 10; x <= 60; ++x)
+    {
+        map::put(new Floor(Pos(x, 10)));
+    }
 
-    //Wear asbestos suit to test properties from wearing items
-    item = item_factory::mk(Item_id::armor_asb_suit);
-    inv.put_in_slot(Slot_id::body, item);
-    item = item_factory::mk(Item_id::pistol_clip);
-    static_cast<Ammo_clip*>(item)->ammo_ = 1;
-    inv.put_in_backpack(item);
-    item = item_factory::mk(Item_id::pistol_clip);
-    static_cast<Ammo_clip*>(item)->ammo_ = 2;
-    inv.put_in_backpack(item);
-    item = item_factory::mk(Item_id::pistol_clip);
-    static_cast<Ammo_clip*>(item)->ammo_ = 3;
-    inv.put_in_backpack(item);
-    item = item_factory::mk(Item_id::pistol_clip);
-    static_cast<Ammo_clip*>(item)->ammo_ = 3;
-    inv.put_in_backpack(item);
-    item = item_factory::mk(Item_id::device_blaster);
-    static_cast<Strange_device*>(item)->condition_ = Condition::shoddy;
-    inv.put_in_backpack(item);
-    item = item_factory::mk(Item_id::electric_lantern);
-    Device_lantern* lantern         = static_cast<Device_lantern*>(item);
-    lantern->nr_turns_left_         = 789;
-    lantern->nr_flicker_turns_left_ = 456;
-    lantern->working_state_         = Lantern_working_state::flicker;
-    lantern->is_activated_          = true;
-    inv.put_in_backpack(item);
+    map::put(new Floor(Pos(20, 12)));
 
-    //Player
-    Actor_data_t& def = map::player->data();
-    def.name_a = def.name_the = "TEST PLAYER";
-    map::player->change_max_hp(5, Verbosity::silent);
+    map::player->pos = Pos(60, 10);
+    game_time::update_actor_pos(*map::player);
 
-    //map
-    map::dlvl = 7;
+    Mon* const mon_near     = static_cast<Mon*>(actor_factory::mk(Actor_id::rat, Pos(20, 10)));
+    Mon* const mon_far      = static_cast<Mon*>(actor_factory::mk(Actor_id::rat, Pos(40, 10)));
+    Mon* const mon_walled   = static_cast<Mon*>(actor_factory::mk(Actor_id::rat, Pos(20, 12)));
 
-    //Actor data
-    actor_data::data[int(Actor_id::END) - 1].nr_kills = 123;
+    const Pos origin(12, 10);
 
-    //Learned spells
-    player_spells_handling::learn_spell_if_not_known(Spell_id::bless);
-    player_spells_handling::learn_spell_if_not_known(Spell_id::aza_wrath);
+    Snd snd("", Sfx_id::END, Ignore_msg_if_origin_seen::yes, origin, nullptr,
+            Snd_vol::high, Alerts_mon::yes);
 
-    //Applied properties
-    Prop_handler& prop_hlr = map::player->prop_handler();
-    prop_hlr.try_add_prop(new Prop_rSleep(Prop_turns::specific, 3));
-    prop_hlr.try_add_prop(new Prop_diseased(Prop_turns::indefinite));
-    prop_hlr.try_add_prop(new Prop_blessed(Prop_turns::std));
+    snd_emit::emit_snd(snd);
 
-    //Check a a few of the props applied
-    Prop* prop = prop_hlr.prop(Prop_id::diseased);
-    CHECK(prop);
+    CHECK(mon_near->aware_counter_ > 0);
+    CHECK_EQUAL(0, mon_far->aware_counter_);
+    CHECK_EQUAL(0, mon_walled->aware_counter_);
 
-    prop = prop_hlr.prop(Prop_id::blessed);
-    CHECK(prop);
+    //Open the wall, the same origin is flooded again since the map has changed
+    map::put(new Floor(Pos(20, 11)));
 
-    //Check a prop that was NOT applied
-    prop = prop_hlr.prop(Prop_id::confused);
-    CHECK(!prop);
+    snd_emit::emit_snd(snd);
 
-    //map sequence
-    map_travel::map_list[5] = {Map_type::rats_in_the_walls, Is_main_dungeon::yes};
-    map_travel::map_list[7] = {Map_type::leng,              Is_main_dungeon::no};
+    CHECK(mon_walled->aware_counter_ > 0);
+    CHECK_EQUAL(0, mon_far->aware_counter_);
 
-    save_handling::save();
-    CHECK(save_handling::is_save_available());
+    actor_factory::delete_all_mon();
 }
 
-TEST_FIXTURE(Basic_fixture, loading_game)
+TEST_FIXTURE(Basic_fixture, actor_grid)
 {
-    CHECK(save_handling::is_save_available());
+    //The actor and mob grids must always give the same result as scanning all actors and mobs
+    map::dlvl = 3;
 
-    const int PLAYER_MAX_HP_BEFORE_LOAD = map::player->hp_max(true);
+    while (!map_gen::mk_std_lvl()) {}
 
-    save_handling::load();
+    actor_factory::delete_all_mon();
 
-    //Item data
-    CHECK_EQUAL(true,  item_data::data[int(Item_id::scroll_telep)].is_tried);
-    CHECK_EQUAL(false, item_data::data[int(Item_id::scroll_telep)].is_identified);
-    CHECK_EQUAL(true,  item_data::data[int(Item_id::scroll_opening)].is_identified);
-    CHECK_EQUAL(false, item_data::data[int(Item_id::scroll_opening)].is_tried);
-    CHECK_EQUAL(false, item_data::data[int(Item_id::scroll_det_mon)].is_tried);
-    CHECK_EQUAL(false, item_data::data[int(Item_id::scroll_det_mon)].is_identified);
+    bool blocked[MAP_W][MAP_H];
+    map_parse::run(cell_check::Blocks_move_cmn(true), blocked);
 
-    //Bonus
-    CHECK_EQUAL(int(Bg::rogue), int(player_bon::bg()));
-    CHECK(player_bon::traits[int(Trait::healer)]);
-    CHECK(!player_bon::traits[int(Trait::sharp_shooter)]);
+    std::vector<Pos> free_cells;
+    utils::mk_vector_from_bool_map(false, blocked, free_cells);
 
-    //Player inventory
-    Inventory& inv  = map::player->inv();
-    auto& genInv    = inv.backpack_;
+    std::random_shuffle(begin(free_cells), end(free_cells));
 
-    CHECK_EQUAL(6, int(genInv.size()));
-    CHECK_EQUAL(int(Item_id::mi_go_gun), int(inv.item_in_slot(Slot_id::wielded)->data().id));
-    CHECK_EQUAL(int(Item_id::armor_asb_suit), int(inv.item_in_slot(Slot_id::body)->data().id));
+    const size_t NR_MON = std::min(size_t(40), free_cells.size() / 2);
 
-    int nr_clip_with_1 = 0;
-    int nr_clip_with_2 = 0;
-    int nr_clip_with_3 = 0;
-    bool is_sentry_device_found     = false;
-    bool is_electric_lantern_found  = false;
+    for (size_t i = 0; i < NR_MON; ++i)
+    {
+        actor_factory::mk(Actor_id::rat, free_cells[i]);
+    }
 
-    for (Item* item : genInv)
+    int nr_diffs = 0;
+
+    for (int step = 0; step < 20; ++step)
     {
-        Item_id id = item->id();
+        //Move the living monsters to different cells (but possibly onto corpses)
+        std::random_shuffle(begin(free_cells), end(free_cells));
 
-        if (id == Item_id::pistol_clip)
+        size_t free_cell_idx = 0;
+
+        for (Actor* const actor : game_time::actors_)
         {
-            switch (static_cast<Ammo_clip*>(item)->ammo_)
-            {
-            case 1:
-                nr_clip_with_1++;
-                break;
+            if (actor->is_player() || actor->state() != Actor_state::alive) {continue;}
 
-            case 2:
-                nr_clip_with_2++;
-                break;
+            if (rnd::one_in(8))
+            {
+                actor->die(false, false, false);
+            }
+            else
+            {
+                Pos p = free_cells[free_cell_idx++];
 
-            case 3:
-                nr_clip_with_3++;
-                break;
+                if (p == map::player->pos) {p = free_cells[free_cell_idx++];}
 
-            default:
-                break;
+                actor->pos = p;
+                game_time::update_actor_pos(*actor);
             }
         }
-        else if (id == Item_id::device_blaster)
+
+        if (rnd::coin_toss())
         {
-            is_sentry_device_found = true;
-            CHECK_EQUAL(int(Condition::shoddy),
-                        int(static_cast<Strange_device*>(item)->condition_));
+            game_time::add_mob(new Smoke(free_cells[rnd::range(0, free_cells.size() - 1)], 5));
         }
-        else if (id == Item_id::electric_lantern)
+
+        if (!game_time::mobs_.empty() && rnd::one_in(3))
         {
-            is_electric_lantern_found = true;
-            Device_lantern* lantern = static_cast<Device_lantern*>(item);
-            CHECK_EQUAL(789, lantern->nr_turns_left_);
-            CHECK_EQUAL(456, lantern->nr_flicker_turns_left_);
-            CHECK_EQUAL(int(Lantern_working_state::flicker), int(lantern->working_state_));
-            CHECK(lantern->is_activated_);
+            game_time::erase_mob(game_time::mobs_.front(), true);
         }
-    }
-
-    CHECK_EQUAL(1, nr_clip_with_1);
-    CHECK_EQUAL(1, nr_clip_with_2);
-    CHECK_EQUAL(2, nr_clip_with_3);
-    CHECK(is_sentry_device_found);
-    CHECK(is_electric_lantern_found);
-
-    //Player
-    Actor_data_t& def = map::player->data();
-    def.name_a = def.name_the = "TEST PLAYER";
-    CHECK_EQUAL("TEST PLAYER", def.name_a);
-    CHECK_EQUAL("TEST PLAYER", def.name_the);
-    //Check max HP (affected by disease)
-    CHECK_EQUAL((PLAYER_MAX_HP_BEFORE_LOAD + 5) / 2, map::player->hp_max(true));
 
-    //map
-    CHECK_EQUAL(7, map::dlvl);
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                const Pos p(x, y);
+
+                const auto& actors_here = game_time::actors_at_pos(p);
+                const auto& mobs_here   = game_time::mobs_at_pos(p);
+
+                size_t  nr_actors_here  = 0;
+                size_t  nr_mobs_here    = 0;
+                Actor*  living_actor    = nullptr;
+
+                for (Actor* const actor : game_time::actors_)
+                {
+                    if (actor->pos != p) {continue;}
+
+                    ++nr_actors_here;
+
+                    if (std::find(begin(actors_here), end(actors_here), actor) == end(actors_here))
+                    {
+                        ++nr_diffs;
+                    }
+
+                    if (actor->state() == Actor_state::alive && !living_actor)
+                    {
+                        living_actor = actor;
+                    }
+                }
+
+                for (Mob* const mob : game_time::mobs_)
+                {
+                    if (mob->pos() == p) {++nr_mobs_here;}
+                }
+
+                if (
+                    nr_actors_here != actors_here.size()    ||
+                    nr_mobs_here != mobs_here.size()        ||
+                    utils::actor_at_pos(p) != living_actor)
+                {
+                    ++nr_diffs;
+                }
+            }
+        }
+    }
 
-    //Actor data
-    CHECK_EQUAL(123, actor_data::data[int(Actor_id::END) - 1].nr_kills);
+    CHECK_EQUAL(0, nr_diffs);
 
-    //Learned spells
-    CHECK(player_spells_handling::is_spell_learned(Spell_id::bless));
-    CHECK(player_spells_handling::is_spell_learned(Spell_id::aza_wrath));
-    CHECK_EQUAL(false, player_spells_handling::is_spell_learned(Spell_id::mayhem));
+    actor_factory::delete_all_mon();
+    game_time::erase_all_mobs();
 
-    //Properties
-    Prop_handler& prop_hlr = map::player->prop_handler();
-    Prop* prop = prop_hlr.prop(Prop_id::diseased);
-    CHECK(prop);
-    CHECK(prop_hlr.has_prop(Prop_id::diseased));
-    CHECK_EQUAL(-1, prop->nr_turns_left());
-    //Check currrent HP (affected by disease)
-    CHECK_EQUAL((map::player->data().hp + 5) / 2, map::player->hp());
+    CHECK(game_time::actors_at_pos(map::player->pos).size() == 1);
+}
 
-    prop = prop_hlr.prop(Prop_id::rSleep);
-    CHECK(prop);
-    CHECK(prop_hlr.has_prop(Prop_id::rSleep));
-    CHECK_EQUAL(3, prop->nr_turns_left());
+TEST_FIXTURE(Basic_fixture, active_rigids)
+{
+    //A burning rigid must get new turn calls until it has burned out, also when it's not
+    //registered by anything but the burning
+    const Pos p(30, 10);
 
-    prop = prop_hlr.prop(Prop_id::blessed);
-    CHECK(prop);
-    CHECK(prop_hlr.has_prop(Prop_id::blessed));
-    CHECK(prop->nr_turns_left() > 0);
+    map::put(new Floor(p));
 
-    //Properties from worn item
-    prop = prop_hlr.prop(Prop_id::rAcid);
-    CHECK(prop);
-    CHECK(prop->nr_turns_left() == -1);
-    prop = prop_hlr.prop(Prop_id::rFire);
-    CHECK(prop);
-    CHECK(prop->nr_turns_left() == -1);
+    Rigid* const rigid = map::cells[p.x][p.y].rigid;
 
-    //map sequence
-    auto mapData = map_travel::map_list[3];
-    CHECK(mapData.type              == Map_type::std);
-    CHECK(mapData.is_main_dungeon   == Is_main_dungeon::yes);
+    while (rigid->burn_state() != Burn_state::burning)
+    {
+        rigid->hit(Dmg_type::fire, Dmg_method::elemental);
+    }
 
-    mapData = map_travel::map_list[5];
-    CHECK(mapData.type              == Map_type::rats_in_the_walls);
-    CHECK(mapData.is_main_dungeon   == Is_main_dungeon::yes);
+    const int TURN_BEFORE = game_time::turn();
 
-    mapData = map_travel::map_list[7];
-    CHECK(mapData.type              == Map_type::leng);
-    CHECK(mapData.is_main_dungeon   == Is_main_dungeon::no);
+    while (game_time::turn() < TURN_BEFORE + 500 && rigid->burn_state() == Burn_state::burning)
+    {
+        game_time::tick();
+    }
 
-    //Game time
-    CHECK_EQUAL(0, game_time::turn());
+    CHECK(rigid->burn_state() == Burn_state::has_burned);
 }
 
-TEST_FIXTURE(Basic_fixture, flood_filling)
+TEST_FIXTURE(Basic_fixture, actor_speed_scheduling)
 {
-    bool b[MAP_W][MAP_H];
-    utils::reset_array(b, false);
-
-    for (int y = 0; y < MAP_H; ++y)
-    {
-        b[0][y] = b[MAP_W - 1][y] = false;
-    }
+    const Actor_id ids[] =
+    {
+        Actor_id::zombie,           //Normal
+        Actor_id::thing,            //Fast
+        Actor_id::giant_bat,        //Fastest
+        Actor_id::bloated_zombie    //Slow
+    };
 
-    for (int x = 0; x < MAP_W; ++x)
+    //Number of turns per 30 standard turns
+    const int TURNS_PER_30_STD[] = {30, 40, 50, 20};
+
+    std::vector<Actor*> mon_list;
+
+    for (size_t i = 0; i < 4; ++i)
     {
-        b[x][0] = b[x][MAP_H - 1] = false;
+        mon_list.push_back(actor_factory::mk(ids[i], Pos(10 + i, 10)));
     }
 
-    int flood[MAP_W][MAP_H];
-    flood_fill::run(Pos(20, 10), b, flood, 999, Pos(-1, -1), true);
+    game_time::reset_turn_type_and_actor_counters();
 
-    CHECK_EQUAL(0, flood[20][10]);
-    CHECK_EQUAL(1, flood[19][10]);
-    CHECK_EQUAL(1, flood[21][10]);
-    CHECK_EQUAL(1, flood[20][11]);
-    CHECK_EQUAL(1, flood[21][11]);
-    CHECK_EQUAL(4, flood[24][12]);
-    CHECK_EQUAL(4, flood[24][14]);
-    CHECK_EQUAL(5, flood[24][15]);
-    CHECK_EQUAL(0, flood[0][0]);
-    CHECK_EQUAL(0, flood[MAP_W - 1][MAP_H - 1]);
-}
+    const int NR_STD_TURNS  = 300;
+    const int TURN_BEFORE   = game_time::turn();
 
-TEST_FIXTURE(Basic_fixture, path_finding)
-{
-    std::vector<Pos> path;
-    bool b[MAP_W][MAP_H];
-    utils::reset_array(b, false);
+    int nr_turns[4]     = {0, 0, 0, 0};
+    int nr_player_turns = 0;
 
-    for (int y = 0; y < MAP_H; ++y)
+    while (game_time::turn() < TURN_BEFORE + NR_STD_TURNS)
     {
-        b[0][y] = b[MAP_W - 1][y] = false;
+        const Actor* const actor = game_time::cur_actor();
+
+        if (actor == map::player)
+        {
+            ++nr_player_turns;
+        }
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            if (actor == mon_list[i])
+            {
+                ++nr_turns[i];
+            }
+        }
+
+        game_time::tick();
     }
 
-    for (int x = 0; x < MAP_W; ++x)
+    CHECK(abs(nr_player_turns - NR_STD_TURNS) <= 2);
+
+    for (size_t i = 0; i < 4; ++i)
     {
-        b[x][0] = b[x][MAP_H - 1] = false;
+        const int EXPECTED = (TURNS_PER_30_STD[i] * NR_STD_TURNS) / 30;
+
+        CHECK(abs(nr_turns[i] - EXPECTED) <= 2);
     }
 
-    path_find::run(Pos(20, 10), Pos(25, 10), b, path);
+    //A hasted monster is rescheduled, and gets more turns
+    mon_list[0]->prop_handler().try_add_prop(new Prop_hasted(Prop_turns::indefinite));
 
-    CHECK(!path.empty());
-    CHECK(path.back() != Pos(20, 10));
-    CHECK_EQUAL(25, path.front().x);
-    CHECK_EQUAL(10, path.front().y);
-    CHECK_EQUAL(5, int(path.size()));
+    CHECK(mon_list[0]->speed() == Actor_speed::fast);
 
-    path_find::run(Pos(20, 10), Pos(5, 3), b, path);
+    const int TURN_BEFORE_HASTED = game_time::turn();
 
-    CHECK(!path.empty());
-    CHECK(path.back() != Pos(20, 10));
-    CHECK_EQUAL(5, path.front().x);
-    CHECK_EQUAL(3, path.front().y);
-    CHECK_EQUAL(15, int(path.size()));
+    int nr_hasted_turns = 0;
 
-    b[10][5] = true;
+    while (game_time::turn() < TURN_BEFORE_HASTED + 30)
+    {
+        if (game_time::cur_actor() == mon_list[0])
+        {
+            ++nr_hasted_turns;
+        }
 
-    path_find::run(Pos(7, 5), Pos(20, 5), b, path);
+        game_time::tick();
+    }
 
-    CHECK(!path.empty());
-    CHECK(path.back() != Pos(7, 5));
-    CHECK_EQUAL(20, path.front().x);
-    CHECK_EQUAL(5, path.front().y);
-    CHECK_EQUAL(13, int(path.size()));
-    CHECK(find(begin(path), end(path), Pos(10, 5)) == end(path));
+    CHECK(abs(nr_hasted_turns - 40) <= 2);
+}
 
-    b[19][4] = b[19][5] =  b[19][6] = true;
+TEST_FIXTURE(Basic_fixture, spawned_actors_are_scheduled)
+{
+    //Monsters spawned during the standard turns (due to time passed) must get turns
+    map::dlvl = 3;
 
-    path_find::run(Pos(7, 5), Pos(20, 5), b, path);
+    //An explored area far from the player, where monsters can spawn
+    for (int x = 30; x < 70; ++x)
+    {
+        for (int y = 2; y < MAP_H - 2; ++y)
+        {
+            map::put(new Floor(Pos(x, y)));
+            map::cells[x][y].is_explored = true;
+        }
+    }
 
-    CHECK(!path.empty());
-    CHECK(path.back() != Pos(7, 5));
-    CHECK_EQUAL(20, path.front().x);
-    CHECK_EQUAL(5, path.front().y);
-    CHECK_EQUAL(14, int(path.size()));
-    CHECK(find(begin(path), end(path), Pos(19, 4)) == end(path));
-    CHECK(find(begin(path), end(path), Pos(19, 5)) == end(path));
-    CHECK(find(begin(path), end(path), Pos(19, 6)) == end(path));
+    const int NR_STD_TURNS  = 130 * 4;
+    const int TURN_BEFORE   = game_time::turn();
 
-    path_find::run(Pos(40, 10), Pos(43, 15), b, path, false);
+    //The turn each actor was first seen, and if it has acted
+    std::vector<const Actor*>   actors;
+    std::vector<int>            turn_added;
+    std::vector<bool>           has_acted;
 
-    CHECK(!path.empty());
-    CHECK(path.back() != Pos(40, 10));
-    CHECK_EQUAL(43, path.front().x);
-    CHECK_EQUAL(15, path.front().y);
-    CHECK_EQUAL(8, int(path.size()));
+    while (game_time::turn() < TURN_BEFORE + NR_STD_TURNS)
+    {
+        for (const Actor* const actor : game_time::actors_)
+        {
+            if (std::find(begin(actors), end(actors), actor) == end(actors))
+            {
+                actors      .push_back(actor);
+                turn_added  .push_back(game_time::turn());
+                has_acted   .push_back(false);
+            }
+        }
 
-    b[41][10] = b[40][11]  = true;
+        const Actor* const cur_actor = game_time::cur_actor();
 
-    path_find::run(Pos(40, 10), Pos(43, 15), b, path, false);
+        const size_t IDX = std::find(begin(actors), end(actors), cur_actor) - begin(actors);
 
-    CHECK(!path.empty());
-    CHECK(path.back() != Pos(40, 10));
-    CHECK_EQUAL(43, path.front().x);
-    CHECK_EQUAL(15, path.front().y);
-    CHECK_EQUAL(10, int(path.size()));
-}
+        CHECK(IDX < actors.size());
 
-TEST_FIXTURE(Basic_fixture, map_parse_expand_one)
-{
-    bool in[MAP_W][MAP_H];
-    utils::reset_array(in, false);
+        if (IDX < actors.size())
+        {
+            has_acted[IDX] = true;
+        }
 
-    in[10][5] = true;
+        game_time::tick();
+    }
 
-    bool out[MAP_W][MAP_H];
-    map_parse::expand(in, out);
+    //Some monsters were spawned (the player is the first actor)
+    CHECK(actors.size() > 1);
 
-    CHECK(!out[8][5]);
-    CHECK(out[9][5]);
-    CHECK(out[10][5]);
-    CHECK(out[11][5]);
-    CHECK(!out[12][5]);
+    //All actors spawned some turns ago have acted
+    for (size_t i = 0; i < actors.size(); ++i)
+    {
+        if (turn_added[i] < game_time::turn() - 10)
+        {
+            CHECK(has_acted[i]);
+        }
+    }
+}
 
-    CHECK(!out[8][4]);
-    CHECK(out[9][4]);
-    CHECK(out[10][4]);
-    CHECK(out[11][4]);
-    CHECK(!out[12][4]);
+TEST_FIXTURE(Basic_fixture, std_turns_at_high_shock)
+{
+    //The player goes insane during the standard turns, which ends the turn of the current
+    //actor - there must be a current actor then, also with other actors present
+    map::dlvl = 3;
 
-    in[14][5] = true;
-    map_parse::expand(in, out);
+    for (int i = 0; i < 4; ++i)
+    {
+        actor_factory::mk(Actor_id::zombie, Pos(10 + i, 10));
+    }
 
-    CHECK(out[10][5]);
-    CHECK(out[11][5]);
-    CHECK(!out[12][5]);
-    CHECK(out[13][5]);
-    CHECK(out[14][5]);
+    game_time::reset_turn_type_and_actor_counters();
 
-    in[12][5] = true;
-    map_parse::expand(in, out);
-    CHECK(out[12][4]);
-    CHECK(out[12][5]);
-    CHECK(out[12][6]);
+    const int TURN_BEFORE = game_time::turn();
 
-    //Check that old values are cleared
-    utils::reset_array(in, false);
-    in[40][10] = true;
-    map_parse::expand(in, out);
-    CHECK(out[39][10]);
-    CHECK(out[40][10]);
-    CHECK(out[41][10]);
-    CHECK(!out[10][5]);
-    CHECK(!out[12][5]);
-    CHECK(!out[14][5]);
+    while (game_time::turn() < TURN_BEFORE + 40 && map::player->is_alive())
+    {
+        map::player->incr_shock(100, Shock_src::misc);
+
+        game_time::tick();
+    }
+
+    CHECK(map::player->ins() > 0);
 }
 
 TEST_FIXTURE(Basic_fixture, find_room_corr_entries)
@@ -1226,7 +2778,8 @@ TEST_FIXTURE(Basic_fixture, find_room_corr_entries)
     CHECK(!entry_map[25][7]);
 
     //Check that the room can share an antry point with a nearby room
-    roomRect = Rect(10, 5, 18, 10);
+    roomRect.p0.set(10, 5);
+    roomRect.p1.set(18, 10);
 
     Room* nearby_room = room_factory::mk(Room_type::plain, roomRect);
 
@@ -1431,6 +2984,244 @@ TEST_FIXTURE(Basic_fixture, map_parse_cells_within_dist_of_others)
     CHECK_EQUAL(false, out[25][10]);
 }
 
+//-----------------------------------------------------------------------------
+// Checks against the previous implementations (timings are in bench.cpp)
+//-----------------------------------------------------------------------------
+TEST_FIXTURE(Basic_fixture, line_calc_same_as_float_ref)
+{
+    //Compare against the floating point line algorithm, for lines from a few origins to all
+    //cells on the map, with the parameter combinations used by the game
+    const Pos origins[] = {Pos(1, 1), Pos(MAP_W_HALF, MAP_H_HALF), Pos(MAP_W - 2, 5)};
+
+    struct Line_params
+    {
+        bool    is_stopping_at_tgt;
+        int     travel_lmt;
+    };
+
+    const Line_params params[] = {{true, 9999}, {false, 9999}, {true, 3}, {false, 11}};
+
+    std::vector<Pos> line_ref;
+    std::vector<Pos> line;
+
+    int nr_diffs = 0;
+
+    //Run twice, the first run fills the line cache
+    for (int run = 0; run < 2; ++run)
+    {
+        for (const Pos& origin : origins)
+        {
+            for (const Line_params& p : params)
+            {
+                for (int x = 0; x < MAP_W; ++x)
+                {
+                    for (int y = 0; y < MAP_H; ++y)
+                    {
+                        const Pos tgt(x, y);
+
+                        prev_impl::calc_new_line_float(origin, tgt, p.is_stopping_at_tgt,
+                                                       p.travel_lmt, false, line_ref);
+
+                        line_calc::calc_new_line(origin, tgt, p.is_stopping_at_tgt, p.travel_lmt,
+                                                 false, line);
+
+                        if (line != line_ref) {++nr_diffs;}
+                    }
+                }
+            }
+        }
+    }
+
+    CHECK_EQUAL(0, nr_diffs);
+}
+
+TEST_FIXTURE(Basic_fixture, flood_fill_same_as_prev)
+{
+    //Compare against the previous flood fill on generated maps, with and without a target
+    //and travel limit
+    int flood_ref[MAP_W][MAP_H];
+    int flood[MAP_W][MAP_H];
+
+    int nr_diffs = 0;
+
+    for (int lvl = 0; lvl < 4; ++lvl)
+    {
+        map::dlvl = 1 + (lvl * 8);
+
+        while (!map_gen::mk_std_lvl()) {}
+
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+
+        std::vector<Pos> free_cells;
+        utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            const Pos p0 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            const Pos p1 = rnd::coin_toss() ?
+                           Pos(-1, -1) :
+                           free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            const int   TRAVEL_LMT      = rnd::one_in(3) ? rnd::range(0, 12) : INT_MAX;
+            const bool  ALLOW_DIAGONAL  = rnd::coin_toss();
+
+            prev_impl::flood_fill(p0, blocked, flood_ref, TRAVEL_LMT, p1, ALLOW_DIAGONAL);
+
+            flood_fill::run(p0, blocked, flood, TRAVEL_LMT, p1, ALLOW_DIAGONAL);
+
+            for (int x = 0; x < MAP_W; ++x)
+            {
+                for (int y = 0; y < MAP_H; ++y)
+                {
+                    if (flood[x][y] != flood_ref[x][y]) {++nr_diffs;}
+                }
+            }
+        }
+    }
+
+    CHECK_EQUAL(0, nr_diffs);
+}
+
+TEST_FIXTURE(Basic_fixture, path_find_algos_give_same_result)
+{
+    //Both path finding algorithms must give the same paths on generated maps, also when
+    //the step choices are randomized (with the same random seed)
+    const Path_algo algo_before = path_find::algo();
+
+    std::vector<Pos> path_flood;
+    std::vector<Pos> path_a_star;
+
+    int nr_diffs = 0;
+
+    for (int lvl = 0; lvl < 4; ++lvl)
+    {
+        map::dlvl = 1 + (lvl * 8);
+
+        while (!map_gen::mk_std_lvl()) {}
+
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+
+        std::vector<Pos> free_cells;
+        utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const Pos p0 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            //Mostly nearby targets (e.g. monsters chasing the player), sometimes anywhere
+            Pos p1 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            if (rnd::fraction(2, 3))
+            {
+                const Pos d(rnd::range(-FOV_STD_RADI_INT, FOV_STD_RADI_INT),
+                            rnd::range(-FOV_STD_RADI_INT, FOV_STD_RADI_INT));
+
+                p1 = Pos(utils::constr_in_range(1, p0.x + d.x, MAP_W - 2),
+                         utils::constr_in_range(1, p0.y + d.y, MAP_H - 2));
+            }
+
+            const bool          ALLOW_DIAGONAL  = rnd::fraction(3, 4);
+            const bool          RANDOMIZE       = rnd::coin_toss();
+            const unsigned long SEED            = rnd::range(1, 1000000);
+
+            rnd::seed(SEED);
+            path_find::set_algo(Path_algo::flood_fill);
+
+            path_find::run(p0, p1, blocked, path_flood, ALLOW_DIAGONAL, RANDOMIZE);
+
+            rnd::seed(SEED);
+            path_find::set_algo(Path_algo::a_star);
+
+            path_find::run(p0, p1, blocked, path_a_star, ALLOW_DIAGONAL, RANDOMIZE);
+
+            if (path_flood != path_a_star) {++nr_diffs;}
+        }
+    }
+
+    CHECK_EQUAL(0, nr_diffs);
+
+    path_find::set_algo(algo_before);
+}
+
+TEST_FIXTURE(Basic_fixture, room_graph_paths)
+{
+    //Long paths planned over the room graph must be valid, and as short as paths found over
+    //the whole map
+    std::vector<Pos> path_flat;
+    std::vector<Pos> path_graph;
+
+    int nr_diffs    = 0;
+    int nr_paths    = 0;
+
+    for (int lvl = 0; lvl < 4; ++lvl)
+    {
+        map::dlvl = 1 + (lvl * 8);
+
+        while (!map_gen::mk_std_lvl()) {}
+
+        //Like the bot travelling to the stairs - doors are allowed
+        bool blocked[MAP_W][MAP_H];
+        map_parse::run(cell_check::Blocks_move_cmn(false), blocked);
+
+        for (int x = 0; x < MAP_W; ++x)
+        {
+            for (int y = 0; y < MAP_H; ++y)
+            {
+                if (map::cells[x][y].rigid->id() == Feature_id::door)
+                {
+                    blocked[x][y] = false;
+                }
+            }
+        }
+
+        std::vector<Pos> free_cells;
+        utils::mk_vector_from_bool_map(false, blocked, free_cells);
+
+        for (int i = 0; i < 200; ++i)
+        {
+            const Pos p0 = free_cells[rnd::range(0, free_cells.size() - 1)];
+            const Pos p1 = free_cells[rnd::range(0, free_cells.size() - 1)];
+
+            if (p0 == p1) {continue;}
+
+            path_find::run(p0, p1, blocked, path_flat);
+
+            room_graph::find_path(p0, p1, blocked, path_graph);
+
+            if (path_flat.size() != path_graph.size())
+            {
+                ++nr_diffs;
+                continue;
+            }
+
+            if (path_graph.empty()) {continue;}
+
+            Pos prev_pos = p0;
+
+            for (auto it = path_graph.rbegin(); it != path_graph.rend(); ++it)
+            {
+                if (!utils::is_pos_adj(prev_pos, *it, false) || blocked[it->x][it->y])
+                {
+                    ++nr_diffs;
+                    break;
+                }
+
+                prev_pos = *it;
+            }
+
+            if (path_graph.front() != p1) {++nr_diffs;}
+
+            ++nr_paths;
+        }
+    }
+
+    CHECK_EQUAL(0, nr_diffs);
+    CHECK(nr_paths > 0);
+}
+
 //-----------------------------------------------------------------------------
 // Some code exercise - Ichi! Ni! San!
 //-----------------------------------------------------------------------------
@@ -0,0 +1,168 @@
+#ifndef PREV_IMPL_H
+#define PREV_IMPL_H
+
+#include <vector>
+#include <cmath>
+
+#include "cmn_types.hpp"
+#include "utils.hpp"
+
+//Previous implementations of optimized algorithms. The unit tests check that the current
+//implementations give the same results, and the benchmarks compare their timings.
+namespace prev_impl
+{
+
+//Line calculation stepping along the line in floating point
+inline void calc_new_line_float(const Pos& origin, const Pos& tgt,
+                                const bool SHOULD_STOP_AT_TARGET, const int CHEB_TRAVEL_LIMIT,
+                                const bool ALLOW_OUTSIDE_MAP, std::vector<Pos>& line_ref)
+{
+    line_ref.clear();
+
+    if (tgt == origin)
+    {
+        line_ref.push_back(origin);
+        return;
+    }
+
+    const double DELTA_X_DB = double(tgt.x - origin.x);
+    const double DELTA_Y_DB = double(tgt.y - origin.y);
+    const double HYPOT_DB   = sqrt((DELTA_X_DB * DELTA_X_DB) + (DELTA_Y_DB * DELTA_Y_DB));
+    const double X_INCR_DB  = (DELTA_X_DB / HYPOT_DB);
+    const double Y_INCR_DB  = (DELTA_Y_DB / HYPOT_DB);
+
+    double cur_x_db = double(origin.x) + 0.5;
+    double cur_y_db = double(origin.y) + 0.5;
+
+    Pos cur_pos;
+
+    const double STEP_SIZE_DB = 0.04;
+
+    for (double i = 0.0; i <= 9999.0; i += STEP_SIZE_DB)
+    {
+        cur_x_db += X_INCR_DB * STEP_SIZE_DB;
+        cur_y_db += Y_INCR_DB * STEP_SIZE_DB;
+
+        cur_pos.set(floor(cur_x_db), floor(cur_y_db));
+
+        if (!ALLOW_OUTSIDE_MAP && !utils::is_pos_inside_map(cur_pos)) {return;}
+
+        if (line_ref.empty() || line_ref.back() != cur_pos)
+        {
+            line_ref.push_back(cur_pos);
+        }
+
+        if (SHOULD_STOP_AT_TARGET && (cur_pos == tgt)) {return;}
+
+        if (utils::king_dist(origin, cur_pos) >= CHEB_TRAVEL_LIMIT) {return;}
+    }
+}
+
+//Flood fill with a growing queue, and a direction list built per call
+inline void flood_fill(const Pos& p0,
+                       const bool blocked[MAP_W][MAP_H],
+                       int out[MAP_W][MAP_H],
+                       int travel_lmt,
+                       const Pos& p1,
+                       const bool ALLOW_DIAGONAL)
+{
+    utils::reset_array(out);
+
+    std::vector<Pos> positions;
+    positions.clear();
+
+    unsigned int    nr_elements_to_skip = 0;
+    int             cur_val             = 0;
+    bool            path_exists         = true;
+    bool            is_at_tgt           = false;
+    bool            is_stopping_at_p1   = p1.x != -1;
+
+    const Rect      bounds(Pos(1, 1), Pos(MAP_W - 2, MAP_H - 2));
+
+    Pos             cur_pos(p0);
+
+    std::vector<Pos> dirs {Pos(0, -1), Pos(-1, 0), Pos(0, 1), Pos(1, 0)};
+
+    if (ALLOW_DIAGONAL)
+    {
+        dirs.push_back(Pos(-1, -1));
+        dirs.push_back(Pos(-1, 1));
+        dirs.push_back(Pos(1, -1));
+        dirs.push_back(Pos(1, 1));
+    }
+
+    bool done = false;
+
+    while (!done)
+    {
+
+        for (const Pos& d : dirs)
+        {
+            if ((d != 0))
+            {
+                const Pos new_pos(cur_pos + d);
+
+                if (
+                    !blocked[new_pos.x][new_pos.y]          &&
+                    utils::is_pos_inside(new_pos, bounds)   &&
+                    out[new_pos.x][new_pos.y] == 0          &&
+                    new_pos != p0)
+                {
+                    cur_val = out[cur_pos.x][cur_pos.y];
+
+                    if (cur_val < travel_lmt) {out[new_pos.x][new_pos.y] = cur_val + 1;}
+
+                    if (is_stopping_at_p1 && cur_pos == p1 - d)
+                    {
+                        is_at_tgt = true;
+                        break;
+                    }
+
+                    if (!is_stopping_at_p1 || !is_at_tgt)
+                    {
+                        positions.push_back(new_pos);
+                    }
+                }
+            }
+        }
+
+        if (is_stopping_at_p1)
+        {
+            if (positions.size() == nr_elements_to_skip)
+            {
+                path_exists = false;
+            }
+
+            if (is_at_tgt || !path_exists)
+            {
+                done = true;
+            }
+        }
+        else if (positions.size() == nr_elements_to_skip)
+        {
+            done = true;
+        }
+
+        if (cur_val == travel_lmt)
+        {
+            done = true;
+        }
+
+        if (!is_stopping_at_p1 || !is_at_tgt)
+        {
+            if (positions.size() == nr_elements_to_skip)
+            {
+                path_exists = false;
+            }
+            else
+            {
+                cur_pos = positions[nr_elements_to_skip];
+                nr_elements_to_skip++;
+            }
+        }
+    }
+}
+
+} //prev_impl
+
+#endif